@@ -10,6 +10,8 @@ int main() {
     eogllEnableDepth();
 
     EogllShaderProgram* shaderProgram = eogllLinkProgramFromFile("resources/shaders/dragon_vertex.glsl", "resources/shaders/dragon_fragment.glsl");
+    // most uniforms are the same every frame, so writing them again is skipped
+    eogllSetUniformShadowing(shaderProgram, true);
 
     EogllModel model = eogllCreateModel(); // matrix
     eogllRotateModel(&model, 45.0f,  (vec3) {0.0f, 1.0f, 0.0f}); // rotate 45 degrees on y axis
@@ -0,0 +1,83 @@
+#include <hogll.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+// Counts the heap allocations RenderModel::draw makes once the model has been drawn with the shader.
+// Usage: eogll_bench_draw [model file] [texture directory, relative to the model]
+// Run from the repository root so resources can be found. Needs an OpenGL context (the window is hidden).
+// Exits with 1 if draw allocated, so it can be used as a check.
+
+static std::atomic<size_t> allocations(0);
+
+void* operator new(size_t size) {
+    allocations++;
+    void* p = malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+int main(int argc, char** argv) {
+    const char* path = argc > 1 ? argv[1] : "resources/models/Main_Char_2_Anim.fbx";
+    const char* textures = argc > 2 ? argv[2] : "../textures/";
+
+    ogl::Window window(800, 600, "EOGLL: Draw Benchmark", ogl::WindowHints(false, true, false, false, false, false, false));
+
+    ogl::ModelAttrs attrs = ogl::ModelAttrs {
+        {GL_FLOAT, 3, ogl::POSITION},
+        {GL_FLOAT, 3, ogl::NORMAL},
+        {GL_FLOAT, 2, ogl::TEXTURE},
+        {GL_INT, 4, ogl::BONE_IDS},
+        {GL_FLOAT, 4, ogl::BONE_WEIGHTS}
+    };
+    ogl::RenderModel model(path, attrs, textures);
+    EogllShaderProgram* shader = eogllLinkProgramFromFile("resources/shaders/model.vert", "resources/shaders/model.frag");
+
+    ogl::Model transform;
+    ogl::Camera camera;
+    ogl::Projection projection(45.0f, 0.1f, 100.0f);
+    auto preDraw = [&](EogllShaderProgram* s) {
+        transform.update(s);
+        camera.update(s);
+        projection.update(s, window);
+    };
+    // built once, so only draw itself is counted (a lambda passed straight to draw is wrapped in a new std::function every call)
+    std::function<void(EogllShaderProgram*)> preDrawFunc = preDraw;
+
+    // the first draw with a shader looks up its samplers
+    size_t before = allocations;
+    model.draw(shader, preDrawFunc);
+    size_t firstDraw = allocations - before;
+
+    const int frames = 1000;
+    before = allocations;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i++) {
+        model.draw(shader, preDrawFunc);
+    }
+    glFinish();
+    double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    size_t perFrame = allocations - before;
+
+    printf("%s: %zu meshes\n", path, model.meshes.size());
+    printf("  first draw   %zu allocations\n", firstDraw);
+    printf("  %d draws   %zu allocations, %.3f ms per draw\n", frames, perFrame, time / frames);
+
+    eogllDeleteProgram(shader);
+    if (perFrame != 0) {
+        printf("  draw allocated after the first frame\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,49 @@
+#include <hogll.hpp>
+
+// Prints where the time loading a RenderModel goes, with the import flags derived from the attributes and with Assimp's max quality preset.
+// Usage: eogll_bench_load [model file] [texture directory, relative to the model]
+// Run from the repository root so resources can be found. Needs an OpenGL context (the window is hidden).
+
+static void printProfile(const char* name, const ogl::RenderModel& model) {
+    const ogl::ModelLoadProfile& p = model.profile;
+    printf("  %-12s flags 0x%08x  total %8.3f ms\n", name, p.importFlags, p.total * 1000.0);
+    printf("    import %8.3f  scene %8.3f  parallel %8.3f  upload %8.3f ms\n", p.import * 1000.0, p.scene * 1000.0, p.parallel * 1000.0, p.upload * 1000.0);
+    printf("    (summed over threads) process %8.3f  pack %8.3f  optimize %8.3f  decode %8.3f ms\n", p.process * 1000.0, p.pack * 1000.0, p.optimize * 1000.0, p.decode * 1000.0);
+}
+
+int main(int argc, char** argv) {
+    const char* path = argc > 1 ? argv[1] : "resources/models/Main_Char_2_Anim.fbx";
+    const char* textures = argc > 2 ? argv[2] : "../textures/";
+
+    ogl::Window window(800, 600, "EOGLL: Load Benchmark", ogl::WindowHints(false, true, false, false, false, false, false));
+
+    ogl::ModelAttrs attrs = ogl::ModelAttrs {
+        {GL_FLOAT, 3, ogl::POSITION},
+        {GL_FLOAT, 3, ogl::NORMAL},
+        {GL_FLOAT, 2, ogl::TEXTURE},
+        {GL_INT, 4, ogl::BONE_IDS},
+        {GL_FLOAT, 4, ogl::BONE_WEIGHTS}
+    };
+    ogl::ModelAttrs positions = ogl::ModelAttrs {
+        {GL_FLOAT, 3, ogl::POSITION}
+    };
+
+    printf("%s\n", path);
+    {
+        ogl::RenderModel model(path, attrs, textures);
+        printf("  %zu meshes, %zu textures\n", model.meshes.size(), model.textures_loaded.size());
+        printProfile("derived", model);
+    }
+    // every load decodes its textures again
+    ogl::TextureCache::global().trim(0);
+    {
+        ogl::RenderModel model(path, attrs, textures, true, false, aiProcessPreset_TargetRealtime_MaxQuality);
+        printProfile("max quality", model);
+    }
+    ogl::TextureCache::global().trim(0);
+    {
+        ogl::RenderModel model(path, positions, textures);
+        printProfile("positions", model);
+    }
+    return 0;
+}
@@ -0,0 +1,135 @@
+#include "eogll.h"
+
+#include <math.h>
+
+// Checks the generated normals of a UV sphere against the exact ones and times both modes.
+// Smooth normals are compared to the direction of the position from the center, flat normals to the face normals computed in double precision.
+// Exits with 1 if the largest angle between a generated normal and its reference is over the tolerance.
+// Smooth normals of a tessellated sphere lean a little toward the larger faces around them, so their tolerance also allows
+// an error that shrinks with the square of the angle between rings (about 0.005 degrees at the default 256 rings).
+// Usage: eogll_bench_normals [rings] [tolerance in degrees]
+// Doesn't need an OpenGL context.
+
+// the sphere as object file text, with the poles shared by their triangles and no seam, so every position has a full fan of triangles
+static char* writeSphere(unsigned int rings, unsigned int segments, size_t* size) {
+    size_t capacity = ((size_t)rings * segments + 2) * 48 + (size_t)rings * segments * 2 * 40 + 64;
+    char* text = (char*)malloc(capacity);
+    if (!text) {
+        return NULL;
+    }
+    size_t length = 0;
+    length += (size_t)snprintf(text + length, capacity - length, "v 0 1 0\n");
+    for (unsigned int r = 1; r < rings; r++) {
+        double theta = M_PI * r / rings;
+        for (unsigned int s = 0; s < segments; s++) {
+            double phi = 2.0 * M_PI * s / segments;
+            length += (size_t)snprintf(text + length, capacity - length, "v %.9f %.9f %.9f\n", sin(theta) * cos(phi), cos(theta), -sin(theta) * sin(phi));
+        }
+    }
+    length += (size_t)snprintf(text + length, capacity - length, "v 0 -1 0\n");
+
+    // object file indices start at 1, the north pole is 1 and ring r (from 1) starts at 2 + (r - 1) * segments
+    unsigned int south = 2 + (rings - 1) * segments;
+    for (unsigned int s = 0; s < segments; s++) {
+        unsigned int next = (s + 1) % segments;
+        length += (size_t)snprintf(text + length, capacity - length, "f 1 %u %u\n", 2 + s, 2 + next);
+        for (unsigned int r = 1; r + 1 < rings; r++) {
+            unsigned int a = 2 + (r - 1) * segments + s;
+            unsigned int b = 2 + (r - 1) * segments + next;
+            unsigned int c = a + segments;
+            unsigned int d = b + segments;
+            length += (size_t)snprintf(text + length, capacity - length, "f %u %u %u\nf %u %u %u\n", a, c, d, a, d, b);
+        }
+        length += (size_t)snprintf(text + length, capacity - length, "f %u %u %u\n", 2 + (rings - 2) * segments + s, south, 2 + (rings - 2) * segments + next);
+    }
+    *size = length;
+    return text;
+}
+
+static double angleBetween(double ax, double ay, double az, double bx, double by, double bz) {
+    double lengths = sqrt((ax * ax + ay * ay + az * az) * (bx * bx + by * by + bz * bz));
+    if (lengths <= 0.0) {
+        return M_PI;
+    }
+    double cosine = (ax * bx + ay * by + az * bz) / lengths;
+    cosine = cosine > 1.0 ? 1.0 : (cosine < -1.0 ? -1.0 : cosine);
+    return acos(cosine) * 180.0 / M_PI;
+}
+
+// the largest angle in degrees between a corner's normal and its reference
+static double measure(const EogllObjectFileData* data, EogllObjectNormalMode mode) {
+    double worst = 0.0;
+    for (unsigned int i = 0; i < data->numFaces; i++) {
+        const EogllObjectIndex* corners = &data->indices[data->faces[i].firstIndex];
+        const EogllObjectPosition* p[3];
+        for (int j = 0; j < 3; j++) {
+            p[j] = &data->positions[corners[j].geomIndex - 1];
+        }
+        double fx = 0.0, fy = 0.0, fz = 0.0;
+        if (mode == EOGLL_OBJ_NORMALS_FLAT) {
+            double e1x = (double)p[1]->x - p[0]->x, e1y = (double)p[1]->y - p[0]->y, e1z = (double)p[1]->z - p[0]->z;
+            double e2x = (double)p[2]->x - p[0]->x, e2y = (double)p[2]->y - p[0]->y, e2z = (double)p[2]->z - p[0]->z;
+            fx = e1y * e2z - e1z * e2y;
+            fy = e1z * e2x - e1x * e2z;
+            fz = e1x * e2y - e1y * e2x;
+        }
+        for (int j = 0; j < 3; j++) {
+            if (!corners[j].hasNormal || corners[j].normalIndex == 0 || corners[j].normalIndex > data->numNormals) {
+                return 180.0;
+            }
+            const EogllObjectNormal* n = &data->normals[corners[j].normalIndex - 1];
+            double angle = mode == EOGLL_OBJ_NORMALS_FLAT
+                ? angleBetween(n->x, n->y, n->z, fx, fy, fz)
+                : angleBetween(n->x, n->y, n->z, p[j]->x, p[j]->y, p[j]->z);
+            if (angle > worst) {
+                worst = angle;
+            }
+        }
+    }
+    return worst;
+}
+
+static bool check(const char* text, size_t size, EogllObjectNormalMode mode, double tolerance) {
+    const char* name = mode == EOGLL_OBJ_NORMALS_FLAT ? "flat" : "smooth";
+    EogllObjectFileData data;
+    if (eogllParseObjectBuffer(text, size, &data) != EOGLL_SUCCESS) {
+        printf("  %-6s failed to parse the sphere\n", name);
+        return false;
+    }
+    double start = eogllGetTime();
+    EogllResult result = eogllGenerateNormalsEx(&data, mode);
+    double time = eogllGetTime() - start;
+    if (result != EOGLL_SUCCESS) {
+        printf("  %-6s failed to generate normals\n", name);
+        eogllDeleteObjectFileData(&data);
+        return false;
+    }
+    double worst = measure(&data, mode);
+    bool ok = worst <= tolerance;
+    printf("  %-6s %8.3f ms  %u normals  worst error %.6f degrees  %s\n", name, time * 1000.0, data.numNormals, worst, ok ? "ok" : "FAILED");
+    eogllDeleteObjectFileData(&data);
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    unsigned int rings = argc > 1 ? (unsigned int)atoi(argv[1]) : 256;
+    double tolerance = argc > 2 ? atof(argv[2]) : 0.01;
+    if (rings < 3) {
+        rings = 3;
+    }
+    unsigned int segments = rings * 2;
+
+    size_t size;
+    char* text = writeSphere(rings, segments, &size);
+    if (!text) {
+        printf("Failed to allocate memory for the sphere\n");
+        return 1;
+    }
+    double step = 180.0 / rings;
+    double smoothTolerance = tolerance + 0.01 * step * step;
+    printf("UV sphere with %u rings and %u segments (%u triangles), tolerance %g degrees (%g smooth)\n", rings, segments, 2 * segments * (rings - 1), tolerance, smoothTolerance);
+    bool ok = check(text, size, EOGLL_OBJ_NORMALS_FLAT, tolerance);
+    ok = check(text, size, EOGLL_OBJ_NORMALS_SMOOTH, smoothTolerance) && ok;
+    free(text);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,103 @@
+#include "eogll.h"
+
+// Benchmarks the object file parsers with 1 to N threads.
+// Usage: eogll_bench_obj [max threads] [synthetic grid size]
+// Run from the repository root so resources/models can be found.
+
+static const char* writeSyntheticObject(unsigned int grid) {
+    // a grid of quads split into triangles, with texture coordinates and normals, around 14 MB per million vertices
+    const char* path = "eogll_bench_synthetic.obj";
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        return NULL;
+    }
+    for (unsigned int i = 0; i < grid; i++) {
+        for (unsigned int j = 0; j < grid; j++) {
+            fprintf(file, "v %f %f %f\n", (float)i / grid, (float)rand() / RAND_MAX * 0.01f, (float)j / grid);
+            fprintf(file, "vt %f %f\n", (float)i / grid, (float)j / grid);
+            fprintf(file, "vn 0 1 0\n");
+        }
+    }
+    for (unsigned int i = 0; i + 1 < grid; i++) {
+        for (unsigned int j = 0; j + 1 < grid; j++) {
+            unsigned int a = i * grid + j + 1;
+            unsigned int b = a + 1;
+            unsigned int c = a + grid;
+            unsigned int d = c + 1;
+            fprintf(file, "f %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, c, c, c, b, b, b);
+            fprintf(file, "f %u/%u/%u %u/%u/%u %u/%u/%u\n", b, b, b, c, c, c, d, d, d);
+        }
+    }
+    fclose(file);
+    return path;
+}
+
+static double bestOf(const char* path, unsigned int threads, int legacy) {
+    double best = 1e30;
+    for (int run = 0; run < 3; run++) {
+        EogllObjectFileData data;
+        double start = eogllGetTime();
+        EogllResult result;
+        if (legacy) {
+            FILE* file = fopen(path, "r");
+            if (!file) {
+                return -1.0;
+            }
+            result = eogllParseObjectFile(file, &data);
+            fclose(file);
+        } else {
+            result = eogllParseObjectFileParallel(path, &data, threads);
+        }
+        double time = eogllGetTime() - start;
+        if (result != EOGLL_SUCCESS) {
+            return -1.0;
+        }
+        eogllDeleteObjectFileData(&data);
+        if (time < best) {
+            best = time;
+        }
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    if (eogllInit() != EOGLL_SUCCESS) {
+        return 1;
+    }
+    unsigned int maxThreads = argc > 1 ? (unsigned int)atoi(argv[1]) : eogllGetProcessorCount();
+    unsigned int grid = argc > 2 ? (unsigned int)atoi(argv[2]) : 1500;
+
+    const char* synthetic = writeSyntheticObject(grid);
+    if (!synthetic) {
+        EOGLL_LOG_ERROR(stderr, "Failed to write synthetic object file\n");
+        return 1;
+    }
+    const char* paths[] = {
+            "resources/models/cube.obj",
+            "resources/models/newcube.obj",
+            "resources/models/teapot.obj",
+            synthetic
+    };
+
+    for (int i = 0; i < sizeof(paths) / sizeof(paths[0]); i++) {
+        double legacy = bestOf(paths[i], 1, 1);
+        if (legacy < 0.0) {
+            EOGLL_LOG_ERROR(stderr, "Failed to parse %s\n", paths[i]);
+            continue;
+        }
+        printf("%s\n", paths[i]);
+        printf("  legacy      %10.4f ms\n", legacy * 1000.0);
+        double single = 0.0;
+        for (unsigned int threads = 1; threads <= maxThreads; threads++) {
+            double time = bestOf(paths[i], threads, 0);
+            if (threads == 1) {
+                single = time;
+            }
+            printf("  %2u threads  %10.4f ms  (%.2fx vs 1 thread, %.2fx vs legacy)\n", threads, time * 1000.0, single / time, legacy / time);
+        }
+    }
+
+    remove(synthetic);
+    eogllTerminate();
+    return 0;
+}
@@ -0,0 +1,138 @@
+#include <hogll.hpp>
+
+#include <chrono>
+
+// Compares ogl::internal::packMesh with the per-vertex switch packer it replaced.
+// Usage: eogll_bench_pack [model files...]
+// Run from the repository root so resources/models can be found. Doesn't need a GPU.
+
+// the packer before the attribute layout was compiled, kept here as the baseline
+static std::vector<float> legacyPack(const ogl::internal::Mesh& mesh, ogl::ModelAttrs attrs) {
+    std::vector<float> vert;
+    vert.reserve(attrs.num());
+    for (const ogl::internal::Vertex& v : mesh.vert) {
+        for (int i = 0; i < attrs.size(); i++) {
+            ogl::ModelAttr a = attrs[i];
+            switch (a.attr) {
+                case ogl::POSITION:
+                    if (a.num() >= 1) vert.push_back(v.pos.x);
+                    if (a.num() >= 2) vert.push_back(v.pos.y);
+                    if (a.num() >= 3) vert.push_back(v.pos.z);
+                    break;
+                case ogl::NORMAL:
+                    if (a.num() >= 1) vert.push_back(v.norm.x);
+                    if (a.num() >= 2) vert.push_back(v.norm.y);
+                    if (a.num() >= 3) vert.push_back(v.norm.z);
+                    break;
+                case ogl::TEXTURE:
+                    if (a.num() >= 1) vert.push_back(v.tex.x);
+                    if (a.num() >= 2) vert.push_back(v.tex.y);
+                    break;
+                case ogl::BONE_IDS:
+                    for (int j = 0; j < a.num() && j < 4; j++) vert.push_back(reinterpret_cast<const float*>(&v.bone_ids)[j]);
+                    break;
+                case ogl::BONE_WEIGHTS:
+                    for (int j = 0; j < a.num() && j < 4; j++) vert.push_back(v.bone_weights[j]);
+                    break;
+            }
+        }
+    }
+    return vert;
+}
+
+// the vertices of every mesh in the file, repeated so there is enough work to time
+static ogl::internal::Mesh loadVertices(const char* path, int repeat) {
+    ogl::internal::Mesh mesh;
+    Assimp::Importer importer;
+    const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_JoinIdenticalVertices);
+    if (!scene || !scene->mRootNode) {
+        EOGLL_LOG_ERROR(stderr, "Failed to load %s: %s\n", path, importer.GetErrorString());
+        return mesh;
+    }
+    for (int r = 0; r < repeat; r++) {
+        for (unsigned int m = 0; m < scene->mNumMeshes; m++) {
+            const aiMesh* aim = scene->mMeshes[m];
+            for (unsigned int i = 0; i < aim->mNumVertices; i++) {
+                ogl::internal::Vertex v;
+                v.pos = glm::vec3(aim->mVertices[i].x, aim->mVertices[i].y, aim->mVertices[i].z);
+                v.norm = aim->mNormals ? glm::vec3(aim->mNormals[i].x, aim->mNormals[i].y, aim->mNormals[i].z) : glm::vec3(0.0f);
+                v.tex = aim->mTextureCoords[0] ? glm::vec2(aim->mTextureCoords[0][i].x, aim->mTextureCoords[0][i].y) : glm::vec2(0.0f);
+                v.bone_ids = glm::ivec4((int)i & 63, -1, -1, -1);
+                v.bone_weights = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+                mesh.vert.push_back(v);
+            }
+        }
+    }
+    return mesh;
+}
+
+template <typename F>
+static double bestOf(int runs, F f) {
+    double best = 1e30;
+    for (int i = 0; i < runs; i++) {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        best = time < best ? time : best;
+    }
+    return best;
+}
+
+static void report(const char* name, ogl::internal::Mesh& mesh, const ogl::ModelAttrs& attrs) {
+    std::vector<float> legacy;
+    double legacyTime = bestOf(5, [&]() { legacy = legacyPack(mesh, attrs); });
+
+    // packMesh moves the indices out of the mesh, there are none here so the mesh can be packed again
+    ogl::internal::GlMesh packed;
+    ogl::internal::PackLayout layout = ogl::internal::compilePackLayout(attrs);
+    double packTime = bestOf(5, [&]() { packed = ogl::internal::packMesh(mesh, layout); });
+
+    bool same = legacy.size() == packed.vert.size() && memcmp(legacy.data(), packed.vert.data(), legacy.size() * sizeof(float)) == 0;
+    printf("  %-20s %8zu vertices  legacy %8.3f ms  compiled %8.3f ms (%zu copies)  %5.2fx  %s\n", name, mesh.vert.size(),
+           legacyTime, packTime, layout.ops.size(), legacyTime / packTime, same ? "same output" : "OUTPUT DIFFERS");
+}
+
+static void benchmark(const char* path) {
+    ogl::ModelAttrs basic = {
+        {GL_FLOAT, 3, ogl::POSITION},
+        {GL_FLOAT, 3, ogl::NORMAL},
+        {GL_FLOAT, 2, ogl::TEXTURE}
+    };
+    ogl::ModelAttrs skinned = {
+        {GL_FLOAT, 3, ogl::POSITION},
+        {GL_FLOAT, 3, ogl::NORMAL},
+        {GL_FLOAT, 2, ogl::TEXTURE},
+        {GL_INT, 4, ogl::BONE_IDS},
+        {GL_FLOAT, 4, ogl::BONE_WEIGHTS}
+    };
+    ogl::ModelAttrs reordered = {
+        {GL_FLOAT, 2, ogl::TEXTURE},
+        {GL_FLOAT, 3, ogl::POSITION},
+        {GL_FLOAT, 4, ogl::BONE_WEIGHTS}
+    };
+
+    ogl::internal::Mesh mesh = loadVertices(path, 1);
+    if (mesh.vert.empty()) {
+        return;
+    }
+    printf("%s\n", path);
+    report("pos/norm/tex", mesh, basic);
+    report("skinned", mesh, skinned);
+    report("tex/pos/weights", mesh, reordered);
+
+    // enough vertices for packMesh to use every core
+    ogl::internal::Mesh large = loadVertices(path, (int)(ogl::internal::PARALLEL_PACK_VERTICES * 16 / mesh.vert.size()) + 1);
+    report("skinned (repeated)", large, skinned);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            benchmark(argv[i]);
+        }
+    } else {
+        benchmark("resources/models/Soldier_Rig.fbx");
+        benchmark("resources/models/Main_Char_2_Anim.fbx");
+    }
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include <hogll.hpp>
+
+#include <chrono>
+
+// Times Pose::evaluate for many instances of an animated model, with and without the cached key indices.
+// Usage: eogll_bench_pose [model files...]
+// Run from the repository root so resources/models can be found. Doesn't need a GPU.
+
+// the skeleton RenderModel would build for the model (in the order the meshes are stored, which is fine for timing)
+static void collectBones(const aiScene* scene, ogl::Skeleton& skeleton) {
+    for (unsigned int m = 0; m < scene->mNumMeshes; m++) {
+        const aiMesh* mesh = scene->mMeshes[m];
+        for (unsigned int b = 0; b < mesh->mNumBones; b++) {
+            skeleton.add(mesh->mBones[b]->mName.C_Str(), ogl::convertToGLM(mesh->mBones[b]->mOffsetMatrix));
+        }
+    }
+}
+
+// evaluates every instance for a number of 60 fps frames, returns the best time of a frame in ms
+static double run(const ogl::NodeHierarchy& hierarchy, const ogl::Skeleton& skeleton, std::vector<ogl::AnimationState>& states, std::vector<ogl::Pose>& poses, int frames, bool cacheKeys) {
+    double best = 1e30;
+    for (int frame = 0; frame < frames; frame++) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < states.size(); i++) {
+            states[i].update(1.0f / 60.0f);
+            if (!cacheKeys) {
+                // every key is searched for from the start
+                std::fill(states[i].keys.begin(), states[i].keys.end(), 0);
+            }
+            poses[i].evaluate(hierarchy, skeleton, states[i]);
+        }
+        double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        best = time < best ? time : best;
+    }
+    return best;
+}
+
+static void benchmark(const char* path) {
+    Assimp::Importer importer;
+    const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_LimitBoneWeights);
+    if (!scene || !scene->mRootNode) {
+        EOGLL_LOG_ERROR(stderr, "Failed to load %s: %s\n", path, importer.GetErrorString());
+        return;
+    }
+    if (scene->mNumAnimations == 0) {
+        printf("%s has no animations\n", path);
+        return;
+    }
+
+    ogl::Skeleton skeleton;
+    collectBones(scene, skeleton);
+    ogl::NodeHierarchy hierarchy(scene, skeleton);
+    skeleton.finishLoading();
+    ogl::Animation animation(scene->mAnimations[0], hierarchy);
+    printf("%s: %zu nodes, %zu bones, %zu channels, %.1f s\n", path, hierarchy.size(), skeleton.size(),
+           animation.channels.size(), animation.duration / animation.ticksPerSecond);
+
+    const size_t counts[] = {1, 100, 500, 1000};
+    for (size_t count : counts) {
+        // every instance starts at another point in the animation
+        std::vector<ogl::AnimationState> states(count);
+        std::vector<ogl::Pose> poses(count);
+        for (size_t i = 0; i < count; i++) {
+            states[i].play(&animation);
+            states[i].update((float)i * 0.37f);
+        }
+        std::vector<ogl::AnimationState> searchStates = states;
+        std::vector<ogl::Pose> searchPoses(count);
+
+        double cached = run(hierarchy, skeleton, states, poses, 120, true);
+        double searched = run(hierarchy, skeleton, searchStates, searchPoses, 120, false);
+
+        bool same = true;
+        for (size_t i = 0; i < count && same; i++) {
+            same = memcmp(poses[i].palette.data(), searchPoses[i].palette.data(), poses[i].palette.size() * sizeof(glm::mat4)) == 0;
+        }
+        printf("  %5zu instances  cached keys %8.3f ms (%6.2f us each)  searched keys %8.3f ms  %s\n", count,
+               cached, cached * 1000.0 / count, searched, same ? "same poses" : "POSES DIFFER");
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            benchmark(argv[i]);
+        }
+    } else {
+        benchmark("resources/models/Soldier_Rig.fbx");
+        benchmark("resources/models/Main_Char_2_Anim.fbx");
+    }
+    return 0;
+}
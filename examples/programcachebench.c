@@ -0,0 +1,121 @@
+#include "eogll.h"
+
+// Links the same set of program variants from source (writing their caches) and then again from the program cache,
+// checks that the cached programs are complete and prints how long each pass took.
+// Usage: eogll_bench_program_cache [cache directory (has to exist)] [variants]
+// Needs an OpenGL context (the window is hidden). LIBGL_ALWAYS_SOFTWARE=1 runs it on Mesa's llvmpipe.
+
+static const char* vertexSource =
+    "#version 330 core\n"
+    "layout (location = 0) in vec3 aPos;\n"
+    "layout (location = 1) in vec3 aNormal;\n"
+    "uniform mat4 model;\n"
+    "uniform mat4 view;\n"
+    "uniform mat4 projection;\n"
+    "out vec3 normal;\n"
+    "out vec3 fragPos;\n"
+    "void main() {\n"
+    "    fragPos = vec3(model * vec4(aPos, 1.0));\n"
+    "    normal = mat3(transpose(inverse(model))) * aNormal;\n"
+    "    gl_Position = projection * view * vec4(fragPos, 1.0);\n"
+    "}\n";
+
+// every variant has a different number of lights, like the permutations of a material shader
+static const char* fragmentFormat =
+    "#version 330 core\n"
+    "#define NUM_LIGHTS %d\n"
+    "in vec3 normal;\n"
+    "in vec3 fragPos;\n"
+    "uniform vec3 lightPositions[NUM_LIGHTS];\n"
+    "uniform vec3 lightColors[NUM_LIGHTS];\n"
+    "uniform vec3 viewPos;\n"
+    "uniform float roughness;\n"
+    "out vec4 FragColor;\n"
+    "void main() {\n"
+    "    vec3 n = normalize(normal);\n"
+    "    vec3 v = normalize(viewPos - fragPos);\n"
+    "    vec3 color = vec3(0.0);\n"
+    "    for (int i = 0; i < NUM_LIGHTS; i++) {\n"
+    "        vec3 l = normalize(lightPositions[i] - fragPos);\n"
+    "        vec3 h = normalize(v + l);\n"
+    "        float d = length(lightPositions[i] - fragPos);\n"
+    "        float spec = pow(max(dot(n, h), 0.0), mix(128.0, 2.0, roughness));\n"
+    "        color += (max(dot(n, l), 0.0) + spec) * lightColors[i] / (d * d);\n"
+    "    }\n"
+    "    FragColor = vec4(color / (color + vec3(1.0)), 1.0);\n"
+    "}\n";
+
+static double linkAll(EogllShaderProgram** programs, char** fragmentSources, int variants) {
+    glFinish();
+    double start = eogllGetTime();
+    for (int i = 0; i < variants; i++) {
+        programs[i] = eogllLinkProgram(vertexSource, fragmentSources[i]);
+    }
+    glFinish();
+    return eogllGetTime() - start;
+}
+
+int main(int argc, char** argv) {
+    const char* directory = argc > 1 ? argv[1] : ".";
+    int variants = argc > 2 ? atoi(argv[2]) : 32;
+    if (variants <= 0) {
+        variants = 32;
+    }
+    if (eogllInit() != EOGLL_SUCCESS) {
+        return 1;
+    }
+    EogllWindow* window = eogllCreateWindow(800, 600, "EOGLL: Program Cache Benchmark", eogllCreateWindowHints(false, true, false, false, false, false, false));
+    printf("%s\n%s\n", glGetString(GL_RENDERER), glGetString(GL_VERSION));
+    if (!eogllProgramBinariesSupported()) {
+        printf("program binaries aren't supported, every program is compiled from source\n");
+    }
+    eogllSetProgramCacheDirectory(directory);
+
+    char** fragmentSources = (char**)malloc(sizeof(char*) * variants);
+    EogllShaderProgram** compiled = (EogllShaderProgram**)malloc(sizeof(EogllShaderProgram*) * variants);
+    EogllShaderProgram** cached = (EogllShaderProgram**)malloc(sizeof(EogllShaderProgram*) * variants);
+    for (int i = 0; i < variants; i++) {
+        size_t size = strlen(fragmentFormat) + 16;
+        fragmentSources[i] = (char*)malloc(size);
+        snprintf(fragmentSources[i], size, fragmentFormat, i + 1);
+        // start cold
+        char* path = eogllGetProgramCachePath(eogllHashProgramSources(vertexSource, fragmentSources[i], NULL));
+        if (path) {
+            remove(path);
+            free(path);
+        }
+    }
+
+    double cold = linkAll(compiled, fragmentSources, variants);
+    EogllProgramCacheStats afterCold = eogllGetProgramCacheStats();
+    double warm = linkAll(cached, fragmentSources, variants);
+    EogllProgramCacheStats afterWarm = eogllGetProgramCacheStats();
+
+    // a cached program has to look exactly like the one compiled from the same source
+    int failures = 0;
+    for (int i = 0; i < variants; i++) {
+        if (!compiled[i]->successful || !cached[i]->successful ||
+            compiled[i]->uniforms.numUniforms != cached[i]->uniforms.numUniforms ||
+            (eogllProgramBinariesSupported() && !cached[i]->cached)) {
+            printf("  variant %d doesn't match its cache\n", i);
+            failures++;
+        }
+    }
+
+    printf("%d variants\n", variants);
+    printf("  compiled  %8.3f ms  (%u caches written)\n", cold * 1000.0, afterCold.writes);
+    printf("  cached    %8.3f ms  (%u hits, %u rejected)  %5.2fx\n", warm * 1000.0, afterWarm.hits - afterCold.hits, afterWarm.rejected, warm > 0.0 ? cold / warm : 1.0);
+
+    for (int i = 0; i < variants; i++) {
+        eogllDeleteProgram(compiled[i]);
+        eogllDeleteProgram(cached[i]);
+        free(fragmentSources[i]);
+    }
+    free(fragmentSources);
+    free(compiled);
+    free(cached);
+    eogllSetProgramCacheDirectory(NULL);
+    eogllDestroyWindow(window);
+    eogllTerminate();
+    return failures == 0 ? 0 : 1;
+}
@@ -24,6 +24,12 @@ int main() {
 
     EogllShaderProgram* shader = eogllLinkProgramFromFile("resources/shaders/model.vert", "resources/shaders/model.frag");
 
+    // the first animation of the model is played, speed (left and right) and pausing (E) change how fast
+    ogl::BonePaletteBuffer palettes;
+    palettes.bindProgram(shader);
+    ogl::AnimationState animation(cube.animations.empty() ? nullptr : &cube.animations[0]);
+    ogl::Pose pose;
+
 
     ogl::Model model;
     model.scale() = {0.01f, 0.01f, 0.01f};
@@ -117,18 +123,12 @@ int main() {
         // model.rot() = {glfwGetTime()*8, glfwGetTime()*10, 0.0f};
 
         // finalBonesMatrices
-        // we will try something, by adding some random matrices to the bones
-        // for (int i = 0; i < 100; i++) {
-        //     std::string name = "finalBonesMatrices[" + std::to_string(i) + "]";
-        //     mat4 mat = {};
-        //     glm_mat4_identity(mat);
-        //     for (int j = 0; j < 4; j++) {
-        //         for (int k = 0; k < 4; k++) {
-        //             mat[j][k] = (float)rand() / RAND_MAX;
-        //         }
-        //     }
-        //     eogllSetUniformMatrix4fv(shader, name.c_str(), mat);
-        // }
+        animation.update((float)(window.dt() * speed));
+        pose.evaluate(cube.hierarchy, cube.skeleton, animation);
+        palettes.begin();
+        int slot = palettes.add(pose);
+        palettes.upload();
+        palettes.bind(slot);
 
         cube.draw(shader, [&](EogllShaderProgram* s) {
             model.update(s);
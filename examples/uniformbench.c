@@ -0,0 +1,121 @@
+#include "eogll.h"
+
+// Counts uniform updates per second, looking the locations up with the driver (how every setter used to work),
+// through the program's uniform table by name, with a hash computed once, and with the locations themselves.
+// Then writes the same values every time with and without shadowing (see eogllSetUniformShadowing).
+// Usage: eogll_bench_uniform [updates]
+// Needs an OpenGL context (the window is hidden).
+
+static const char* vertexSource =
+    "#version 330 core\n"
+    "layout (location = 0) in vec3 aPos;\n"
+    "uniform mat4 model;\n"
+    "uniform mat4 view;\n"
+    "uniform mat4 projection;\n"
+    "uniform vec3 tint;\n"
+    "out vec3 color;\n"
+    "void main() {\n"
+    "    color = tint;\n"
+    "    gl_Position = projection * view * model * vec4(aPos, 1.0);\n"
+    "}\n";
+
+static const char* fragmentSource =
+    "#version 330 core\n"
+    "in vec3 color;\n"
+    "out vec4 FragColor;\n"
+    "void main() {\n"
+    "    FragColor = vec4(color, 1.0);\n"
+    "}\n";
+
+static const char* names[] = {"model", "view", "projection"};
+
+static void report(const char* name, double time, int updates, double baseline) {
+    double perSecond = updates / time;
+    printf("  %-16s %8.3f ms  %12.0f updates/s  %5.2fx\n", name, time * 1000.0, perSecond, baseline > 0.0 ? baseline / time : 1.0);
+}
+
+int main(int argc, char** argv) {
+    int updates = argc > 1 ? atoi(argv[1]) : 1000000;
+    if (eogllInit() != EOGLL_SUCCESS) {
+        return 1;
+    }
+    EogllWindow* window = eogllCreateWindow(800, 600, "EOGLL: Uniform Benchmark", eogllCreateWindowHints(false, true, false, false, false, false, false));
+    EogllShaderProgram* shader = eogllLinkProgram(vertexSource, fragmentSource);
+    if (!shader || !shader->successful) {
+        return 1;
+    }
+    eogllUseProgram(shader);
+
+    mat4 matrix;
+    glm_mat4_identity(matrix);
+    uint32_t hashes[3];
+    GLint locations[3];
+    for (int i = 0; i < 3; i++) {
+        hashes[i] = eogllHashUniformName(names[i]);
+        locations[i] = eogllGetUniformLocation(shader, names[i]);
+    }
+    printf("%d updates of 3 mat4 uniforms (%u uniforms in the table)\n", updates, shader->uniforms.numUniforms);
+
+    glFinish();
+    double start = eogllGetTime();
+    for (int i = 0; i < updates; i++) {
+        matrix[3][0] = (float)i;
+        glUniformMatrix4fv(glGetUniformLocation(shader->id, names[i % 3]), 1, GL_FALSE, (float*)matrix);
+    }
+    glFinish();
+    double driver = eogllGetTime() - start;
+
+    start = eogllGetTime();
+    for (int i = 0; i < updates; i++) {
+        matrix[3][0] = (float)i;
+        eogllSetUniformMatrix4fv(shader, names[i % 3], matrix);
+    }
+    glFinish();
+    double byName = eogllGetTime() - start;
+
+    start = eogllGetTime();
+    for (int i = 0; i < updates; i++) {
+        matrix[3][0] = (float)i;
+        eogllSetUniformMatrix4fvLocation(eogllGetUniformLocationHashed(shader, names[i % 3], hashes[i % 3]), matrix);
+    }
+    glFinish();
+    double byHash = eogllGetTime() - start;
+
+    start = eogllGetTime();
+    for (int i = 0; i < updates; i++) {
+        matrix[3][0] = (float)i;
+        eogllSetUniformMatrix4fvLocation(locations[i % 3], matrix);
+    }
+    glFinish();
+    double byLocation = eogllGetTime() - start;
+
+    // the same value every time, like a camera that doesn't move
+    start = eogllGetTime();
+    for (int i = 0; i < updates; i++) {
+        eogllSetUniformMatrix4fv(shader, names[i % 3], matrix);
+    }
+    glFinish();
+    double unchanged = eogllGetTime() - start;
+
+    eogllSetUniformShadowing(shader, true);
+    start = eogllGetTime();
+    for (int i = 0; i < updates; i++) {
+        eogllSetUniformMatrix4fv(shader, names[i % 3], matrix);
+    }
+    glFinish();
+    double shadowed = eogllGetTime() - start;
+
+    report("driver lookup", driver, updates, driver);
+    report("table by name", byName, updates, driver);
+    report("table by hash", byHash, updates, driver);
+    report("location", byLocation, updates, driver);
+    printf("unchanged values\n");
+    report("not shadowed", unchanged, updates, unchanged);
+    report("shadowed", shadowed, updates, unchanged);
+    printf("  %llu writes issued, %llu skipped\n", (unsigned long long)shader->uniforms.issuedWrites, (unsigned long long)shader->uniforms.skippedWrites);
+
+    eogllDeleteProgram(shader);
+    eogllDestroyWindow(window);
+    eogllTerminate();
+    return 0;
+}
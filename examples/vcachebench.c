@@ -0,0 +1,75 @@
+#include "eogll.h"
+
+// Reports the vertex cache efficiency of object files before and after eogllOptimizeMesh.
+// Usage: eogll_bench_vcache [object files...]
+// Run from the repository root so resources/models can be found. Doesn't need a GPU.
+
+static void printStats(const char* name, EogllVertexCacheStats stats) {
+    printf("  %-12s ACMR %6.3f  ATVR %6.3f  (%u transforms, %u triangles, %u vertices)\n", name, stats.acmr, stats.atvr, stats.numTransforms, stats.numTriangles, stats.numVertices);
+}
+
+static void report(const char* path) {
+    EogllObjectAttrs attrs = eogllCreateObjectAttrs();
+    eogllAddObjectAttr(&attrs, GL_FLOAT, 3, EOGLL_ATTR_POSITION);
+    eogllAddObjectAttr(&attrs, GL_FLOAT, 3, EOGLL_ATTR_NORMAL);
+    EogllObjectLoadOptions options = eogllDefaultObjectLoadOptions();
+    float* vertices;
+    uint32_t numVertices;
+    unsigned int* indices;
+    uint32_t numIndices;
+    if (eogllLoadObjectFileEx(path, attrs, &options, &vertices, &numVertices, &indices, &numIndices, NULL) != EOGLL_SUCCESS) {
+        EOGLL_LOG_ERROR(stderr, "Failed to load %s\n", path);
+        return;
+    }
+    printf("%s\n", path);
+    uint32_t stride = 6 * sizeof(float);
+    printStats("original", eogllAnalyzeVertexCache(indices, numIndices, numVertices, EOGLL_VERTEX_CACHE_SIZE));
+
+    double start = eogllGetTime();
+    EogllResult result = eogllOptimizeVertexCache(indices, numIndices, numVertices, EOGLL_VERTEX_CACHE_SIZE);
+    double cacheTime = eogllGetTime() - start;
+    if (result == EOGLL_SUCCESS) {
+        printStats("vertex cache", eogllAnalyzeVertexCache(indices, numIndices, numVertices, EOGLL_VERTEX_CACHE_SIZE));
+        start = eogllGetTime();
+        result = eogllOptimizeOverdraw(indices, numIndices, vertices, stride, numVertices, EOGLL_VERTEX_CACHE_SIZE, EOGLL_OVERDRAW_THRESHOLD);
+    }
+    double overdrawTime = eogllGetTime() - start;
+    if (result == EOGLL_SUCCESS) {
+        printStats("overdraw", eogllAnalyzeVertexCache(indices, numIndices, numVertices, EOGLL_VERTEX_CACHE_SIZE));
+        start = eogllGetTime();
+        result = eogllOptimizeVertexFetch(vertices, &numVertices, stride, indices, numIndices);
+    }
+    double fetchTime = eogllGetTime() - start;
+    if (result != EOGLL_SUCCESS) {
+        EOGLL_LOG_ERROR(stderr, "Failed to optimize %s\n", path);
+    } else {
+        // the 32 entry cache shows how the order holds up on GPUs with a bigger cache than it was optimized for
+        printStats("optimized", eogllAnalyzeVertexCache(indices, numIndices, numVertices, EOGLL_VERTEX_CACHE_SIZE));
+        printStats("32 entries", eogllAnalyzeVertexCache(indices, numIndices, numVertices, 32));
+        printf("  took %.3f ms (vertex cache), %.3f ms (overdraw), %.3f ms (vertex fetch)\n", cacheTime * 1000.0, overdrawTime * 1000.0, fetchTime * 1000.0);
+    }
+    free(vertices);
+    free(indices);
+}
+
+int main(int argc, char** argv) {
+    if (eogllInit() != EOGLL_SUCCESS) {
+        return 1;
+    }
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            report(argv[i]);
+        }
+    } else {
+        const char* paths[] = {
+                "resources/models/cube.obj",
+                "resources/models/newcube.obj",
+                "resources/models/teapot.obj"
+        };
+        for (int i = 0; i < sizeof(paths) / sizeof(paths[0]); i++) {
+            report(paths[i]);
+        }
+    }
+    eogllTerminate();
+    return 0;
+}
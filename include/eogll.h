@@ -38,8 +38,13 @@
 #include "eogll/transforms.h"
 #include "eogll/camera.h"
 #include "eogll/obj_loader.h"
+#include "eogll/mesh_cache.h"
+#include "eogll/mesh_optimizer.h"
+#include "eogll/material.h"
 #include "eogll/gl.h"
 #include "eogll/framebuffer.h"
+#include "eogll/uniform_buffer.h"
+#include "eogll/program_cache.h"
 
 
 #ifdef __cplusplus
@@ -30,11 +30,14 @@ typedef EOGLL_DECL_STRUCT struct EogllVertAttribData {
     /// The type of the attribute
     GLenum type;
 
-    /// The number of elements in the attribute
+    /// The size of the attribute in bytes
     GLint size;
 
-    /// The offset of the attribute
+    /// Whether integer values are normalized to [0, 1] (unsigned) or [-1, 1] (signed) when they are read by the shader
     GLboolean normalized;
+
+    /// The number of components in the attribute (packed types like GL_INT_2_10_10_10_REV always have 4)
+    GLint num;
 } EogllVertAttribData;
 
 /**
@@ -93,6 +96,18 @@ EOGLL_DECL_FUNC_ND EogllAttribBuilder eogllCreateAttribBuilder();
  */
 EOGLL_DECL_FUNC void eogllAddAttribute(EogllAttribBuilder *builder, GLenum type, GLint num);
 
+/**
+ * @brief Adds an attribute to the attribute builder
+ * @param builder The attribute builder to add the attribute to
+ * @param type The type of the attribute
+ * @param num The number of elements in the attribute
+ * @param normalized Whether integer values are normalized when they are read by the shader
+ * @see eogllAddAttribute
+ *
+ * Same as eogllAddAttribute, but allows normalized integer attributes (for example normals packed into GL_INT_2_10_10_10_REV).
+ */
+EOGLL_DECL_FUNC void eogllAddAttributeEx(EogllAttribBuilder *builder, GLenum type, GLint num, GLboolean normalized);
+
 /**
  * @brief Builds the attributes for a vertex array object
  * @param builder The attribute builder to use
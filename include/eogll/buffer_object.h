@@ -55,6 +55,10 @@ typedef EOGLL_DECL_STRUCT struct EogllBufferObject {
     GLenum indicesType;
     /// Whether or not the buffer object has indices
     bool hasIndices;
+    /// The offset of quantized positions (position = positionOffset + value * positionScale, see EogllObjectQuantization)
+    float positionOffset[3];
+    /// The scale of quantized positions
+    float positionScale[3];
 } EogllBufferObject;
 
 /**
@@ -102,6 +106,7 @@ EOGLL_DECL_FUNC_ND EogllBufferObject eogllCreateBasicBufferObject(unsigned int v
  * @see EogllBufferObject
  *
  * This function draws a buffer object.
+ * Buffer objects without indices are drawn with eogllDrawBasicBufferObject.
  */
 EOGLL_DECL_FUNC void eogllDrawBufferObject(EogllBufferObject* bufferObject, GLenum mode);
 
@@ -149,6 +154,97 @@ EOGLL_DECL_FUNC void eogllBindBufferObject(EogllBufferObject* bufferObject);
  */
 EOGLL_DECL_FUNC void eogllDeleteBufferObject(EogllBufferObject* bufferObject);
 
+/**
+ * @brief A contiguous range of indices in a buffer object that is drawn with one material
+ * @see EogllRangedBufferObject
+ */
+typedef EOGLL_DECL_STRUCT struct EogllDrawRange {
+    /// The first index of the range
+    uint32_t firstIndex;
+    /// The number of indices in the range
+    uint32_t numIndices;
+    /// The material of the range (an index into the material library it was loaded with), -1 if it has none
+    int material;
+    /// Added to every index of the range (so several meshes can share one buffer without rewriting their indices)
+    int baseVertex;
+} EogllDrawRange;
+
+/**
+ * @brief A buffer object whose indices are split into ranges that each use one material
+ * @see eogllCreateRangedBufferObject
+ * @see eogllDrawRangedBufferObject
+ * @see eogllDeleteRangedBufferObject
+ *
+ * Every range shares the vertex array, vertex buffer and element buffer of one buffer object,
+ * so drawing all of them only binds the vertex array once.
+ * Ranges with the same material are next to each other, so each material only has to be set once.
+ */
+typedef EOGLL_DECL_STRUCT struct EogllRangedBufferObject {
+    /// The buffer object that holds the vertices and indices of every range
+    EogllBufferObject buffer;
+    /// The number of ranges
+    uint32_t numRanges;
+    /// The ranges
+    EogllDrawRange* ranges;
+} EogllRangedBufferObject;
+
+/**
+ * @brief Called before a range with a different material than the previous one is drawn
+ * @param range The range that is about to be drawn
+ * @param user The user pointer given to eogllDrawRangedBufferObject
+ * @see eogllDrawRangedBufferObject
+ */
+typedef void (*EogllDrawRangeFunc)(const EogllDrawRange* range, void* user);
+
+/**
+ * @brief Creates a ranged buffer object
+ * @param buffer The buffer object with indices that holds every range
+ * @param ranges The ranges (copied)
+ * @param numRanges The number of ranges
+ * @return The created ranged buffer object (with no ranges if they couldn't be copied)
+ * @see eogllDrawRangedBufferObject
+ * @see eogllDeleteRangedBufferObject
+ * @see EogllRangedBufferObject
+ */
+EOGLL_DECL_FUNC_ND EogllRangedBufferObject eogllCreateRangedBufferObject(EogllBufferObject buffer, const EogllDrawRange* ranges, uint32_t numRanges);
+
+/**
+ * @brief Draws every range of a ranged buffer object
+ * @param bufferObject The ranged buffer object to draw
+ * @param mode The mode to use
+ * @param func Called whenever the material changes, so it can be set (can be NULL)
+ * @param user Passed to func
+ * @see eogllCreateRangedBufferObject
+ * @see EogllRangedBufferObject
+ *
+ * The vertex array is bound once, then every range is drawn with its own glDrawElements
+ * (glDrawElementsBaseVertex for ranges with a base vertex).
+ */
+EOGLL_DECL_FUNC void eogllDrawRangedBufferObject(EogllRangedBufferObject* bufferObject, GLenum mode, EogllDrawRangeFunc func, void* user);
+
+/**
+ * @brief Draws one range of a ranged buffer object
+ * @param bufferObject The ranged buffer object
+ * @param mode The mode to draw in (GL_TRIANGLES, GL_LINES, etc.)
+ * @param index The index of the range
+ * @see eogllDrawRangedBufferObject
+ * @see eogllBindBufferObject
+ *
+ * Unlike eogllDrawRangedBufferObject, this doesn't bind the vertex array, so the buffer object has to be bound already.
+ * This is for drawing ranges in another order or more than once (like a mesh that is used by several nodes).
+ */
+EOGLL_DECL_FUNC void eogllDrawRange(const EogllRangedBufferObject* bufferObject, GLenum mode, uint32_t index);
+
+/**
+ * @brief Deletes a ranged buffer object
+ * @param bufferObject The ranged buffer object to delete
+ * @see eogllCreateRangedBufferObject
+ * @see EogllRangedBufferObject
+ *
+ * This deletes the buffer object as well.
+ */
+EOGLL_DECL_FUNC void eogllDeleteRangedBufferObject(EogllRangedBufferObject* bufferObject);
+
 #ifdef __cplusplus
 }
 #endif
@@ -12,6 +12,7 @@
 
 #include "pch.h"
 #include "shader.h"
+#include "uniform_buffer.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -160,6 +161,17 @@ EOGLL_DECL_FUNC void eogllMoveCamera(EogllCamera* cam, EogllCameraDirection dir,
  */
 EOGLL_DECL_FUNC void eogllUpdateCameraMatrix(EogllCamera* camera, EogllShaderProgram* program, const char* name);
 
+/**
+ * @brief Updates a camera matrix and position in the per-frame uniform block
+ * @param camera The camera to update
+ * @param frame The frame uniform buffer to write them to
+ * @see eogllUploadFrameUniforms
+ *
+ * Like eogllUpdateCameraMatrix, but every program that declares the EogllFrame block sees the new view
+ * after the next eogllUploadFrameUniforms.
+ */
+EOGLL_DECL_FUNC void eogllUpdateCameraUniforms(EogllCamera* camera, EogllFrameUniformBuffer* frame);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,127 @@
+/**
+ * @file material.h
+ * @brief EOGLL material library header file
+ * @date 2024-03-16
+ *
+ * EOGLL material library header file
+ *
+ * Material libraries (.mtl files) describe the materials an object file refers to with usemtl.
+ * Only the data is read here, nothing is uploaded (texture paths are resolved, but the textures aren't loaded).
+ */
+
+#pragma once
+#ifndef _EOGLL_MATERIAL_H_
+#define _EOGLL_MATERIAL_H_
+
+#include "pch.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// The size of the buffers that hold material names (including the terminator)
+#define EOGLL_MATERIAL_NAME_SIZE 128
+
+/// The size of the buffers that hold paths of material libraries and textures (including the terminator)
+#define EOGLL_MATERIAL_PATH_SIZE 256
+
+/**
+ * @brief A material from a material library
+ * @see EogllMaterialLibrary
+ *
+ * Colors that aren't in the file are left at their defaults (white diffuse, black everything else),
+ * texture maps that aren't in the file are empty strings.
+ */
+typedef EOGLL_DECL_STRUCT struct EogllMaterial {
+    /// The name of the material (newmtl)
+    char name[EOGLL_MATERIAL_NAME_SIZE];
+    /// The ambient color (Ka)
+    float ambient[3];
+    /// The diffuse color (Kd)
+    float diffuse[3];
+    /// The specular color (Ks)
+    float specular[3];
+    /// The emissive color (Ke)
+    float emissive[3];
+    /// The specular exponent (Ns)
+    float shininess;
+    /// The opacity (d, or 1 - Tr)
+    float opacity;
+    /// The illumination model (illum)
+    int illumination;
+    /// The ambient texture (map_Ka), relative to the working directory
+    char ambientMap[EOGLL_MATERIAL_PATH_SIZE];
+    /// The diffuse texture (map_Kd), relative to the working directory
+    char diffuseMap[EOGLL_MATERIAL_PATH_SIZE];
+    /// The specular texture (map_Ks), relative to the working directory
+    char specularMap[EOGLL_MATERIAL_PATH_SIZE];
+    /// The emissive texture (map_Ke), relative to the working directory
+    char emissiveMap[EOGLL_MATERIAL_PATH_SIZE];
+    /// The normal or bump texture (norm, map_Bump or bump), relative to the working directory
+    char normalMap[EOGLL_MATERIAL_PATH_SIZE];
+    /// The opacity texture (map_d), relative to the working directory
+    char opacityMap[EOGLL_MATERIAL_PATH_SIZE];
+} EogllMaterial;
+
+/**
+ * @brief The materials of one or more material libraries
+ * @see eogllCreateMaterialLibrary
+ * @see eogllParseMaterialFile
+ * @see eogllDeleteMaterialLibrary
+ */
+typedef EOGLL_DECL_STRUCT struct EogllMaterialLibrary {
+    /// The number of materials
+    uint32_t numMaterials;
+    /// The materials
+    EogllMaterial* materials;
+} EogllMaterialLibrary;
+
+/**
+ * @brief Creates an empty material library
+ * @return The created material library
+ * @see eogllParseMaterialFile
+ * @see eogllDeleteMaterialLibrary
+ */
+EOGLL_DECL_FUNC_ND EogllMaterialLibrary eogllCreateMaterialLibrary();
+
+/**
+ * @brief Parses the contents of a material library and adds its materials to a library
+ * @param buffer The contents of the material library (does not need to be null terminated)
+ * @param size The size of the buffer in bytes
+ * @param path The path the material library was read from, texture paths are resolved relative to it
+ * @param library The library to add the materials to
+ * @return EOGLL_SUCCESS if successful, EOGLL_FAILURE if not
+ * @see eogllParseMaterialFile
+ *
+ * Materials that are already in the library (with the same name) are replaced.
+ */
+EOGLL_DECL_FUNC_ND EogllResult eogllParseMaterialBuffer(const char* buffer, size_t size, const char* path, EogllMaterialLibrary* library);
+
+/**
+ * @brief Parses a material library (.mtl) file and adds its materials to a library
+ * @param path The path to the material library
+ * @param library The library to add the materials to
+ * @return EOGLL_SUCCESS if successful, EOGLL_FAILURE if not
+ * @see eogllParseMaterialBuffer
+ */
+EOGLL_DECL_FUNC_ND EogllResult eogllParseMaterialFile(const char* path, EogllMaterialLibrary* library);
+
+/**
+ * @brief Finds a material by name
+ * @param library The library to search
+ * @param name The name of the material
+ * @return The index of the material, -1 if there is no material with that name
+ */
+EOGLL_DECL_FUNC_ND int eogllFindMaterial(const EogllMaterialLibrary* library, const char* name);
+
+/**
+ * @brief Deletes a material library
+ * @param library The library to delete
+ */
+EOGLL_DECL_FUNC void eogllDeleteMaterialLibrary(EogllMaterialLibrary* library);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //_EOGLL_MATERIAL_H_
@@ -0,0 +1,110 @@
+/**
+ * @file mesh_cache.h
+ * @brief EOGLL binary mesh cache header file
+ * @date 2024-03-02
+ *
+ * EOGLL binary mesh cache header file
+ *
+ * A mesh cache (.eom file) stores a mesh exactly as it is uploaded to the GPU:
+ * the interleaved vertex buffer, the index buffer and the EogllObjectAttrs layout that describes them.
+ * Loading one is a memory map and two glBufferData calls, nothing is parsed.
+ *
+ * Layout (native byte order, the loader rejects files written with a different one):
+ * - a fixed size header (magic "EOM", version, attribute layout, counts, load options, position quantization, source file stamp and data offsets)
+ * - the vertex data, 16 byte aligned
+ * - the index data (16 or 32 bit), 16 byte aligned
+ */
+
+#pragma once
+#ifndef _EOGLL_MESH_CACHE_H_
+#define _EOGLL_MESH_CACHE_H_
+
+#include "pch.h"
+#include "obj_loader.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// The current version of the mesh cache format, caches with a different version are ignored
+#define EOGLL_MESH_CACHE_VERSION 3
+
+/**
+ * @brief Writes a mesh cache file
+ * @param path The path to write the mesh cache to
+ * @param attrs The object attributes that describe the vertices
+ * @param vertices The interleaved vertices (in the types of attrs)
+ * @param numVertices The number of vertices
+ * @param indices The indices
+ * @param numIndices The number of indices
+ * @param indicesType The type of the indices (GL_UNSIGNED_SHORT or GL_UNSIGNED_INT)
+ * @param quantization How to dequantize the positions (NULL if they aren't quantized)
+ * @param options The options the mesh was loaded with (NULL for the defaults)
+ * @param sourceTime The modification time of the file the mesh was loaded from (0 if there isn't one)
+ * @param sourceSize The size of the file the mesh was loaded from (0 if there isn't one)
+ * @return EOGLL_SUCCESS if successful, EOGLL_FAILURE if not
+ * @see eogllLoadMeshCache
+ * @see eogllGetFileInfo
+ *
+ * The file is written next to path first and then moved over it, so a reader never sees a half written cache.
+ */
+EOGLL_DECL_FUNC_ND EogllResult eogllWriteMeshCache(const char* path, EogllObjectAttrs attrs, const void* vertices, uint32_t numVertices, const void* indices, uint32_t numIndices, GLenum indicesType, const EogllObjectQuantization* quantization, const EogllObjectLoadOptions* options, uint64_t sourceTime, uint64_t sourceSize);
+
+/**
+ * @brief Loads a buffer object from a mesh cache file
+ * @param path The path to the mesh cache
+ * @param attrs The object attributes stored in the cache (can be NULL)
+ * @param usage The usage
+ * @return The created buffer object (all zeros if loading failed)
+ * @see eogllWriteMeshCache
+ * @see eogllLoadBufferObject
+ *
+ * The cache is memory mapped and handed straight to glBufferData.
+ */
+EOGLL_DECL_FUNC_ND EogllBufferObject eogllLoadMeshCache(const char* path, EogllObjectAttrs* attrs, GLenum usage);
+
+/**
+ * @brief *Internal*
+ * @param cachePath The path to the mesh cache
+ * @param sourcePath The path to the object file the cache was made from
+ * @param attrs The object attributes the cache has to match
+ * @param options The load options the cache has to match (NULL for the defaults)
+ * @param usage The usage
+ * @param bufferObject The created buffer object
+ * @return EOGLL_SUCCESS if the cache was loaded, EOGLL_FAILURE if it is missing, out of date or doesn't match attrs
+ * @see EogllObjectLoadOptions
+ *
+ * Loads a mesh cache only if it was written from sourcePath with its current modification time and size, with the same attributes
+ * and with the same parser, normal mode and mesh optimization.
+ * This is used by eogllLoadBufferObjectEx when EogllObjectLoadOptions::useCache is set.
+ */
+EOGLL_DECL_FUNC_ND EogllResult eogllLoadMeshCacheIfFresh(const char* cachePath, const char* sourcePath, EogllObjectAttrs attrs, const EogllObjectLoadOptions* options, GLenum usage, EogllBufferObject* bufferObject);
+
+/**
+ * @brief Gets the mesh cache path for an object file
+ * @param path The path to the object file
+ * @return The path with its extension replaced by ".eom" (must be freed), NULL if allocation failed
+ *
+ * This is where eogllLoadBufferObjectEx puts the cache of an object file.
+ */
+EOGLL_DECL_FUNC_ND char* eogllGetMeshCachePath(const char* path);
+
+/**
+ * @brief Converts an object file into a mesh cache file
+ * @param path The path to the object file
+ * @param cachePath The path to write the mesh cache to
+ * @param attrs The object attributes to use
+ * @param options The options to load the object file with (NULL for the defaults)
+ * @return EOGLL_SUCCESS if successful, EOGLL_FAILURE if not
+ * @see eogllLoadObjectFileEx
+ * @see eogllWriteMeshCache
+ *
+ * This can be used to bake caches ahead of time, it doesn't need an OpenGL context.
+ */
+EOGLL_DECL_FUNC_ND EogllResult eogllConvertObjectToMeshCache(const char* path, const char* cachePath, EogllObjectAttrs attrs, const EogllObjectLoadOptions* options);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //_EOGLL_MESH_CACHE_H_
@@ -0,0 +1,128 @@
+/**
+ * @file mesh_optimizer.h
+ * @brief EOGLL mesh optimizer header file
+ * @date 2024-03-09
+ *
+ * EOGLL mesh optimizer header file
+ *
+ * Reorders index and vertex buffers so the GPU does less work drawing them, without changing what is drawn:
+ * - eogllOptimizeVertexCache reorders triangles so recently transformed vertices are reused (Tipsify)
+ * - eogllOptimizeOverdraw reorders clusters of triangles so outward facing ones are drawn first
+ * - eogllOptimizeVertexFetch reorders vertices in the order they are first used
+ *
+ * eogllAnalyzeVertexCache measures the result on a simulated FIFO vertex cache, so it can be checked without a GPU.
+ * None of these need an OpenGL context.
+ */
+
+#pragma once
+#ifndef _EOGLL_MESH_OPTIMIZER_H_
+#define _EOGLL_MESH_OPTIMIZER_H_
+
+#include "pch.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// The vertex cache size the optimizer targets by default (close to the post transform cache of most GPUs)
+#define EOGLL_VERTEX_CACHE_SIZE 16
+
+/// The default overdraw threshold, how much worse (as a factor) the vertex cache can get to reduce overdraw
+#define EOGLL_OVERDRAW_THRESHOLD 1.05f
+
+/**
+ * @brief The result of simulating an index buffer on a FIFO vertex cache
+ * @see eogllAnalyzeVertexCache
+ */
+typedef EOGLL_DECL_STRUCT struct EogllVertexCacheStats {
+    /// The number of vertices that missed the cache (and had to be transformed)
+    uint32_t numTransforms;
+    /// The number of triangles
+    uint32_t numTriangles;
+    /// The number of distinct vertices the indices reference
+    uint32_t numVertices;
+    /// Average cache miss ratio, transformed vertices per triangle (0.5 is the best possible for large meshes, 3 the worst)
+    float acmr;
+    /// Average transform to vertex ratio, transformed vertices per distinct vertex (1 is the best possible)
+    float atvr;
+} EogllVertexCacheStats;
+
+/**
+ * @brief Simulates a FIFO vertex cache to measure an index buffer
+ * @param indices The triangle indices
+ * @param numIndices The number of indices (a multiple of 3)
+ * @param numVertices The number of vertices the indices point into
+ * @param cacheSize The number of vertices in the simulated cache (0 uses EOGLL_VERTEX_CACHE_SIZE)
+ * @return The statistics (all zeros if there are no triangles)
+ */
+EOGLL_DECL_FUNC_ND EogllVertexCacheStats eogllAnalyzeVertexCache(const unsigned int* indices, uint32_t numIndices, uint32_t numVertices, uint32_t cacheSize);
+
+/**
+ * @brief Reorders triangles to make better use of the vertex cache
+ * @param indices The triangle indices, reordered in place
+ * @param numIndices The number of indices (a multiple of 3)
+ * @param numVertices The number of vertices the indices point into
+ * @param cacheSize The vertex cache size to optimize for (0 uses EOGLL_VERTEX_CACHE_SIZE)
+ * @return EOGLL_SUCCESS if successful, EOGLL_FAILURE if not (the indices are left as they were)
+ * @see eogllAnalyzeVertexCache
+ *
+ * This is Tipsify (Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw"),
+ * it runs in linear time. The winding of every triangle is kept.
+ * If the new order doesn't transform fewer vertices than the old one, the old one is kept.
+ */
+EOGLL_DECL_FUNC_ND EogllResult eogllOptimizeVertexCache(unsigned int* indices, uint32_t numIndices, uint32_t numVertices, uint32_t cacheSize);
+
+/**
+ * @brief Reorders clusters of triangles to reduce overdraw
+ * @param indices The triangle indices (already optimized by eogllOptimizeVertexCache), reordered in place
+ * @param numIndices The number of indices (a multiple of 3)
+ * @param positions The position of the first vertex (3 floats)
+ * @param positionStride The number of bytes between the positions of two vertices
+ * @param numVertices The number of vertices the indices point into
+ * @param cacheSize The vertex cache size the indices were optimized for (0 uses EOGLL_VERTEX_CACHE_SIZE)
+ * @param threshold How much the cache miss ratio of a cluster can grow when it is split (1 keeps the clusters from the cache optimizer)
+ * @return EOGLL_SUCCESS if successful, EOGLL_FAILURE if not (the indices are left as they were)
+ *
+ * The triangles are split into clusters where the vertex cache starts over,
+ * and the clusters are sorted so the ones facing away from the center of the mesh are drawn first,
+ * which are the most likely to hide the others from any view.
+ * If that makes the vertex cache more than threshold worse, the old order is kept.
+ */
+EOGLL_DECL_FUNC_ND EogllResult eogllOptimizeOverdraw(unsigned int* indices, uint32_t numIndices, const float* positions, size_t positionStride, uint32_t numVertices, uint32_t cacheSize, float threshold);
+
+/**
+ * @brief Reorders vertices in the order the indices first use them
+ * @param vertices The interleaved vertices, reordered in place
+ * @param numVertices The number of vertices, set to the number of vertices that are used
+ * @param stride The size of a vertex in bytes
+ * @param indices The triangle indices, rewritten to point to the new vertex order
+ * @param numIndices The number of indices
+ * @return EOGLL_SUCCESS if successful, EOGLL_FAILURE if not (nothing is changed)
+ *
+ * This makes vertex fetches walk through the vertex buffer in order. Vertices no index uses are dropped.
+ * Run it after the index order is final.
+ */
+EOGLL_DECL_FUNC_ND EogllResult eogllOptimizeVertexFetch(void* vertices, uint32_t* numVertices, uint32_t stride, unsigned int* indices, uint32_t numIndices);
+
+/**
+ * @brief Runs every optimization on a mesh
+ * @param vertices The interleaved vertices, reordered in place
+ * @param numVertices The number of vertices, set to the number of vertices that are used
+ * @param stride The size of a vertex in bytes
+ * @param positionOffset The byte offset of the position (3 floats) in a vertex, -1 if it isn't stored as floats (skips the overdraw optimization)
+ * @param indices The triangle indices, reordered in place
+ * @param numIndices The number of indices (a multiple of 3)
+ * @return EOGLL_SUCCESS if successful, EOGLL_FAILURE if not
+ * @see eogllOptimizeVertexCache
+ * @see eogllOptimizeOverdraw
+ * @see eogllOptimizeVertexFetch
+ *
+ * Uses EOGLL_VERTEX_CACHE_SIZE and EOGLL_OVERDRAW_THRESHOLD.
+ */
+EOGLL_DECL_FUNC_ND EogllResult eogllOptimizeMesh(void* vertices, uint32_t* numVertices, uint32_t stride, int positionOffset, unsigned int* indices, uint32_t numIndices);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //_EOGLL_MESH_OPTIMIZER_H_
@@ -13,6 +13,7 @@
 #include "pch.h"
 #include "attrib_builder.h"
 #include "buffer_object.h"
+#include "material.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -88,12 +89,14 @@ typedef EOGLL_DECL_STRUCT struct EogllObjectIndex {
  * @see eogllLoadBufferObject
  *
  * A way to store faces for an object.
+ * The indices of every face are stored in one array (EogllObjectFileData::indices).
+ * After parsing, every face is a triangle (polygons are triangulated by the parser).
  */
 typedef EOGLL_DECL_STRUCT struct EogllObjectFileFace {
     /// The number of indices
     unsigned int numIndices;
-    /// The indices
-    EogllObjectIndex *indices;
+    /// The position of the first index in EogllObjectFileData::indices
+    unsigned int firstIndex;
 } EogllObjectFileFace;
 
 /**
@@ -152,6 +155,22 @@ typedef EOGLL_DECL_STRUCT struct EogllObjectTexCoord {
     bool hasW;
 } EogllObjectTexCoord;
 
+/**
+ * @brief *Internal*
+ * @see EogllObjectFileData
+ * @see eogllLoadRangedBufferObject
+ *
+ * A range of faces that use the same material (from usemtl).
+ */
+typedef EOGLL_DECL_STRUCT struct EogllObjectMaterialGroup {
+    /// The name of the material (empty for the faces before the first usemtl)
+    char material[EOGLL_MATERIAL_NAME_SIZE];
+    /// The first face
+    unsigned int firstFace;
+    /// The number of faces
+    unsigned int numFaces;
+} EogllObjectMaterialGroup;
+
 /**
  * @brief *Internal*
  * @see EogllObjectAttrs
@@ -164,6 +183,10 @@ typedef EOGLL_DECL_STRUCT struct EogllObjectFileData {
     unsigned int numFaces;
     /// The faces
     EogllObjectFileFace *faces;
+    /// The number of face indices
+    unsigned int numIndices;
+    /// The indices of all the faces
+    EogllObjectIndex *indices;
     /// The number of positions
     unsigned int numPositions;
     /// The positions
@@ -176,6 +199,14 @@ typedef EOGLL_DECL_STRUCT struct EogllObjectFileData {
     unsigned int numTexCoords;
     /// The texture coordinates
     EogllObjectTexCoord *texCoords;
+    /// The number of material groups (0 if the object file doesn't use usemtl)
+    unsigned int numGroups;
+    /// The material groups in file order, when there are any they cover every face
+    EogllObjectMaterialGroup *groups;
+    /// The number of material libraries
+    unsigned int numMaterialLibraries;
+    /// The material libraries (from mtllib), relative to the object file
+    char **materialLibraries;
 } EogllObjectFileData;
 
 /**
@@ -187,9 +218,67 @@ typedef EOGLL_DECL_STRUCT struct EogllObjectFileData {
  * @see eogllLoadBufferObject
  *
  * This function parses an object file into an object file data struct.
+ * Faces with more than 3 indices are triangulated (fanned if they are convex, ear clipped if not).
  */
 EOGLL_DECL_FUNC_ND EogllResult eogllParseObjectFile(FILE* file, EogllObjectFileData *data);
 
+/**
+ * @brief *Internal*
+ * @param buffer The contents of an object file (does not need to be null terminated)
+ * @param size The size of the buffer in bytes
+ * @param data The data to store the parsed data in
+ * @return EOGLL_SUCCESS if successful, EOGLL_FAILURE if not
+ * @see eogllParseObjectFileFast
+ * @see EogllObjectFileData
+ *
+ * This function parses the contents of an object file in a single pass.
+ * Instead of counting everything first and then using sscanf, the arrays are grown as needed
+ * and numbers are read with a hand written scanner.
+ * Negative (relative) indices are resolved while parsing.
+ * Faces with more than 3 indices are triangulated (fanned if they are convex, ear clipped if not).
+ * The result is the same as eogllParseObjectFile.
+ */
+EOGLL_DECL_FUNC_ND EogllResult eogllParseObjectBuffer(const char* buffer, size_t size, EogllObjectFileData *data);
+
+/**
+ * @brief *Internal*
+ * @param path The path to the object file
+ * @param data The data to store the parsed data in
+ * @return EOGLL_SUCCESS if successful, EOGLL_FAILURE if not
+ * @see eogllParseObjectBuffer
+ * @see eogllMapFile
+ *
+ * This function memory maps an object file and parses it with eogllParseObjectBuffer.
+ */
+EOGLL_DECL_FUNC_ND EogllResult eogllParseObjectFileFast(const char* path, EogllObjectFileData *data);
+
+/**
+ * @brief *Internal*
+ * @param buffer The contents of an object file (does not need to be null terminated)
+ * @param size The size of the buffer in bytes
+ * @param data The data to store the parsed data in
+ * @param numThreads The number of threads to use (0 uses one per processor)
+ * @return EOGLL_SUCCESS if successful, EOGLL_FAILURE if not
+ * @see eogllParseObjectBuffer
+ *
+ * This function splits the buffer into chunks that start at the beginning of a line and parses them at the same time.
+ * The results are merged in file order, so the result is the same as eogllParseObjectBuffer (including relative indices).
+ * Small buffers are parsed with fewer threads (or just one), since starting threads would take longer than parsing.
+ */
+EOGLL_DECL_FUNC_ND EogllResult eogllParseObjectBufferParallel(const char* buffer, size_t size, EogllObjectFileData *data, unsigned int numThreads);
+
+/**
+ * @brief *Internal*
+ * @param path The path to the object file
+ * @param data The data to store the parsed data in
+ * @param numThreads The number of threads to use (0 uses one per processor)
+ * @return EOGLL_SUCCESS if successful, EOGLL_FAILURE if not
+ * @see eogllParseObjectBufferParallel
+ *
+ * This function memory maps an object file and parses it with eogllParseObjectBufferParallel.
+ */
+EOGLL_DECL_FUNC_ND EogllResult eogllParseObjectFileParallel(const char* path, EogllObjectFileData *data, unsigned int numThreads);
+
 /**
  * @brief *Internal*
  * @param data The object file data struct to delete
@@ -219,6 +308,84 @@ typedef EOGLL_DECL_STRUCT struct EogllObjectAttrs {
     EogllAttribBuilder builder;
 } EogllObjectAttrs;
 
+/**
+ * @brief An enum that represents which parser is used to read object files
+ * @see EogllObjectLoadOptions
+ */
+typedef EOGLL_DECL_ENUM enum EogllObjectParseMode {
+    /// The original parser (eogllParseObjectFile), reads the file twice with fgets and sscanf
+    EOGLL_OBJ_PARSE_LEGACY,
+    /// The single pass parser (eogllParseObjectFileFast), memory maps the file
+    EOGLL_OBJ_PARSE_FAST
+} EogllObjectParseMode;
+
+/**
+ * @brief An enum that represents how normals are generated for object files without them
+ * @see eogllGenerateNormalsEx
+ * @see EogllObjectLoadOptions
+ */
+typedef EOGLL_DECL_ENUM enum EogllObjectNormalMode {
+    /// One normal per triangle, gives a faceted look
+    EOGLL_OBJ_NORMALS_FLAT,
+    /// One normal per position, averaged over the triangles around it (weighted by the corner angle)
+    EOGLL_OBJ_NORMALS_SMOOTH
+} EogllObjectNormalMode;
+
+/**
+ * @brief A struct that holds the options used when loading an object file
+ * @see eogllDefaultObjectLoadOptions
+ * @see eogllLoadObjectFileEx
+ * @see eogllLoadBufferObjectEx
+ */
+typedef EOGLL_DECL_STRUCT struct EogllObjectLoadOptions {
+    /// Which parser to use
+    EogllObjectParseMode parseMode;
+    /// The number of threads used by the fast parser (0 uses one per processor, the legacy parser ignores this)
+    unsigned int numThreads;
+    /// Whether eogllLoadBufferObjectEx writes a mesh cache (.eom) next to the object file and loads from it while the object file is unchanged
+    bool useCache;
+    /// How normals are generated when they are requested but the object file doesn't have them
+    EogllObjectNormalMode normalMode;
+    /**
+     * @brief The size in bytes of the vertex batches used by eogllLoadBufferObjectEx (0 loads the whole mesh at once)
+     * @see eogllLoadBufferObjectStreamed
+     *
+     * When this isn't 0, the mesh is streamed: vertices are built and uploaded this many bytes at a time.
+     */
+    size_t streamBudget;
+    /**
+     * @brief Whether the triangles and vertices are reordered for the GPU after loading
+     * @see eogllOptimizeMesh
+     *
+     * Streamed meshes have no indices and aren't optimized.
+     */
+    bool optimizeMesh;
+} EogllObjectLoadOptions;
+
+/**
+ * @brief Creates an object load options struct with default values
+ * @return The created object load options struct
+ * @see EogllObjectLoadOptions
+ *
+ * These are the options used by eogllLoadObjectFile and eogllLoadBufferObject.
+ */
+EOGLL_DECL_FUNC_ND EogllObjectLoadOptions eogllDefaultObjectLoadOptions();
+
+/**
+ * @brief How quantized positions are turned back into object space
+ * @see eogllAddObjectAttr
+ *
+ * When positions are stored in a normalized integer type, the shader reads them in [0, 1] (unsigned) or [-1, 1] (signed)
+ * and gets the object space position with offset + value * scale.
+ * For other types the offset is 0 and the scale is 1.
+ */
+typedef EOGLL_DECL_STRUCT struct EogllObjectQuantization {
+    /// The offset to add to the dequantized position
+    float offset[3];
+    /// The scale to multiply the dequantized position by
+    float scale[3];
+} EogllObjectQuantization;
+
 /**
  * @brief *Internal*
  * @param data The object file data struct to convert
@@ -228,19 +395,35 @@ typedef EOGLL_DECL_STRUCT struct EogllObjectAttrs {
  * @param indices Resulting indices
  * @param numIndices Resulting number of indices
  * @return EOGLL_SUCCESS if successful, EOGLL_FAILURE if not
+ * @see eogllObjectFileDataToVerticesEx
  *
  * This function converts an object file data struct to vertices and indices.
- * If something goes wrong with object loading (SEGFAULT or alike), this function is probably the culprit.
- * This function is still a work in progress, and is not optimized or hardly tested.
- * Bad input will easily cause a SEGFAULT.
+ * The vertices are interleaved in the types of attrs, when every attribute is GL_FLOAT this is an array of floats,
+ * otherwise it holds the packed bytes (numVertices times the stride of attrs).
+ * Face corners that use the same position, texture coordinate and normal are welded into a single vertex,
+ * so numVertices is the number of unique vertices and the indices reference them.
+ * Indices that are out of range produce zeroed attributes instead of reading out of bounds.
  * This function is used internally by eogllLoadObjectFile.
- *
- * @warning This function is still a work in progress, and is not optimized or hardly tested.
- *
- * @todo Optimize this function and test it more
  */
 EOGLL_DECL_FUNC_ND EogllResult eogllObjectFileDataToVertices(EogllObjectFileData *data, EogllObjectAttrs attrs, float** vertices, uint32_t* numVertices, unsigned int** indices, uint32_t* numIndices);
 
+/**
+ * @brief *Internal*
+ * @param data The object file data struct to convert
+ * @param attrs The object attributes to use
+ * @param vertices Resulting vertices
+ * @param numVertices Resulting number of vertices
+ * @param indices Resulting indices
+ * @param numIndices Resulting number of indices
+ * @param quantization Resulting position quantization (can be NULL)
+ * @return EOGLL_SUCCESS if successful, EOGLL_FAILURE if not
+ * @see eogllObjectFileDataToVertices
+ * @see EogllObjectQuantization
+ *
+ * Same as eogllObjectFileDataToVertices, but also returns how to dequantize the positions.
+ */
+EOGLL_DECL_FUNC_ND EogllResult eogllObjectFileDataToVerticesEx(EogllObjectFileData *data, EogllObjectAttrs attrs, float** vertices, uint32_t* numVertices, unsigned int** indices, uint32_t* numIndices, EogllObjectQuantization* quantization);
+
 /**
  * @brief *Internal*
  * @param path The path to the object file
@@ -258,6 +441,25 @@ EOGLL_DECL_FUNC_ND EogllResult eogllObjectFileDataToVertices(EogllObjectFileData
  */
 EOGLL_DECL_FUNC_ND EogllResult eogllLoadObjectFile(const char* path, EogllObjectAttrs attrs, float** vertices, uint32_t* numVertices, unsigned int** indices, uint32_t* numIndices);
 
+/**
+ * @brief *Internal*
+ * @param path The path to the object file
+ * @param attrs The object attributes to use
+ * @param options The options to load the file with
+ * @param vertices Resulting vertices
+ * @param numVertices Resulting number of vertices
+ * @param indices Resulting indices
+ * @param numIndices Resulting number of indices
+ * @param quantization Resulting position quantization (can be NULL)
+ * @return EOGLL_SUCCESS if successful, EOGLL_FAILURE if not
+ * @see eogllLoadObjectFile
+ * @see EogllObjectLoadOptions
+ *
+ * Same as eogllLoadObjectFile, but allows choosing how the file is loaded.
+ * With EOGLL_DEBUG defined, the time spent in each step is logged.
+ */
+EOGLL_DECL_FUNC_ND EogllResult eogllLoadObjectFileEx(const char* path, EogllObjectAttrs attrs, const EogllObjectLoadOptions* options, float** vertices, uint32_t* numVertices, unsigned int** indices, uint32_t* numIndices, EogllObjectQuantization* quantization);
+
 /**
  * @brief Creates an object attributes struct
  * @return The created object attributes struct
@@ -278,6 +480,15 @@ EOGLL_DECL_FUNC_ND EogllObjectAttrs eogllCreateObjectAttrs();
  * @see eogllCreateObjectAttrs
  *
  * This function adds an object attribute to an object attributes struct.
+ *
+ * The attribute can be packed into a smaller type than GL_FLOAT to save vertex bandwidth:
+ * - GL_HALF_FLOAT works for every attribute.
+ * - GL_SHORT, GL_UNSIGNED_SHORT, GL_BYTE and GL_UNSIGNED_BYTE are normalized.
+ *   Positions in these types are quantized to the bounding box of the mesh (see EogllObjectQuantization).
+ * - GL_INT_2_10_10_10_REV is normalized and meant for normals.
+ * - Normals with 2 components are octahedral encoded, the shader has to decode them.
+ *
+ * 2 and 1 byte types are padded to a multiple of 4 bytes (a padded position w is 1, everything else is 0).
  */
 EOGLL_DECL_FUNC void eogllAddObjectAttr(EogllObjectAttrs* attrs, GLenum type, GLint num, EogllObjectAttrType attrType);
 
@@ -295,17 +506,94 @@ EOGLL_DECL_FUNC void eogllAddObjectAttr(EogllObjectAttrs* attrs, GLenum type, GL
  */
 EOGLL_DECL_FUNC_ND EogllBufferObject eogllLoadBufferObject(const char* path, EogllObjectAttrs attrs, GLenum usage);
 
+/**
+ * @brief Loads a buffer object from an object file with the given options
+ * @param path The path to the object file
+ * @param attrs The object attributes to use
+ * @param usage The usage
+ * @param options The options to load the file with
+ * @return The created buffer object
+ * @see eogllLoadBufferObject
+ * @see eogllDefaultObjectLoadOptions
+ *
+ * This function loads a buffer object from an object file.
+ * With EogllObjectLoadOptions::useCache set, the mesh cache from eogllGetMeshCachePath is used when it is up to date
+ * and written when it isn't (see mesh_cache.h).
+ * With EogllObjectLoadOptions::streamBudget set, eogllLoadBufferObjectStreamed is used (and no cache is written).
+ */
+EOGLL_DECL_FUNC_ND EogllBufferObject eogllLoadBufferObjectEx(const char* path, EogllObjectAttrs attrs, GLenum usage, const EogllObjectLoadOptions* options);
+
+/**
+ * @brief Loads a buffer object from an object file without keeping the whole mesh in memory
+ * @param path The path to the object file
+ * @param attrs The object attributes to use
+ * @param usage The usage
+ * @param options The options to load the file with (EogllObjectLoadOptions::streamBudget is the batch size)
+ * @return The created buffer object (without indices, draw it with eogllDrawBasicBufferObject)
+ * @see eogllLoadBufferObjectEx
+ *
+ * Only the positions, normals and texture coordinates of the file are kept in memory.
+ * The file is read again to build the vertices of the faces, which are uploaded with glBufferSubData
+ * in batches of at most streamBudget bytes into a buffer that is allocated up front.
+ * Vertices are not welded, so the buffer object has 3 vertices per triangle.
+ * With EOGLL_DEBUG defined, the peak resident memory of the process is logged.
+ */
+EOGLL_DECL_FUNC_ND EogllBufferObject eogllLoadBufferObjectStreamed(const char* path, EogllObjectAttrs attrs, GLenum usage, const EogllObjectLoadOptions* options);
+
+/**
+ * @brief Loads an object file into one buffer object with a draw range per material
+ * @param path The path to the object file
+ * @param attrs The object attributes to use
+ * @param usage The usage
+ * @param options The options to load the file with (useCache and streamBudget are ignored)
+ * @param materials The library the material libraries of the object file (mtllib) are added to, can be NULL
+ * @return The created ranged buffer object (with no ranges if it failed)
+ * @see eogllDrawRangedBufferObject
+ * @see eogllLoadBufferObjectEx
+ *
+ * The faces are grouped by material (usemtl) so every material is one contiguous range of indices,
+ * ordered like the materials in the library. Faces without a known material come first, with material -1.
+ * The material of a range is an index into materials, which can already contain materials (they are reused by name).
+ * With EogllObjectLoadOptions::optimizeMesh set, every range is optimized on its own.
+ */
+EOGLL_DECL_FUNC_ND EogllRangedBufferObject eogllLoadRangedBufferObject(const char* path, EogllObjectAttrs attrs, GLenum usage, const EogllObjectLoadOptions* options, EogllMaterialLibrary* materials);
+
 /**
  * @brief Generates normals for an object file
  * @param data The object file data struct to generate normals for
  * @see EogllObjectFileData
  * @see eogllObjectFileDataToVertices
  * @see eogllLoadObjectFile
+ * @see eogllGenerateNormalsEx
  * 
- * This function generates normals for an object file.
+ * This function generates smooth normals for an object file.
  */
 EOGLL_DECL_FUNC void eogllGenerateNormals(EogllObjectFileData *data);
 
+/**
+ * @brief Generates normals for an object file
+ * @param data The object file data struct to generate normals for (every face must be a triangle)
+ * @param mode Whether to generate flat or smooth normals
+ * @return EOGLL_SUCCESS if successful, EOGLL_FAILURE if not
+ * @see EogllObjectNormalMode
+ *
+ * The normals of the object file are replaced and every face index is pointed at its new normal.
+ * Smooth normals are shared by every corner at the same position.
+ */
+EOGLL_DECL_FUNC_ND EogllResult eogllGenerateNormalsEx(EogllObjectFileData *data, EogllObjectNormalMode mode);
+
+/**
+ * @brief *Internal*
+ * @param indices The indices, narrowed in place
+ * @param numIndices The number of indices
+ * @param numVertices The number of vertices the indices point into
+ * @param indicesSize The size of the index buffer in bytes after narrowing
+ * @return The index type (GL_UNSIGNED_SHORT if every index fits in 16 bits, GL_UNSIGNED_INT if not)
+ *
+ * Halves the size of the index buffer when the mesh is small enough. Used by the buffer object loaders and the mesh cache.
+ */
+EOGLL_DECL_FUNC_ND GLenum eogllObjNarrowIndices(unsigned int* indices, uint32_t numIndices, uint32_t numVertices, GLsizeiptr* indicesSize);
+
 #ifdef __cplusplus
 }
 #endif
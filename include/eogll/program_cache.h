@@ -0,0 +1,132 @@
+/**
+ * @file program_cache.h
+ * @brief EOGLL program binary cache header file
+ * @date 2024-10-25
+ *
+ * EOGLL program binary cache header file
+ *
+ * A program cache (.eop file) stores a linked program as the driver returns it from glGetProgramBinary,
+ * so the next launch can skip compiling and linking the GLSL.
+ * Caches are named after a hash of the sources, the defines and the driver (vendor, renderer and version strings),
+ * so editing a shader or updating the driver makes eogllLinkProgram compile from source again.
+ *
+ * Layout (native byte order, the loader rejects files written with a different one):
+ * - a fixed size header (magic "EOP", version, program key, driver hash, binary format, binary size and a hash of the binary)
+ * - the program binary
+ *
+ * Needs OpenGL 4.1 or ARB_get_program_binary, and a driver that reports at least one binary format.
+ * Everything falls back to compiling from source when it isn't available.
+ */
+
+#pragma once
+#ifndef _EOGLL_PROGRAM_CACHE_H_
+#define _EOGLL_PROGRAM_CACHE_H_
+
+#include "pch.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// The current version of the program cache format, caches with a different version are ignored
+#define EOGLL_PROGRAM_CACHE_VERSION 1
+
+/**
+ * @brief Counters of the program cache, since the start of the program
+ * @see eogllGetProgramCacheStats
+ */
+typedef EOGLL_DECL_STRUCT struct EogllProgramCacheStats {
+    /// The number of programs loaded from a cache
+    uint32_t hits;
+    /// The number of programs that had no cache
+    uint32_t misses;
+    /// The number of caches that were out of date, corrupt or refused by the driver
+    uint32_t rejected;
+    /// The number of caches written
+    uint32_t writes;
+} EogllProgramCacheStats;
+
+/**
+ * @brief Sets the directory eogllLinkProgram keeps program caches in
+ * @param directory The directory (it has to exist), NULL disables the cache
+ *
+ * The cache is disabled by default. The directory is copied.
+ */
+EOGLL_DECL_FUNC void eogllSetProgramCacheDirectory(const char* directory);
+
+/**
+ * @brief Gets the directory program caches are kept in
+ * @return The directory, NULL if the cache is disabled
+ * @see eogllSetProgramCacheDirectory
+ */
+EOGLL_DECL_FUNC_ND const char* eogllGetProgramCacheDirectory();
+
+/**
+ * @brief Checks if the current context can save and load program binaries
+ * @return Whether program binaries are supported
+ *
+ * The entry points are looked up the first time this is called, so it needs a current context.
+ */
+EOGLL_DECL_FUNC_ND bool eogllProgramBinariesSupported();
+
+/**
+ * @brief Hashes everything a program binary depends on
+ * @param vertexShaderSource The source of the vertex shader
+ * @param fragmentShaderSource The source of the fragment shader
+ * @param defines The defines the sources are compiled with (NULL if there are none)
+ * @return The key of the program
+ *
+ * The vendor, renderer and version strings of the current context are part of the key.
+ */
+EOGLL_DECL_FUNC_ND uint64_t eogllHashProgramSources(const char* vertexShaderSource, const char* fragmentShaderSource, const char* defines);
+
+/**
+ * @brief Gets the path of the cache of a program
+ * @param key The key of the program (see eogllHashProgramSources)
+ * @return The path in the cache directory (must be freed), NULL if the cache is disabled or allocation failed
+ */
+EOGLL_DECL_FUNC_ND char* eogllGetProgramCachePath(uint64_t key);
+
+/**
+ * @brief Loads a program from a program cache file
+ * @param path The path to the program cache
+ * @param key The key the cache has to have
+ * @param program The program to load the binary into (created with glCreateProgram)
+ * @return EOGLL_SUCCESS if the program was loaded and is linked, EOGLL_FAILURE if not
+ * @see eogllWriteProgramBinary
+ *
+ * Nothing is logged when the cache doesn't exist. A cache the driver refuses is deleted, so it is written again.
+ */
+EOGLL_DECL_FUNC_ND EogllResult eogllLoadProgramBinary(const char* path, uint64_t key, GLuint program);
+
+/**
+ * @brief Writes a linked program to a program cache file
+ * @param path The path to write the program cache to
+ * @param key The key of the program
+ * @param program The linked program (linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set)
+ * @return EOGLL_SUCCESS if successful, EOGLL_FAILURE if not
+ * @see eogllLoadProgramBinary
+ *
+ * The file is written next to path first and then moved over it, so a reader never sees a half written cache.
+ */
+EOGLL_DECL_FUNC_ND EogllResult eogllWriteProgramBinary(const char* path, uint64_t key, GLuint program);
+
+/**
+ * @brief Marks a program that is about to be linked so its binary can be retrieved
+ * @param program The program
+ *
+ * Does nothing if program binaries aren't supported.
+ */
+EOGLL_DECL_FUNC void eogllPrepareProgramBinary(GLuint program);
+
+/**
+ * @brief Gets the counters of the program cache
+ * @return The counters
+ */
+EOGLL_DECL_FUNC_ND EogllProgramCacheStats eogllGetProgramCacheStats();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //_EOGLL_PROGRAM_CACHE_H_
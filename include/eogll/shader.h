@@ -16,6 +16,61 @@
 extern "C" {
 #endif
 
+/**
+ * @brief A uniform in a uniform table
+ * @see EogllUniformTable
+ */
+typedef EOGLL_DECL_STRUCT struct EogllUniform {
+    /// The hash of the name (see eogllHashUniformName)
+    uint32_t hash;
+    /// The location of the uniform, -1 for names the program doesn't have
+    GLint location;
+    /// The offset of the name in the table's names plus one, 0 for an empty slot
+    uint32_t name;
+    /// The offset of the last value written to the uniform in the table's values (if shadowing is enabled)
+    uint32_t value;
+    /// The size of that value in bytes, 0 if nothing was written yet
+    uint32_t valueSize;
+    /// The number of bytes at value that belong to the uniform, later values that fit are written there
+    uint32_t valueCapacity;
+    /// Whether the uniform is an array or an element of one, those aren't shadowed (the same values have several names)
+    bool array;
+} EogllUniform;
+
+/**
+ * @brief The uniform locations of a shader program, looked up by name without asking the driver
+ * @see eogllGetUniformLocation
+ *
+ * The active uniforms are added when the program is linked (arrays under both "name" and "name[0]").
+ * Any other name is looked up with glGetUniformLocation the first time it is used and added then.
+ * The table is open addressed with linear probing and is never more than half full.
+ */
+typedef EOGLL_DECL_STRUCT struct EogllUniformTable {
+    /// The slots of the table, the number of slots is a power of two
+    EogllUniform* slots;
+    /// The number of slots
+    uint32_t numSlots;
+    /// The number of uniforms in the table
+    uint32_t numUniforms;
+    /// The names of the uniforms, null terminated one after the other
+    char* names;
+    /// The number of bytes used in names
+    uint32_t namesSize;
+    /// The number of bytes allocated for names
+    uint32_t namesCapacity;
+    /// Whether the setters that take a name skip writes of the value the uniform already has (see eogllSetUniformShadowing)
+    bool shadow;
+    /// The last value written to every uniform, one after the other
+    unsigned char* values;
+    /// The number of bytes used in values
+    uint32_t valuesSize;
+    /// The number of bytes allocated for values
+    uint32_t valuesCapacity;
+    /// The number of writes the setters that take a name sent to the driver
+    uint64_t issuedWrites;
+    /// The number of writes the setters that take a name skipped because the uniform already had the value
+    uint64_t skippedWrites;
+} EogllUniformTable;
 
 /**
  * @brief A struct that represents a shader program
@@ -33,6 +88,10 @@ typedef EOGLL_DECL_STRUCT struct EogllShaderProgram {
     int fragmentStatus;
     int programStatus;
     bool successful;
+    /// Whether the program was loaded from the program cache instead of compiled (see eogllSetProgramCacheDirectory)
+    bool cached;
+    /// The locations of the uniforms, used by every eogllSetUniform function that takes a name
+    EogllUniformTable uniforms;
 } EogllShaderProgram;
 
 /**
@@ -46,6 +105,8 @@ typedef EOGLL_DECL_STRUCT struct EogllShaderProgram {
  * @see EogllShaderProgram
  *
  * This function links a shader program with the given vertex and fragment shader sources.
+ * If a program cache directory is set (see eogllSetProgramCacheDirectory), the program is loaded from its cache
+ * when there is one, and its cache is written after it is compiled when there isn't.
  */
 EOGLL_DECL_FUNC_ND EogllShaderProgram* eogllLinkProgram(const char* vertexShaderSource, const char* fragmentShaderSource);
 
@@ -90,6 +151,63 @@ EOGLL_DECL_FUNC void eogllDeleteProgram(EogllShaderProgram* shader);
  */
 EOGLL_DECL_FUNC void eogllUseProgram(EogllShaderProgram* shader);
 
+/**
+ * @brief Hashes the name of a uniform
+ * @param name The name of the uniform
+ * @return The hash of the name
+ * @see eogllGetUniformLocationHashed
+ *
+ * The hash of a name that is used every frame can be computed once and passed to eogllGetUniformLocationHashed.
+ */
+EOGLL_DECL_FUNC_ND uint32_t eogllHashUniformName(const char* name);
+
+/**
+ * @brief Gets the location of a uniform
+ * @param shader The shader program
+ * @param name The name of the uniform
+ * @return The location of the uniform, -1 if the program doesn't use it
+ * @see eogllGetUniformLocationHashed
+ * @see EogllUniformTable
+ *
+ * This function looks the name up in the shader's uniform table, so it only calls glGetUniformLocation the first time a name that isn't an active uniform is used.
+ */
+EOGLL_DECL_FUNC_ND GLint eogllGetUniformLocation(EogllShaderProgram* shader, const char* name);
+
+/**
+ * @brief Gets the location of a uniform with a hash that was already computed
+ * @param shader The shader program
+ * @param name The name of the uniform
+ * @param hash The hash of the name (from eogllHashUniformName)
+ * @return The location of the uniform, -1 if the program doesn't use it
+ * @see eogllGetUniformLocation
+ */
+EOGLL_DECL_FUNC_ND GLint eogllGetUniformLocationHashed(EogllShaderProgram* shader, const char* name, uint32_t hash);
+
+/**
+ * @brief Enables or disables shadowing of uniform values
+ * @param shader The shader program
+ * @param enabled Whether to shadow the uniform values
+ * @see eogllInvalidateUniformShadow
+ * @see EogllUniformTable
+ *
+ * With shadowing, the setters that take a name keep a copy of the last value written to every uniform
+ * and skip glUniform calls that would write the same value again (counted in skippedWrites).
+ * Writes that don't go through those setters (the location setters, glUniform) aren't seen,
+ * so call eogllInvalidateUniformShadow after them.
+ * Arrays are never shadowed, their elements can be written under several names ("lights", "lights[0]", "lights[2]").
+ * Shadowing is disabled by default. Changing it invalidates the shadow.
+ */
+EOGLL_DECL_FUNC void eogllSetUniformShadowing(EogllShaderProgram* shader, bool enabled);
+
+/**
+ * @brief Forgets the shadowed uniform values
+ * @param shader The shader program
+ * @see eogllSetUniformShadowing
+ *
+ * The next write to every uniform is sent to the driver.
+ */
+EOGLL_DECL_FUNC void eogllInvalidateUniformShadow(EogllShaderProgram* shader);
+
 /**
  * @brief Sets a uniform matrix 4x4
  * @param shader The shader program to set the uniform for
@@ -246,6 +364,162 @@ EOGLL_DECL_FUNC void eogllSetUniform3fl(EogllShaderProgram* shader, const char*
  */
 EOGLL_DECL_FUNC void eogllSetUniform4fl(EogllShaderProgram* shader, const char* name, vec4* vectors, GLsizei count);
 
+/**
+ * @brief Sets a uniform matrix 4x4 by location
+ * @param location The location of the uniform in the program that is in use (from eogllGetUniformLocation)
+ * @param matrix The matrix to set the uniform to
+ * @see eogllSetUniformMatrix4fv
+ */
+EOGLL_DECL_FUNC void eogllSetUniformMatrix4fvLocation(GLint location, mat4 matrix);
+
+/**
+ * @brief Sets a uniform matrix 3x3 by location
+ * @param location The location of the uniform in the program that is in use (from eogllGetUniformLocation)
+ * @param matrix The matrix to set the uniform to
+ * @see eogllSetUniformMatrix3fv
+ */
+EOGLL_DECL_FUNC void eogllSetUniformMatrix3fvLocation(GLint location, mat3 matrix);
+
+/**
+ * @brief Sets a uniform matrix 2x2 by location
+ * @param location The location of the uniform in the program that is in use (from eogllGetUniformLocation)
+ * @param matrix The matrix to set the uniform to
+ * @see eogllSetUniformMatrix2fv
+ */
+EOGLL_DECL_FUNC void eogllSetUniformMatrix2fvLocation(GLint location, mat2 matrix);
+
+/**
+ * @brief Sets a uniform vec4 (given 4 floats) by location
+ * @param location The location of the uniform in the program that is in use (from eogllGetUniformLocation)
+ * @param x The x component of the vector
+ * @param y The y component of the vector
+ * @param z The z component of the vector
+ * @param w The w component of the vector
+ * @see eogllSetUniform4f
+ */
+EOGLL_DECL_FUNC void eogllSetUniform4fLocation(GLint location, float x, float y, float z, float w);
+
+/**
+ * @brief Sets a uniform vec4 (given a vec4) by location
+ * @param location The location of the uniform in the program that is in use (from eogllGetUniformLocation)
+ * @param vector The vector to set the uniform to
+ * @see eogllSetUniform4fv
+ */
+EOGLL_DECL_FUNC void eogllSetUniform4fvLocation(GLint location, vec4 vector);
+
+/**
+ * @brief Sets a uniform vec3 (given 3 floats) by location
+ * @param location The location of the uniform in the program that is in use (from eogllGetUniformLocation)
+ * @param x The x component of the vector
+ * @param y The y component of the vector
+ * @param z The z component of the vector
+ * @see eogllSetUniform3f
+ */
+EOGLL_DECL_FUNC void eogllSetUniform3fLocation(GLint location, float x, float y, float z);
+
+/**
+ * @brief Sets a uniform vec3 (given a vec3) by location
+ * @param location The location of the uniform in the program that is in use (from eogllGetUniformLocation)
+ * @param vector The vector to set the uniform to
+ * @see eogllSetUniform3fv
+ */
+EOGLL_DECL_FUNC void eogllSetUniform3fvLocation(GLint location, vec3 vector);
+
+/**
+ * @brief Sets a uniform vec2 (given 2 floats) by location
+ * @param location The location of the uniform in the program that is in use (from eogllGetUniformLocation)
+ * @param x The x component of the vector
+ * @param y The y component of the vector
+ * @see eogllSetUniform2f
+ */
+EOGLL_DECL_FUNC void eogllSetUniform2fLocation(GLint location, float x, float y);
+
+/**
+ * @brief Sets a uniform vec2 (given a vec2) by location
+ * @param location The location of the uniform in the program that is in use (from eogllGetUniformLocation)
+ * @param vector The vector to set the uniform to
+ * @see eogllSetUniform2fv
+ */
+EOGLL_DECL_FUNC void eogllSetUniform2fvLocation(GLint location, vec2 vector);
+
+/**
+ * @brief Sets a uniform float by location
+ * @param location The location of the uniform in the program that is in use (from eogllGetUniformLocation)
+ * @param x The float to set the uniform to
+ * @see eogllSetUniform1f
+ */
+EOGLL_DECL_FUNC void eogllSetUniform1fLocation(GLint location, float x);
+
+/**
+ * @brief Sets a uniform float array by location
+ * @param location The location of the uniform in the program that is in use (from eogllGetUniformLocation)
+ * @param vector The array to set the uniform to
+ * @param count The number of elements in the array
+ * @see eogllSetUniform1fv
+ */
+EOGLL_DECL_FUNC void eogllSetUniform1fvLocation(GLint location, float* vector, GLsizei count);
+
+/**
+ * @brief Sets a uniform int by location
+ * @param location The location of the uniform in the program that is in use (from eogllGetUniformLocation)
+ * @param x The int to set the uniform to
+ * @see eogllSetUniform1i
+ */
+EOGLL_DECL_FUNC void eogllSetUniform1iLocation(GLint location, int x);
+
+/**
+ * @brief Sets a uniform int array by location
+ * @param location The location of the uniform in the program that is in use (from eogllGetUniformLocation)
+ * @param vector The array to set the uniform to
+ * @param count The number of elements in the array
+ * @see eogllSetUniform1iv
+ */
+EOGLL_DECL_FUNC void eogllSetUniform1ivLocation(GLint location, int* vector, GLsizei count);
+
+/**
+ * @brief Sets a uniform unsigned int by location
+ * @param location The location of the uniform in the program that is in use (from eogllGetUniformLocation)
+ * @param x The unsigned int to set the uniform to
+ * @see eogllSetUniform1ui
+ */
+EOGLL_DECL_FUNC void eogllSetUniform1uiLocation(GLint location, unsigned int x);
+
+/**
+ * @brief Sets a uniform unsigned int array by location
+ * @param location The location of the uniform in the program that is in use (from eogllGetUniformLocation)
+ * @param vector The array to set the uniform to
+ * @param count The number of elements in the array
+ * @see eogllSetUniform1uiv
+ */
+EOGLL_DECL_FUNC void eogllSetUniform1uivLocation(GLint location, unsigned int* vector, GLsizei count);
+
+/**
+ * @brief Sets a uniform list of vec2 by location
+ * @param location The location of the uniform in the program that is in use (from eogllGetUniformLocation)
+ * @param vectors The list of vectors to set the uniform to
+ * @param count The number of elements in the list
+ * @see eogllSetUniform2fl
+ */
+EOGLL_DECL_FUNC void eogllSetUniform2flLocation(GLint location, vec2* vectors, GLsizei count);
+
+/**
+ * @brief Sets a uniform list of vec3 by location
+ * @param location The location of the uniform in the program that is in use (from eogllGetUniformLocation)
+ * @param vectors The list of vectors to set the uniform to
+ * @param count The number of elements in the list
+ * @see eogllSetUniform3fl
+ */
+EOGLL_DECL_FUNC void eogllSetUniform3flLocation(GLint location, vec3* vectors, GLsizei count);
+
+/**
+ * @brief Sets a uniform list of vec4 by location
+ * @param location The location of the uniform in the program that is in use (from eogllGetUniformLocation)
+ * @param vectors The list of vectors to set the uniform to
+ * @param count The number of elements in the list
+ * @see eogllSetUniform4fl
+ */
+EOGLL_DECL_FUNC void eogllSetUniform4flLocation(GLint location, vec4* vectors, GLsizei count);
+
 #ifdef __cplusplus
 }
 #endif
@@ -77,6 +77,69 @@ EOGLL_DECL_FUNC_ND EogllTexture* eogllCreateTexture(const char* path);
  */
 EOGLL_DECL_FUNC_ND EogllTexture* eogllCreateTextureFromBuffer(const uint8_t* buffer, size_t size);
 
+/**
+ * @brief An image that is decoded but not uploaded yet
+ * @see eogllDecodeImage
+ * @see eogllCreateTextureFromImage
+ * @see eogllFreeImage
+ *
+ * Decoding doesn't need an OpenGL context, so images can be decoded on any thread
+ * and then uploaded on the thread that has the context.
+ */
+typedef EOGLL_DECL_STRUCT struct EogllImage {
+    /// The pixels (flipped vertically, like eogllCreateTexture), NULL if decoding failed
+    unsigned char* data;
+
+    /// The width of the image
+    int width;
+
+    /// The height of the image
+    int height;
+
+    /// The number of channels in the image
+    int channels;
+} EogllImage;
+
+/**
+ * @brief Decodes an image file without uploading it
+ * @param path The path to the image
+ * @param image The decoded image
+ * @return EOGLL_SUCCESS if successful, EOGLL_FAILURE if not
+ * @see eogllCreateTextureFromImage
+ *
+ * This function is thread safe and doesn't use OpenGL.
+ */
+EOGLL_DECL_FUNC_ND EogllResult eogllDecodeImage(const char* path, EogllImage* image);
+
+/**
+ * @brief Decodes an image from a buffer without uploading it
+ * @param buffer The encoded image
+ * @param size The length of the buffer
+ * @param image The decoded image
+ * @return EOGLL_SUCCESS if successful, EOGLL_FAILURE if not
+ * @see eogllDecodeImage
+ *
+ * This function is thread safe and doesn't use OpenGL.
+ */
+EOGLL_DECL_FUNC_ND EogllResult eogllDecodeImageFromBuffer(const uint8_t* buffer, size_t size, EogllImage* image);
+
+/**
+ * @brief Creates a texture from a decoded image
+ * @param image The image to upload (it is not freed)
+ * @return The created texture, NULL if the image couldn't be uploaded
+ * @see eogllDecodeImage
+ * @see eogllFreeImage
+ *
+ * This has to be called on the thread with the OpenGL context.
+ */
+EOGLL_DECL_FUNC_ND EogllTexture* eogllCreateTextureFromImage(const EogllImage* image);
+
+/**
+ * @brief Frees the pixels of a decoded image
+ * @param image The image to free
+ */
+EOGLL_DECL_FUNC void eogllFreeImage(EogllImage* image);
+
 /**
  * @brief Binds a texture
  * @param texture The texture to bind
@@ -132,6 +195,19 @@ EOGLL_DECL_FUNC void eogllBindTextureUniform(EogllTexture* texture, EogllShaderP
  */
 EOGLL_DECL_FUNC void eogllBindTextureUniformi(GLuint texture, EogllShaderProgram* shader, const char* name, unsigned int index);
 
+/**
+ * @brief Binds a texture to a specific texture unit and a uniform that was already looked up
+ * @param texture The texture to bind
+ * @param location The location of the uniform in the program that is in use (from eogllGetUniformLocation)
+ * @param index The index of the texture unit
+ * @see eogllBindTextureUniform
+ *
+ * This function does what eogllBindTextureUniform does, without looking up the uniform by name.
+ * Nothing is bound if the location is -1 (the program doesn't use the uniform).
+ * This function does check if the texture unit is valid (below GL_MAX_TEXTURE_IMAGE_UNITS value).
+ */
+EOGLL_DECL_FUNC void eogllBindTextureLocation(EogllTexture* texture, GLint location, unsigned int index);
+
 /**
  * @brief Starts creation of a texture
  * @return A partially initialized texture
@@ -12,6 +12,7 @@
 
 #include "pch.h"
 #include "shader.h"
+#include "uniform_buffer.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -97,6 +98,19 @@ EOGLL_DECL_FUNC_ND EogllProjection eogllOrthographicProjection(float near, float
  */
 EOGLL_DECL_FUNC void eogllUpdateProjectionMatrix(EogllProjection* projection, EogllShaderProgram* shader, const char* name, uint32_t width, uint32_t height);
 
+/**
+ * @brief Updates a projection matrix in the per-frame uniform block
+ * @param projection The projection matrix to update
+ * @param frame The frame uniform buffer to write it to
+ * @param width The width of the window
+ * @param height The height of the window
+ * @see eogllUploadFrameUniforms
+ *
+ * Like eogllUpdateProjectionMatrix, but every program that declares the EogllFrame block sees the new matrix
+ * after the next eogllUploadFrameUniforms.
+ */
+EOGLL_DECL_FUNC void eogllUpdateProjectionUniforms(EogllProjection* projection, EogllFrameUniformBuffer* frame, uint32_t width, uint32_t height);
+
 /**
  * @brief Updates a projection matrix with top, bottom, left, right
  * @param projection The projection matrix to update
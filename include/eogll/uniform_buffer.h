@@ -0,0 +1,201 @@
+/**
+ * @file uniform_buffer.h
+ * @brief EOGLL uniform buffer header file
+ * @date 2024-10-23
+ *
+ * EOGLL uniform buffer header file
+ *
+ * Helpers for writing std140 uniform blocks, and the per-frame block every program can share.
+ */
+
+#pragma once
+#ifndef _EOGLL_UNIFORM_BUFFER_H_
+#define _EOGLL_UNIFORM_BUFFER_H_
+
+#include "pch.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// The name of the per-frame uniform block, programs that declare it are bound to it when they are linked
+#define EOGLL_FRAME_UNIFORMS_BLOCK "EogllFrame"
+
+#ifndef EOGLL_FRAME_UNIFORMS_BINDING
+/// The uniform buffer binding point of the per-frame block (ogl::BonePaletteBuffer uses 0 by default)
+#define EOGLL_FRAME_UNIFORMS_BINDING 1
+#endif
+
+/**
+ * @brief Rounds an offset up to an alignment
+ * @param offset The offset in bytes
+ * @param alignment The alignment in bytes (a power of two)
+ * @return The aligned offset
+ */
+EOGLL_DECL_FUNC_ND size_t eogllStd140Align(size_t offset, size_t alignment);
+
+/**
+ * @brief Writes a float member of a std140 block
+ * @param buffer The block (NULL to only compute the layout)
+ * @param offset The offset after the previous member
+ * @param value The value
+ * @return The offset after this member
+ * @see eogllStd140Align
+ *
+ * Every eogllStd140 writer aligns the offset for its type first, so a block is written by passing the returned offset to the next one.
+ */
+EOGLL_DECL_FUNC size_t eogllStd140Float(void* buffer, size_t offset, float value);
+
+/**
+ * @brief Writes an int member of a std140 block
+ * @param buffer The block (NULL to only compute the layout)
+ * @param offset The offset after the previous member
+ * @param value The value
+ * @return The offset after this member
+ */
+EOGLL_DECL_FUNC size_t eogllStd140Int(void* buffer, size_t offset, int value);
+
+/**
+ * @brief Writes a vec2 member of a std140 block (aligned to 8 bytes)
+ * @param buffer The block (NULL to only compute the layout)
+ * @param offset The offset after the previous member
+ * @param value The value
+ * @return The offset after this member
+ */
+EOGLL_DECL_FUNC size_t eogllStd140Vec2(void* buffer, size_t offset, vec2 value);
+
+/**
+ * @brief Writes a vec3 member of a std140 block (aligned to 16 bytes)
+ * @param buffer The block (NULL to only compute the layout)
+ * @param offset The offset after the previous member
+ * @param value The value
+ * @return The offset after this member (a float can follow in the same 16 bytes)
+ */
+EOGLL_DECL_FUNC size_t eogllStd140Vec3(void* buffer, size_t offset, vec3 value);
+
+/**
+ * @brief Writes a vec4 member of a std140 block (aligned to 16 bytes)
+ * @param buffer The block (NULL to only compute the layout)
+ * @param offset The offset after the previous member
+ * @param value The value
+ * @return The offset after this member
+ */
+EOGLL_DECL_FUNC size_t eogllStd140Vec4(void* buffer, size_t offset, vec4 value);
+
+/**
+ * @brief Writes a mat3 member of a std140 block (3 columns, each padded to a vec4)
+ * @param buffer The block (NULL to only compute the layout)
+ * @param offset The offset after the previous member
+ * @param value The value
+ * @return The offset after this member
+ */
+EOGLL_DECL_FUNC size_t eogllStd140Mat3(void* buffer, size_t offset, mat3 value);
+
+/**
+ * @brief Writes a mat4 member of a std140 block
+ * @param buffer The block (NULL to only compute the layout)
+ * @param offset The offset after the previous member
+ * @param value The value
+ * @return The offset after this member
+ */
+EOGLL_DECL_FUNC size_t eogllStd140Mat4(void* buffer, size_t offset, mat4 value);
+
+/**
+ * @brief The values of the per-frame uniform block
+ * @see EogllFrameUniformBuffer
+ *
+ * Shaders declare it as:
+ * @code{.glsl}
+ * layout (std140) uniform EogllFrame {
+ *     mat4 view;
+ *     mat4 projection;
+ *     vec3 viewPos;
+ *     float time;
+ * };
+ * @endcode
+ */
+typedef EOGLL_DECL_STRUCT struct EogllFrameUniforms {
+    /// The view matrix
+    mat4 view;
+    /// The projection matrix
+    mat4 projection;
+    /// The position of the camera
+    vec3 viewPos;
+    /// The time in seconds
+    float time;
+} EogllFrameUniforms;
+
+/**
+ * @brief A uniform buffer holding the per-frame block, shared by every program that declares it
+ * @see eogllCreateFrameUniformBuffer
+ * @see eogllUploadFrameUniforms
+ *
+ * The values are set during the frame and sent to the GPU once with eogllUploadFrameUniforms,
+ * instead of setting the same view and projection in every program.
+ */
+typedef EOGLL_DECL_STRUCT struct EogllFrameUniformBuffer {
+    /// The uniform buffer object
+    GLuint ubo;
+    /// The binding point the buffer is bound to
+    GLuint binding;
+    /// The values that will be uploaded
+    EogllFrameUniforms values;
+    /// Whether the values changed since the last upload
+    bool dirty;
+    /// The number of uploads that were sent to the GPU
+    uint64_t uploads;
+} EogllFrameUniformBuffer;
+
+/**
+ * @brief Creates the per-frame uniform buffer
+ * @return The buffer, bound to EOGLL_FRAME_UNIFORMS_BINDING
+ * @see eogllDeleteFrameUniformBuffer
+ *
+ * The view and projection start as identity matrices.
+ */
+EOGLL_DECL_FUNC_ND EogllFrameUniformBuffer* eogllCreateFrameUniformBuffer();
+
+/**
+ * @brief Sets the view matrix and camera position of the frame
+ * @param buffer The frame uniform buffer
+ * @param view The view matrix
+ * @param viewPos The position of the camera
+ * @see eogllUpdateCameraUniforms
+ */
+EOGLL_DECL_FUNC void eogllSetFrameView(EogllFrameUniformBuffer* buffer, mat4 view, vec3 viewPos);
+
+/**
+ * @brief Sets the projection matrix of the frame
+ * @param buffer The frame uniform buffer
+ * @param projection The projection matrix
+ * @see eogllUpdateProjectionUniforms
+ */
+EOGLL_DECL_FUNC void eogllSetFrameProjection(EogllFrameUniformBuffer* buffer, mat4 projection);
+
+/**
+ * @brief Sets the time of the frame
+ * @param buffer The frame uniform buffer
+ * @param time The time in seconds
+ */
+EOGLL_DECL_FUNC void eogllSetFrameTime(EogllFrameUniformBuffer* buffer, float time);
+
+/**
+ * @brief Sends the values of the frame to the GPU
+ * @param buffer The frame uniform buffer
+ *
+ * Call this once per frame, before drawing. Nothing is uploaded if no value changed,
+ * the buffer is bound to its binding point either way.
+ */
+EOGLL_DECL_FUNC void eogllUploadFrameUniforms(EogllFrameUniformBuffer* buffer);
+
+/**
+ * @brief Deletes the per-frame uniform buffer
+ * @param buffer The frame uniform buffer
+ */
+EOGLL_DECL_FUNC void eogllDeleteFrameUniformBuffer(EogllFrameUniformBuffer* buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //_EOGLL_UNIFORM_BUFFER_H_
@@ -24,6 +24,82 @@ extern "C" {
  */
 EOGLL_DECL_FUNC_ND char* eogllReadFile(const char* path);
 
+/**
+ * @brief A read-only view of a whole file in memory
+ * @see eogllMapFile
+ * @see eogllUnmapFile
+ *
+ * On platforms that support it the file is memory mapped, otherwise it is read into a heap buffer.
+ * The data is NOT null terminated, always use size.
+ */
+typedef EOGLL_DECL_STRUCT struct EogllMappedFile {
+    /// The contents of the file (NULL if the file is empty)
+    const char* data;
+    /// The size of the file in bytes
+    size_t size;
+    /// Platform specific handle (used internally)
+    void* handle;
+    /// Whether or not data is a heap buffer instead of a mapping (used internally)
+    bool heap;
+} EogllMappedFile;
+
+/**
+ * @brief Maps a file into memory for reading
+ * @param path The path to the file
+ * @param file The mapped file to fill in
+ * @return EOGLL_SUCCESS if successful, EOGLL_FAILURE if not
+ * @see eogllUnmapFile
+ * @note This function is used internally, but isn't meant to be used by the user
+ *
+ * This is used by the object loader to avoid copying large files through stdio.
+ */
+EOGLL_DECL_FUNC_ND EogllResult eogllMapFile(const char* path, EogllMappedFile* file);
+
+/**
+ * @brief Unmaps a file mapped with eogllMapFile
+ * @param file The mapped file
+ * @see eogllMapFile
+ */
+EOGLL_DECL_FUNC void eogllUnmapFile(EogllMappedFile* file);
+
+/**
+ * @brief Tells the system that a part of a mapped file won't be read again soon
+ * @param file The mapped file
+ * @param offset The start of the part in bytes
+ * @param size The size of the part in bytes
+ * @see eogllMapFile
+ *
+ * The pages are dropped from memory (they are read from the file again if they are touched).
+ * This keeps a sequential pass over a huge file from growing the resident memory to the size of the file.
+ * Does nothing if the file isn't mapped.
+ */
+EOGLL_DECL_FUNC void eogllReleaseMappedRange(EogllMappedFile* file, size_t offset, size_t size);
+
+/**
+ * @brief Gets the modification time and size of a file
+ * @param path The path to the file
+ * @param modifiedTime The modification time (in a platform specific unit, only useful for comparing)
+ * @param size The size of the file in bytes
+ * @return EOGLL_SUCCESS if successful, EOGLL_FAILURE if the file doesn't exist
+ * @note This function is used internally, but isn't meant to be used by the user
+ *
+ * Nothing is logged when the file doesn't exist, so this can be used to check if a file exists.
+ */
+EOGLL_DECL_FUNC_ND EogllResult eogllGetFileInfo(const char* path, uint64_t* modifiedTime, uint64_t* size);
+
+/**
+ * @brief Resolves a path that is relative to the directory of another file
+ * @param base The path of the file the relative path is relative to
+ * @param relative The relative path (absolute paths are copied as is)
+ * @param out The buffer to write the result to
+ * @param size The size of out in bytes
+ * @return EOGLL_SUCCESS if successful, EOGLL_FAILURE if the result doesn't fit in out
+ * @note This function is used internally, but isn't meant to be used by the user
+ *
+ * This is used to find files that are referenced by other files, like the material libraries of an object file.
+ */
+EOGLL_DECL_FUNC_ND EogllResult eogllResolveRelativePath(const char* base, const char* relative, char* out, size_t size);
+
 /**
  * @brief Gets the current time
  * @return The current time
@@ -34,6 +110,22 @@ EOGLL_DECL_FUNC_ND char* eogllReadFile(const char* path);
  */
 EOGLL_DECL_FUNC_ND double eogllGetTime();
 
+/**
+ * @brief Gets the number of processors
+ * @return The number of logical processors available (at least 1)
+ *
+ * This is used to pick a default number of threads for loading.
+ */
+EOGLL_DECL_FUNC_ND unsigned int eogllGetProcessorCount();
+
+/**
+ * @brief Gets the peak resident memory of the process
+ * @return The largest amount of physical memory the process has used so far in bytes (0 if it is unknown)
+ *
+ * This is used by the loaders' debug output.
+ */
+EOGLL_DECL_FUNC_ND size_t eogllGetPeakMemoryUsage();
+
 /**
  * @brief Gets the size of a GL type
  * @param type The type to get the size of
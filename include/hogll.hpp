@@ -8,6 +8,9 @@
 #include "hogll/objectattrs.hpp"
 #include "hogll/transforms.hpp"
 #include "hogll/shadergen.hpp"
+#include "hogll/texturecache.hpp"
+#include "hogll/animation.hpp"
+#include "hogll/scenegraph.hpp"
 #include "hogll/model.hpp"
 
 #endif
\ No newline at end of file
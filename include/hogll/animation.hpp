@@ -0,0 +1,197 @@
+/**
+ * @file animation.hpp
+ * @brief HOGLL skeletal animation header file
+ * @date 2024-10-21
+ *
+ * HOGLL skeletal animation
+ *
+ * A model's node hierarchy is flattened once, its animations are sampled into a Pose per instance
+ * and the bone palettes of every instance go to the GPU in one uniform buffer per frame.
+ */
+
+#pragma once
+#ifndef _HOGLL_ANIMATION_HPP_
+#define _HOGLL_ANIMATION_HPP_
+
+#include "pch.hpp"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define HOGLL_SSE
+#endif
+
+namespace ogl {
+    // the number of bones in the palette the shaders declare (BonePalette in resources/shaders/model.vert)
+    constexpr int MAX_BONES = 100;
+
+    // assimp matrices are row major, glm ones are column major
+    inline glm::mat4 convertToGLM(const aiMatrix4x4& mat) {
+        glm::mat4 result;
+        result[0][0] = mat.a1; result[1][0] = mat.a2; result[2][0] = mat.a3; result[3][0] = mat.a4;
+        result[0][1] = mat.b1; result[1][1] = mat.b2; result[2][1] = mat.b3; result[3][1] = mat.b4;
+        result[0][2] = mat.c1; result[1][2] = mat.c2; result[2][2] = mat.c3; result[3][2] = mat.c4;
+        result[0][3] = mat.d1; result[1][3] = mat.d2; result[2][3] = mat.d3; result[3][3] = mat.d4;
+        return result;
+    }
+
+    namespace internal {
+        // out = a * b, out can be a or b
+        inline void multiply(const glm::mat4& a, const glm::mat4& b, glm::mat4& out) {
+#ifdef HOGLL_SSE
+            // every column of the result is a sum of the columns of a, weighted by a column of b
+            __m128 a0 = _mm_loadu_ps(&a[0][0]);
+            __m128 a1 = _mm_loadu_ps(&a[1][0]);
+            __m128 a2 = _mm_loadu_ps(&a[2][0]);
+            __m128 a3 = _mm_loadu_ps(&a[3][0]);
+            for (int i = 0; i < 4; i++) {
+                const float* column = &b[i][0];
+                __m128 r = _mm_mul_ps(a0, _mm_set1_ps(column[0]));
+                r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(column[1])));
+                r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(column[2])));
+                r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(column[3])));
+                _mm_storeu_ps(&out[i][0], r);
+            }
+#else
+            out = a * b;
+#endif
+        }
+    }
+
+    // the bones of a model as flat arrays, a bone's id is its index in them (and in the bone palette)
+    // the names are only looked up while loading, animation and skinning walk the arrays
+    struct Skeleton {
+        std::vector<std::string> names;
+        // from mesh space to the space of the bone
+        std::vector<glm::mat4> offsets;
+        // the closest ancestor that is a bone, -1 if there is none (filled by NodeHierarchy)
+        std::vector<int> parents;
+        // the node that moves the bone, -1 if it isn't in the hierarchy (filled by NodeHierarchy)
+        std::vector<int> nodes;
+
+        // adds a bone if there isn't one with that name yet, returns its id
+        int add(const std::string& name, const glm::mat4& offset);
+
+        // the id of a bone, -1 if there is no bone with that name (or loading is finished)
+        EOGLL_NO_DISCARD int find(const std::string& name) const;
+
+        // frees the name index once nothing needs to look bones up by name
+        void finishLoading();
+
+        EOGLL_NO_DISCARD size_t size() const { return offsets.size(); }
+
+    private:
+        std::unordered_map<std::string, int> index;
+    };
+
+    // the nodes of a model, flattened so every parent comes before its children
+    // so the global transforms can be computed in one pass over the arrays
+    struct NodeHierarchy {
+        std::vector<std::string> names;
+        // the index of the parent, -1 for the root
+        std::vector<int> parents;
+        // the local transform of every node in the bind pose
+        std::vector<glm::mat4> transforms;
+        // the bone of every node (its index in the skeleton), -1 for nodes that aren't bones
+        std::vector<int> bones;
+        // the inverse of the root's transform, so poses are in the model's space
+        glm::mat4 globalInverse = glm::mat4(1.0f);
+
+        NodeHierarchy() = default;
+        // also fills the parents and nodes of the skeleton, which has to have every bone already
+        NodeHierarchy(const aiScene* scene, Skeleton& skeleton);
+
+        EOGLL_NO_DISCARD size_t size() const { return parents.size(); }
+    };
+
+    // the keys of one node in an animation, times are in ticks
+    struct AnimationChannel {
+        int node;
+        std::vector<float> positionTimes;
+        std::vector<glm::vec3> positions;
+        std::vector<float> rotationTimes;
+        std::vector<glm::quat> rotations;
+        std::vector<float> scaleTimes;
+        std::vector<glm::vec3> scales;
+    };
+
+    struct Animation {
+        std::string name;
+        // the length of the animation in ticks
+        float duration;
+        float ticksPerSecond;
+        std::vector<AnimationChannel> channels;
+        // the channel of every node of the hierarchy, -1 for nodes the animation doesn't move
+        std::vector<int> nodeChannels;
+
+        Animation(const aiAnimation* animation, const NodeHierarchy& hierarchy);
+    };
+
+    // the playback state of one animated instance
+    struct AnimationState {
+        const Animation* animation = nullptr;
+        // in ticks
+        float time = 0.0f;
+        bool loop = true;
+        // the last key used by each track (position, rotation and scale) of every channel
+        // time usually moves forward by less than a key, so the next key is found without searching
+        std::vector<uint32_t> keys;
+
+        AnimationState() = default;
+        AnimationState(const Animation* animation, bool loop = true);
+
+        // starts an animation from the beginning (nullptr for the bind pose)
+        void play(const Animation* animation, bool loop = true);
+
+        // advances the time by dt seconds
+        void update(float dt);
+    };
+
+    // the pose of one instance, the buffers are kept between frames so evaluating doesn't allocate
+    struct Pose {
+        // the transform of every node relative to the model
+        std::vector<glm::mat4> globals;
+        // the matrix of every bone that is sent to the shader (global transform times offset)
+        std::vector<glm::mat4> palette;
+
+        // samples the animation of state at its time and computes the palette
+        void evaluate(const NodeHierarchy& hierarchy, const Skeleton& skeleton, AnimationState& state);
+    };
+
+    // the bone palettes of many instances in one uniform buffer that is written once per frame
+    // every instance gets its own range of the buffer, which is bound right before the instance is drawn
+    // shaders declare: layout(std140) uniform BonePalette { mat4 finalBonesMatrices[MAX_BONES]; };
+    class BonePaletteBuffer {
+    public:
+        BonePaletteBuffer(GLuint binding = 0, size_t maxInstances = 256);
+        ~BonePaletteBuffer();
+
+        BonePaletteBuffer(const BonePaletteBuffer&) = delete;
+        BonePaletteBuffer& operator=(const BonePaletteBuffer&) = delete;
+
+        // points the shader's palette block at this buffer's binding point (once per shader)
+        void bindProgram(EogllShaderProgram* shader, const char* block = "BonePalette");
+
+        // forgets the palettes of the last frame
+        void begin();
+
+        // copies the palette of a pose, returns the slot to bind it with (-1 if the buffer is full)
+        int add(const Pose& pose);
+
+        // sends every palette added since begin to the GPU
+        void upload();
+
+        // makes the palette in slot the one the shader sees
+        void bind(int slot);
+
+    private:
+        GLuint ubo;
+        GLuint binding;
+        // the size of a slot, rounded up to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+        size_t stride;
+        size_t capacity;
+        size_t count = 0;
+        std::vector<unsigned char> staging;
+    };
+}
+
+#endif
@@ -30,6 +30,36 @@ namespace ogl {
 
         EOGLL_NO_DISCARD EogllBufferObject* getBuffer();
     };
+
+    // several meshes in one buffer object, each drawn as a range of its indices (see EogllRangedBufferObject)
+    struct RangedBufferObject {
+    private:
+        EogllRangedBufferObject buffer;
+    public:
+        RangedBufferObject();
+        inline RangedBufferObject(EogllRangedBufferObject ebo) : buffer(ebo) {}
+        ~RangedBufferObject();
+
+        // the buffers are deleted with the object, so it can be moved but not copied
+        RangedBufferObject(const RangedBufferObject&) = delete;
+        RangedBufferObject& operator=(const RangedBufferObject&) = delete;
+        RangedBufferObject(RangedBufferObject&& other) noexcept;
+        RangedBufferObject& operator=(RangedBufferObject&& other) noexcept;
+
+        // setMaterial is called before a range with a different material than the previous one is drawn
+        void draw(GLenum mode, const std::function<void(const EogllDrawRange&)>& setMaterial);
+
+        // draw without going through std::function (see eogllDrawRangedBufferObject)
+        void draw(GLenum mode, EogllDrawRangeFunc setMaterial, void* user);
+
+        // binds the vertex array, so single ranges can be drawn with drawRange
+        void bind();
+
+        // draws one range, bind has to be called first (see eogllDrawRange)
+        void drawRange(GLenum mode, uint32_t index) const;
+
+        EOGLL_NO_DISCARD EogllRangedBufferObject* getBuffer();
+    };
 }
 
 #endif
\ No newline at end of file
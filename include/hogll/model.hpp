@@ -14,21 +14,11 @@
 #include "objectattrs.hpp"
 #include "bufferobj.hpp"
 #include "transforms.hpp"
+#include "texturecache.hpp"
+#include "animation.hpp"
+#include "scenegraph.hpp"
 
 namespace ogl {
-    /**
-     * @brief A struct that represents a bone's info
-     * 
-     * This struct is used to store data on bones. This will eventually be used for skeletal animation.
-     */
-    struct BoneInfo {
-        /// @brief The id of the bone
-        int id;
-
-        /// @brief The offset matrix of the bone
-        glm::mat4 offset;
-    };
-
     /**
      * @brief A struct that represents a model attribute
      * @see ModelAttrs
@@ -78,7 +68,7 @@ namespace ogl {
          * @brief Get the size of the attribute
          * @return The size of the attribute
          */
-        int num();
+        int num() const;
     };
 
     /**
@@ -127,13 +117,13 @@ namespace ogl {
          * 
          * Sums up the number of objects in each attribute.
          */
-        EOGLL_NO_DISCARD int num();
+        EOGLL_NO_DISCARD int num() const;
 
         /**
          * @brief Get the amount of attributes
          * @return Number of attributes
          */
-        EOGLL_NO_DISCARD int size();
+        EOGLL_NO_DISCARD int size() const;
 
         /**
          * @brief Build the model attributes
@@ -141,6 +131,22 @@ namespace ogl {
          */
         void build(int vao);
 
+        /**
+         * @brief Check if the model attributes contain an attribute type
+         * @param attr The attribute type
+         * @return Whether any attribute has that type
+         */
+        EOGLL_NO_DISCARD bool has(ModelAttrType attr) const;
+
+        /**
+         * @brief Get the Assimp post processing flags needed to fill these attributes
+         * @return The aiPostProcessSteps flags
+         *
+         * Normals, texture coordinates and bone weights are only generated when there is an attribute for them,
+         * and nothing is done for data the vertices can't hold (like tangents).
+         */
+        EOGLL_NO_DISCARD unsigned int importFlags() const;
+
         /**
          * @brief Get the model attribute at the specified index
          * @param i The index
@@ -148,6 +154,13 @@ namespace ogl {
          */
         ModelAttr& operator[](int i);
 
+        /**
+         * @brief Get the model attribute at the specified index
+         * @param i The index
+         * @return The model attribute at the specified index
+         */
+        const ModelAttr& operator[](int i) const;
+
     private:
         /**
          * @brief Get the attribute type from the object attribute type
@@ -164,6 +177,36 @@ namespace ogl {
 
 
     namespace internal {
+        // the number of buffers CountingAllocator has allocated (on any thread), see RenderModel::loadAllocations
+        std::atomic<size_t>& allocationCount();
+
+        // std::allocator that counts its allocations, so the model pipeline can check it doesn't copy buffers
+        template <typename T>
+        struct CountingAllocator {
+            using value_type = T;
+
+            CountingAllocator() = default;
+            template <typename U>
+            CountingAllocator(const CountingAllocator<U>&) {}
+
+            T* allocate(size_t n) {
+                allocationCount()++;
+                return std::allocator<T>().allocate(n);
+            }
+
+            void deallocate(T* p, size_t n) {
+                std::allocator<T>().deallocate(p, n);
+            }
+
+            template <typename U>
+            bool operator==(const CountingAllocator<U>&) const { return true; }
+            template <typename U>
+            bool operator!=(const CountingAllocator<U>&) const { return false; }
+        };
+
+        template <typename T>
+        using CountedVector = std::vector<T, CountingAllocator<T>>;
+
         struct Vertex {
             glm::vec3 pos;
             glm::vec3 norm;
@@ -178,54 +221,174 @@ namespace ogl {
             // for example, if you have 2 textures with the type "abc" and 1 texture with the type "def" (in that order)
             // the uniform names will be "sampler_abc1", "sampler_abc2", "sampler_def1"
             std::string path;
+            // the path in the texture cache
+            std::string key;
         };
 
+        // vert and indices are only filled while the model loads, once the mesh is uploaded to the model's buffers they are released
         struct Mesh {
-            std::vector<Vertex> vert;
-            std::vector<unsigned int> indices;
-            std::vector<Texture> textures;
-            BufferObject* render;
+            CountedVector<Vertex> vert;
+            CountedVector<unsigned int> indices;
+            CountedVector<Texture> textures;
+            // skinned meshes are placed by their bones, so they are drawn without the matrix of their node
+            bool skinned = false;
 
             Mesh() {}
         };
 
+        // a sampler uniform of a mesh, looked up in a shader once instead of by name every draw
+        struct SamplerBinding {
+            EogllTexture* texture;
+            GLint location;
+            unsigned int unit;
+        };
+
+        // the sampler uniforms of every mesh of a model in one shader
+        struct ShaderBindings {
+            const EogllShaderProgram* shader;
+            unsigned int program;
+            // the mat4 "node" uniform, set to the world matrix of the node a mesh is drawn for
+            GLint nodeLocation;
+            std::vector<SamplerBinding> samplers;
+            // mesh i uses samplers[firstSampler[i]] up to samplers[firstSampler[i + 1]]
+            std::vector<uint32_t> firstSampler;
+        };
+
         struct GlMesh {
-            std::vector<float> vert; // when we pass an int we will just reinterpret_cast it to float (it is the same size)
-            std::vector<unsigned int> indices;
+            CountedVector<float> vert; // when we pass an int we will just reinterpret_cast it to float (it is the same size)
+            CountedVector<unsigned int> indices;
+        };
+
+        // copies size bytes from offset src of a Vertex to offset dst of a packed vertex
+        struct PackOp {
+            uint32_t src;
+            uint32_t dst;
+            uint32_t size;
         };
 
-        EOGLL_NO_DISCARD GlMesh packMesh(Mesh mesh, ModelAttrs attrs);
+        // ModelAttrs compiled into the copies that pack one vertex, built once per model instead of once per vertex
+        // attributes that are next to each other in both Vertex and the packed vertex are merged into one copy
+        // (so position, normal and texture coordinates together are a single 32 byte copy)
+        struct PackLayout {
+            std::vector<PackOp> ops;
+            // the size of a packed vertex in bytes (the same stride ModelAttrs::build uses)
+            uint32_t stride = 0;
+        };
+
+        EOGLL_NO_DISCARD PackLayout compilePackLayout(const ModelAttrs& attrs);
+
+        // packs count vertices into out (count * layout.stride bytes, which have to be zeroed already)
+        void packVertices(const PackLayout& layout, const Vertex* vertices, size_t count, float* out);
+
+        // meshes with at least this many vertices are packed on multiple threads
+        constexpr size_t PARALLEL_PACK_VERTICES = 1 << 16;
+
+        // interleaves the vertices of the mesh into one buffer, the indices are moved out of the mesh (not copied)
+        // the buffer is in floats, so a layout with a stride that isn't a multiple of 4 bytes can't be packed and gives an empty GlMesh
+        // maxThreads limits the threads it packs on (0 is one per core), callers already running on a pool of threads pass their share
+        EOGLL_NO_DISCARD GlMesh packMesh(Mesh& mesh, const ModelAttrs& attrs, unsigned int maxThreads = 0);
+
+        // packMesh with a layout that is already compiled (so a model compiles it once for all of its meshes)
+        EOGLL_NO_DISCARD GlMesh packMesh(Mesh& mesh, const PackLayout& layout, unsigned int maxThreads = 0);
+
+        // reorders the triangles and vertices of a packed mesh for the GPU (see eogllOptimizeMesh)
+        void optimizeMesh(GlMesh& glMesh, const ModelAttrs& attrs);
     }
 
+    // how long each phase of loading a RenderModel took, in seconds
+    // process, pack, optimize and decode run together on every core, so they are the time summed over the threads
+    struct ModelLoadProfile {
+        // the Assimp post processing flags the file was imported with
+        unsigned int importFlags = 0;
+        // reading the file and Assimp's post processing
+        double import = 0.0;
+        // bone ids, texture lookups, the node tree and animations (on the loading thread)
+        double scene = 0.0;
+        // converting the Assimp meshes to vertices
+        double process = 0.0;
+        // interleaving the vertices for the GPU
+        double pack = 0.0;
+        // reordering for the vertex cache (if the model was loaded with optimize)
+        double optimize = 0.0;
+        // decoding the images of textures that weren't in the cache
+        double decode = 0.0;
+        // the wall time of all of the above that runs in parallel
+        double parallel = 0.0;
+        // creating the textures and filling the buffers
+        double upload = 0.0;
+        double total = 0.0;
+    };
+
     class RenderModel {
     public:
         // we will look for texture in same directory as the model by default
         // but if we change relpath to tex, it will look for textures in the folder tex, relative to the model
         // but if we disabled relative to obj, it will not be relative to the object, but to our working directory
-        RenderModel(std::string path, ModelAttrs attrs, std::string relpath = ".", bool relative_to_obj=true);
+        // optimize reorders every mesh for the vertex cache before it is uploaded (like EogllObjectLoadOptions::optimizeMesh)
+        // importFlags are the aiPostProcessSteps to import with, 0 uses attrs.importFlags()
+        RenderModel(std::string path, ModelAttrs attrs, std::string relpath = ".", bool relative_to_obj=true, bool optimize=false, unsigned int importFlags=0);
         ~RenderModel();
 
+        // every texture is acquired from TextureCache::global() once, so it can be moved but not copied
+        RenderModel(const RenderModel&) = delete;
+        RenderModel& operator=(const RenderModel&) = delete;
+        RenderModel(RenderModel&&) = default;
+
         // instead of taking in the window and shader, this one passes a lambda that is called right before drawing the models, this allows the user to specify custom uniforms and/or other preparations
-        void draw(EogllShaderProgram* shader, std::function<void(EogllShaderProgram*)> preDraw);
+        void draw(EogllShaderProgram* shader, const std::function<void(EogllShaderProgram*)>& preDraw);
 
     private:
 
-        void loadModel(const std::string& p);
+        // loads the meshes (packed into glMeshes) and decodes the images of textures_loaded, without touching OpenGL
+        void loadModel(const std::string& p, bool optimize, unsigned int importFlags, std::vector<internal::GlMesh>& glMeshes, std::vector<EogllImage>& images);
+
+        // fills the vertices (in the mesh's own space) and indices of m, boneIds are the ids assignBones gave the mesh's bones (it can run on any thread)
+        void processMesh(const aiMesh* mesh, const std::vector<int>& boneIds, internal::Mesh& m) const;
+
+        // adds the textures of the material of the mesh to textures, textures that aren't loaded yet have their path added to imagePaths
+        void loadMeshTextures(const aiMesh* mesh, const aiScene* scene, internal::CountedVector<internal::Texture>& textures, std::vector<std::string>& imagePaths);
+
+        // appends the textures of the given type to textures
+        void loadMaterialTextures(aiMaterial* mat, aiTextureType type, const std::string& typeName, internal::CountedVector<internal::Texture>& textures, std::vector<std::string>& imagePaths);
+
+        // the sampler locations of every mesh in the shader, looked up the first time the model is drawn with it
+        const internal::ShaderBindings& bindingsFor(EogllShaderProgram* shader);
+
+        // binds the textures of the range's material
+        static void bindMaterial(const EogllDrawRange* range, const internal::ShaderBindings& bindings);
+
+        // adds the bones of the mesh that aren't in the skeleton yet, boneIds gets the id of every bone of the mesh
+        void assignBones(const aiMesh* mesh, std::vector<int>& boneIds);
 
-        void processNode(aiNode* node, const aiScene* scene);
+        // writes the ids and weights of the mesh's bones into its vertices
+        static void extractBones(internal::CountedVector<internal::Vertex>& vertices, const aiMesh* mesh, const std::vector<int>& boneIds);
 
-        EOGLL_NO_DISCARD internal::Mesh processMesh(aiMesh* mesh, const aiScene* scene, aiMatrix4x4 transform);
+        // the index in textures_loaded of every texture path the materials refer to
+        std::unordered_map<std::string, size_t> textureIndices;
 
-        EOGLL_NO_DISCARD std::vector<internal::Texture> loadMaterialTextures(aiMaterial* mat, aiTextureType type, std::string typeName);
-    
-        void extractBones(std::vector<internal::Vertex>& vertices, aiMesh* mesh, const aiScene* scene);
+        // one for every shader the model was drawn with (usually just one, so it is searched linearly)
+        std::vector<internal::ShaderBindings> shaderBindings;
     public:
         std::string path;
         ModelAttrs attrs;
+        // every mesh of the scene once, even if several nodes use it
         std::vector<internal::Mesh> meshes;
+        // the nodes the meshes are drawn at, move parts of the model with nodes.setLocal
+        SceneGraph nodes;
+        // the vertices and indices of every mesh, meshes[i] is range i (drawn with its own base vertex)
+        // the material of a range is the first mesh with the same textures, so meshes that share textures don't rebind them
+        RangedBufferObject render;
         std::vector<internal::Texture> textures_loaded;
-        std::map<std::string, BoneInfo> boneInfoMap;
-        int boneCounter = 0;
+        // the bones the vertices refer to, by id
+        Skeleton skeleton;
+        // the nodes of the model and its animations, see Pose::evaluate
+        NodeHierarchy hierarchy;
+        std::vector<Animation> animations;
+        // the number of vertex, index, texture and packed vertex buffers allocated while loading
+        // every buffer is allocated once, so this is at most 4 per mesh (more means something is copying them)
+        size_t loadAllocations = 0;
+        // where the time loading the model went
+        ModelLoadProfile profile;
 
     };
 }
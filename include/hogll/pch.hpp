@@ -20,7 +20,17 @@
 #include <unordered_map>
 #include <iostream>
 #include <map>
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include <mutex>
 #include <functional>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <cstring>
+#include <cstddef>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
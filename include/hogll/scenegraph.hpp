@@ -0,0 +1,70 @@
+/**
+ * @file scenegraph.hpp
+ * @brief HOGLL scene graph header file
+ * @date 2024-10-22
+ *
+ * HOGLL scene graph
+ *
+ * The node tree of a model is kept as flat arrays instead of being baked into the vertices,
+ * so a mesh used by several nodes is stored once and parts of a model can be moved without uploading anything.
+ */
+
+#pragma once
+#ifndef _HOGLL_SCENEGRAPH_HPP_
+#define _HOGLL_SCENEGRAPH_HPP_
+
+#include "pch.hpp"
+#include "animation.hpp"
+
+namespace ogl {
+    // a mesh drawn with the world matrix of a node
+    struct MeshInstance {
+        int node;
+        // the index of the mesh in the model (the same as in the aiScene)
+        int mesh;
+    };
+
+    // the nodes of a model, flattened so every parent comes before its children (in the same order as NodeHierarchy)
+    // world matrices are cached and only recomputed for nodes whose local transform, or an ancestor's, changed
+    class SceneGraph {
+    public:
+        SceneGraph() = default;
+        SceneGraph(const aiScene* scene);
+
+        EOGLL_NO_DISCARD size_t size() const { return parents.size(); }
+
+        // the first node with that name, -1 if there is none
+        EOGLL_NO_DISCARD int find(const std::string& name) const;
+
+        EOGLL_NO_DISCARD const std::string& name(int node) const { return names[node]; }
+
+        // the index of the parent, -1 for the root
+        EOGLL_NO_DISCARD int parent(int node) const { return parents[node]; }
+
+        EOGLL_NO_DISCARD const glm::mat4& local(int node) const { return locals[node]; }
+
+        // moves a node (and everything under it), the world matrices change on the next update
+        void setLocal(int node, const glm::mat4& transform);
+
+        // the transform of a node relative to the model, as of the last update
+        EOGLL_NO_DISCARD const glm::mat4& world(int node) const { return worlds[node]; }
+
+        // recomputes the world matrices of moved nodes and their children, returns how many were recomputed
+        size_t update();
+
+        // every mesh of every node, in node order
+        EOGLL_NO_DISCARD const std::vector<MeshInstance>& instances() const { return meshInstances; }
+
+    private:
+        std::vector<std::string> names;
+        std::vector<int> parents;
+        std::vector<glm::mat4> locals;
+        std::vector<glm::mat4> worlds;
+        // set by setLocal, cleared by update
+        std::vector<uint8_t> dirty;
+        bool anyDirty = false;
+        std::vector<MeshInstance> meshInstances;
+    };
+}
+
+#endif
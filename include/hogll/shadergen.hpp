@@ -16,7 +16,106 @@
 #include "model.hpp"
 
 namespace ogl {
+    /**
+     * @brief The feature toggles of a shader variant
+     * @see ShaderPermutations
+     *
+     * Every feature in a variant's mask is defined (EOGLL_NORMALS, EOGLL_TEXTURES, ...) right after the #version line of the base sources.
+     */
+    enum ShaderFeature : uint32_t {
+        SHADER_NORMALS = 1 << 0,
+        SHADER_TEXTURES = 1 << 1,
+        SHADER_SKINNING = 1 << 2,
+        SHADER_INSTANCING = 1 << 3,
+        // model/node/view/projection uniforms (node is the RenderModel node matrix)
+        SHADER_TRANSFORMS = 1 << 4,
+        SHADER_ALL_FEATURES = (1 << 5) - 1
+    };
+
+    /**
+     * @brief Compile statistics of a set of shader permutations
+     * @see ShaderPermutations::stats
+     */
+    struct ShaderVariantStats {
+        /// @brief The number of variants asked for
+        size_t requests = 0;
+
+        /// @brief The number of times a variant was already compiled
+        size_t hits = 0;
+
+        /// @brief The number of variants compiled (or loaded from the program cache)
+        size_t compiles = 0;
+
+        /// @brief The number of variants that failed to compile
+        size_t failures = 0;
+
+        /// @brief The number of variants eogllLinkProgram loaded from the program cache (see eogllSetProgramCacheDirectory)
+        size_t programCacheHits = 0;
+
+        /// @brief The time spent compiling variants in seconds
+        double compileTime = 0.0;
+
+        /// @brief The longest time a variant took to compile in seconds
+        double slowestCompile = 0.0;
+    };
+
+    /**
+     * @brief Variants of one shader, compiled once per feature mask
+     * @see ShaderFeature
+     *
+     * The base sources use #ifdef blocks for the features, a variant is the base compiled with the defines of its mask.
+     * Variants are compiled the first time they are asked for (or by prewarm) and owned by the permutations.
+     */
+    class ShaderPermutations {
+    public:
+        // constants are defines every variant gets (for example "#define EOGLL_POSITION_LOCATION 0\n")
+        ShaderPermutations(std::string vertexSource, std::string fragmentSource, std::string constants = "");
+        // deletes the variants, so this needs the context
+        ~ShaderPermutations();
+
+        ShaderPermutations(const ShaderPermutations&) = delete;
+        ShaderPermutations& operator=(const ShaderPermutations&) = delete;
+
+        // returns the variant with the features, compiling it the first time (nullptr if it doesn't compile)
+        EOGLL_NO_DISCARD EogllShaderProgram* get(uint32_t features);
+
+        // compiles the variants that aren't compiled yet, usually during loading so get doesn't stall a frame
+        void prewarm(const std::vector<uint32_t>& features);
+
+        // the defines a variant is compiled with
+        EOGLL_NO_DISCARD std::string defines(uint32_t features) const;
+
+        // the number of variants compiled (including the ones that failed)
+        EOGLL_NO_DISCARD size_t size() const;
+
+        // deletes every variant
+        void clear();
+
+        EOGLL_NO_DISCARD const ShaderVariantStats& stats() const;
+
+    private:
+        std::string vertexSource;
+        std::string fragmentSource;
+        std::string constants;
+        // failed variants are kept as nullptr so they aren't compiled again
+        std::unordered_map<uint32_t, EogllShaderProgram*> variants;
+        ShaderVariantStats statistics;
+    };
+
+    // the features a vertex layout can provide (instancing and transforms aren't part of the layout)
+    EOGLL_NO_DISCARD uint32_t shaderFeatures(const ModelAttrs& attrs);
+
+    // the variants of the basic shader for a vertex layout, shared by every layout with the same attribute locations
+    // the instance matrix (SHADER_INSTANCING) goes in the four locations after the layout
+    EOGLL_NO_DISCARD ShaderPermutations* basicShaderPermutations(const ModelAttrs& attrs);
+
+    // the basic shader for the layout, with simple lighting if there are normals
+    // every call links a new program the caller owns (delete it with eogllDeleteProgram)
     EOGLL_NO_DISCARD EogllShaderProgram* basicShaderGenerator(ModelAttrs attrs, bool defaultUniforms);
+
+    // basicShaderGenerator without linking a new program every time
+    // the program is cached and owned by basicShaderPermutations, calling this again with the same layout returns the same program (don't delete it)
+    EOGLL_NO_DISCARD EogllShaderProgram* basicShaderVariant(const ModelAttrs& attrs, bool defaultUniforms);
 }
 
-#endif
\ No newline at end of file
+#endif
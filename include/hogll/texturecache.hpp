@@ -0,0 +1,152 @@
+/**
+ * @file texturecache.hpp
+ * @brief HOGLL texture cache header file
+ * @date 2024-10-19
+ *
+ * HOGLL texture cache header file
+ */
+
+#pragma once
+#ifndef _HOGLL_TEXTURE_CACHE_HPP_
+#define _HOGLL_TEXTURE_CACHE_HPP_
+
+#include "pch.hpp"
+
+namespace ogl {
+    /**
+     * @brief Memory statistics of a texture cache
+     * @see TextureCache::stats
+     *
+     * Sizes are estimates of the GPU memory used (every level of the mipmap chain, no padding or compression).
+     */
+    struct TextureCacheStats {
+        /// @brief The number of textures in the cache
+        size_t textures;
+
+        /// @brief The number of textures nothing refers to anymore (the ones that can be evicted)
+        size_t unused;
+
+        /// @brief The size of every texture in the cache in bytes
+        size_t bytes;
+
+        /// @brief The size of the textures nothing refers to anymore in bytes
+        size_t unusedBytes;
+
+        /// @brief The number of times a texture was found in the cache
+        size_t hits;
+
+        /// @brief The number of times a texture wasn't found in the cache
+        size_t misses;
+
+        /// @brief The number of textures deleted to stay within the budget (or by trim)
+        size_t evictions;
+    };
+
+    /**
+     * @brief A reference counted cache of textures, keyed by path and load options
+     * @see TextureCache::global
+     *
+     * RenderModels load their textures through the global cache, so models that use the same files share one texture.
+     * Every acquire (or insert) has to be matched by a release. Textures nothing refers to stay in the cache
+     * (so loading them again is free) until the cache is over its budget, then the least recently released ones are deleted first.
+     * The default budget is 0, which deletes textures as soon as nothing refers to them.
+     *
+     * Lookups are thread safe, but anything that can delete a texture (release, insert, trim and setBudget) needs the OpenGL context.
+     */
+    class TextureCache {
+    public:
+        // called right before an evicted texture is deleted (not when a texture is replaced by insert)
+        // the cache isn't locked while it runs, so it can call back into the cache
+        using EvictionHook = std::function<void(const std::string& path, EogllTexture* texture, size_t bytes)>;
+
+        TextureCache() = default;
+        // doesn't delete the textures, the context is usually gone by the time this runs (call trim(0) first)
+        ~TextureCache() = default;
+
+        TextureCache(const TextureCache&) = delete;
+        TextureCache& operator=(const TextureCache&) = delete;
+
+        // the cache RenderModel uses
+        EOGLL_NO_DISCARD static TextureCache& global();
+
+        // the path used as the key, with separators, "." and ".." normalized so different spellings of the same file share a texture
+        EOGLL_NO_DISCARD static std::string canonicalPath(const std::string& path);
+
+        // the GPU memory a texture uses in bytes (see TextureCacheStats)
+        EOGLL_NO_DISCARD static size_t textureSize(const EogllTexture* texture);
+
+        // returns the texture and adds a reference to it, nullptr if it isn't in the cache
+        // options are whatever changes how the file is turned into a texture (0 for eogllCreateTexture)
+        EOGLL_NO_DISCARD EogllTexture* acquire(const std::string& path, uint32_t options = 0);
+
+        // adds a texture that was just created with one reference and returns it
+        // if the path was added in the meantime (by another thread), the texture is deleted and the cached one is acquired instead
+        EogllTexture* insert(const std::string& path, uint32_t options, EogllTexture* texture);
+
+        // removes a reference from a texture that was returned by acquire or insert
+        void release(EogllTexture* texture);
+
+        // deletes unused textures (least recently used first) until the cache uses at most maxBytes, returns the number deleted
+        size_t trim(size_t maxBytes);
+
+        // the number of bytes the cache tries to stay under, used textures are never evicted so it can go over
+        void setBudget(size_t maxBytes);
+
+        void setEvictionHook(EvictionHook hook);
+
+        EOGLL_NO_DISCARD TextureCacheStats stats() const;
+
+    private:
+        struct Key {
+            std::string path;
+            uint32_t options;
+
+            bool operator==(const Key& other) const {
+                return options == other.options && path == other.path;
+            }
+        };
+
+        struct KeyHash {
+            size_t operator()(const Key& key) const {
+                return std::hash<std::string>()(key.path) ^ (std::hash<uint32_t>()(key.options) * 0x9e3779b97f4a7c15ull);
+            }
+        };
+
+        struct Entry {
+            Key key;
+            EogllTexture* texture;
+            size_t refs;
+            size_t bytes;
+            // where the entry is in unused, only valid while refs is 0
+            std::list<Entry*>::iterator unusedIt;
+        };
+
+        // textures that were taken out of the cache, they are deleted (and the hook is called) once the mutex is unlocked
+        struct Evictions {
+            std::vector<Entry> entries;
+            EvictionHook hook;
+        };
+
+        // takes unused textures out of the cache until bytes is at most maxBytes, the mutex has to be locked
+        size_t evict(size_t maxBytes, Evictions& evicted);
+
+        // calls the hook for and deletes the evicted textures, the mutex can't be locked
+        static void finishEvictions(Evictions& evicted);
+
+        mutable std::mutex mutex;
+        // entries don't move in an unordered_map, so the pointers below stay valid until the entry is erased
+        std::unordered_map<Key, Entry, KeyHash> entries;
+        std::unordered_map<const EogllTexture*, Entry*> owners;
+        // textures with no references, least recently released first
+        std::list<Entry*> unused;
+        EvictionHook evictionHook;
+        size_t budget = 0;
+        size_t bytes = 0;
+        size_t unusedBytes = 0;
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t evictions = 0;
+    };
+}
+
+#endif
@@ -15,6 +15,27 @@
 #include "window.hpp"
 
 namespace ogl {
+    // the per-frame uniform block (view, projection, viewPos, time) shared by every program that declares EogllFrame
+    // set the values during the frame, then upload once before drawing
+    class FrameUniforms {
+    public:
+        FrameUniforms();
+        ~FrameUniforms();
+
+        FrameUniforms(const FrameUniforms&) = delete;
+        FrameUniforms& operator=(const FrameUniforms&) = delete;
+
+        void setTime(float time);
+
+        // sends the values to the GPU if they changed and binds the buffer
+        void upload();
+
+        EOGLL_NO_DISCARD EogllFrameUniformBuffer* get();
+
+    private:
+        EogllFrameUniformBuffer* buffer;
+    };
+
     struct Model {
     private:
         EogllModel model;
@@ -56,6 +77,7 @@ namespace ogl {
         void move(EogllCameraDirection dir, float amount);
 
         void update(EogllShaderProgram* shader, const char* name="view");
+        void update(FrameUniforms& frame);
     };
 
     struct Projection {
@@ -69,6 +91,8 @@ namespace ogl {
         void update(EogllShaderProgram* shader, const ogl::Window& window, const char* name="projection");
         void update(EogllShaderProgram* shader, const char* name, uint32_t width, uint32_t height);
         void update(EogllShaderProgram* shader, const char* name, float top, float bottom, float left, float right);
+        void update(FrameUniforms& frame, const ogl::Window& window);
+        void update(FrameUniforms& frame, uint32_t width, uint32_t height);
     };
 }
 
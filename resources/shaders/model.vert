@@ -11,22 +11,36 @@ out vec3 FragPos;
 
 const int MAX_BONES = 100;
 const int MAX_BONE_INFLUENCE = 4;
-uniform mat4 finalBonesMatrices[MAX_BONES];
+// filled by ogl::BonePaletteBuffer
+layout (std140) uniform BonePalette {
+    mat4 finalBonesMatrices[MAX_BONES];
+};
 
 
 uniform mat4 model;
+// the world matrix of the node the mesh belongs to (identity for skinned meshes), set by ogl::RenderModel::draw
+uniform mat4 node;
 uniform mat4 view;
 uniform mat4 projection;
 void main() {
-    FragPos = vec3(model*vec4(aPos, 1.0));
-    gl_Position = projection*view*model*vec4(aPos, 1.0);
-    Normal = mat3(transpose(inverse(model)))*aNormal;
+    // vertices without bones (weights of 0) aren't moved
+    mat4 skin = mat4(0.0);
+    float totalWeight = 0.0;
+    for (int i = 0; i < MAX_BONE_INFLUENCE; i++) {
+        if (aBoneIDs[i] < 0 || aBoneIDs[i] >= MAX_BONES) {
+            continue;
+        }
+        skin += finalBonesMatrices[aBoneIDs[i]] * aWeights[i];
+        totalWeight += aWeights[i];
+    }
+    if (totalWeight == 0.0) {
+        skin = mat4(1.0);
+    }
+    mat4 local = node * skin;
+    vec4 skinnedPos = local * vec4(aPos, 1.0);
+
+    FragPos = vec3(model*skinnedPos);
+    gl_Position = projection*view*model*skinnedPos;
+    Normal = mat3(transpose(inverse(model*local)))*aNormal;
     TexCoord = aTexCoord;
-
-
-    
-
-
-
-
-}
\ No newline at end of file
+}
@@ -9,11 +9,14 @@ out vec3 FragPos;
 
 
 uniform mat4 model;
+// the world matrix of the node the mesh belongs to, set by ogl::RenderModel::draw (identity when drawn without it)
+uniform mat4 node = mat4(1.0);
 uniform mat4 view;
 uniform mat4 projection;
 void main() {
-    FragPos = vec3(model*vec4(aPos, 1.0));
-    gl_Position = projection*view*model*vec4(aPos, 1.0);
-    Normal = mat3(transpose(inverse(model)))*aNormal;
+    mat4 world = model*node;
+    FragPos = vec3(world*vec4(aPos, 1.0));
+    gl_Position = projection*view*world*vec4(aPos, 1.0);
+    Normal = mat3(transpose(inverse(world)))*aNormal;
     TexCoord = aTexCoord;
 }
\ No newline at end of file
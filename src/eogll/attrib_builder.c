@@ -8,9 +8,28 @@ EogllAttribBuilder eogllCreateAttribBuilder() {
 }
 
 void eogllAddAttribute(EogllAttribBuilder *builder, GLenum type, GLint num) {
+    eogllAddAttributeEx(builder, type, num, GL_FALSE);
+}
+
+void eogllAddAttributeEx(EogllAttribBuilder *builder, GLenum type, GLint num, GLboolean normalized) {
     builder->attribs[builder->numAttribs].type = type;
-    builder->attribs[builder->numAttribs].size = eogllSizeOf(type) * num;
-    builder->attribs[builder->numAttribs].normalized = GL_FALSE;
+    switch (type) {
+        case GL_INT_2_10_10_10_REV:
+        case GL_UNSIGNED_INT_2_10_10_10_REV:
+            // all 4 components are packed into a single value
+            builder->attribs[builder->numAttribs].size = eogllSizeOf(type);
+            builder->attribs[builder->numAttribs].num = 4;
+            break;
+        case GL_UNSIGNED_INT_10F_11F_11F_REV:
+            builder->attribs[builder->numAttribs].size = eogllSizeOf(type);
+            builder->attribs[builder->numAttribs].num = 3;
+            break;
+        default:
+            builder->attribs[builder->numAttribs].size = eogllSizeOf(type) * num;
+            builder->attribs[builder->numAttribs].num = num;
+            break;
+    }
+    builder->attribs[builder->numAttribs].normalized = normalized;
     builder->numAttribs++;
 }
 
@@ -25,7 +44,7 @@ void eogllBuildAttributes(EogllAttribBuilder *builder, GLuint vao) {
     uint64_t offset = 0;
     for (int i = 0; i < builder->numAttribs; i++) {
 
-        glVertexAttribPointer(i, builder->attribs[i].size / eogllSizeOf(builder->attribs[i].type), builder->attribs[i].type, builder->attribs[i].normalized, stride, (void*)offset);
+        glVertexAttribPointer(i, builder->attribs[i].num, builder->attribs[i].type, builder->attribs[i].normalized, stride, (void*)offset);
         glEnableVertexAttribArray(i);
         offset += builder->attribs[i].size;
     }
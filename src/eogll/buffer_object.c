@@ -12,6 +12,10 @@ EogllBufferObject eogllCreateBufferObject(unsigned int vao, unsigned int vbo, un
     bufferObject.numIndices = indicesSize / eogllSizeOf(indicesType);
     bufferObject.indicesType = indicesType;
     bufferObject.hasIndices = true;
+    for (int i = 0; i < 3; i++) {
+        bufferObject.positionOffset[i] = 0.0f;
+        bufferObject.positionScale[i] = 1.0f;
+    }
     return bufferObject;
 }
 
@@ -23,14 +27,17 @@ EogllBufferObject eogllCreateBasicBufferObject(unsigned int vao, unsigned int vb
     bufferObject.numIndices = numVertices;
     bufferObject.indicesType = 0;
     bufferObject.hasIndices = false;
+    for (int i = 0; i < 3; i++) {
+        bufferObject.positionOffset[i] = 0.0f;
+        bufferObject.positionScale[i] = 1.0f;
+    }
     return bufferObject;
 }
 
 void eogllDrawBufferObject(EogllBufferObject* bufferObject, GLenum mode) {
     if (!bufferObject->hasIndices) {
-        // Maybe we should just draw it as a basic buffer object?
-        // TODO: figure out what to do here (for now we just log an error)
-        EOGLL_LOG_ERROR(stderr, "Buffer object has no indices\n");
+        // streamed objects don't have indices
+        eogllDrawBasicBufferObject(bufferObject, mode);
         return;
     }
     glBindVertexArray(bufferObject->vao);
@@ -53,4 +60,50 @@ void eogllDeleteBufferObject(EogllBufferObject* bufferObject) {
     glDeleteBuffers(1, &bufferObject->vbo);
     if (bufferObject->hasIndices)
         glDeleteBuffers(1, &bufferObject->ebo);
-}
\ No newline at end of file
+}
+
+EogllRangedBufferObject eogllCreateRangedBufferObject(EogllBufferObject buffer, const EogllDrawRange* ranges, uint32_t numRanges) {
+    EogllRangedBufferObject bufferObject;
+    bufferObject.buffer = buffer;
+    bufferObject.numRanges = 0;
+    bufferObject.ranges = NULL;
+    if (numRanges > 0) {
+        bufferObject.ranges = (EogllDrawRange*)malloc(sizeof(EogllDrawRange) * numRanges);
+        if (!bufferObject.ranges) {
+            EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for draw ranges\n");
+            return bufferObject;
+        }
+        memcpy(bufferObject.ranges, ranges, sizeof(EogllDrawRange) * numRanges);
+        bufferObject.numRanges = numRanges;
+    }
+    return bufferObject;
+}
+
+void eogllDrawRangedBufferObject(EogllRangedBufferObject* bufferObject, GLenum mode, EogllDrawRangeFunc func, void* user) {
+    glBindVertexArray(bufferObject->buffer.vao);
+    for (uint32_t i = 0; i < bufferObject->numRanges; i++) {
+        const EogllDrawRange* range = &bufferObject->ranges[i];
+        if (func && (i == 0 || range->material != bufferObject->ranges[i - 1].material)) {
+            func(range, user);
+        }
+        eogllDrawRange(bufferObject, mode, i);
+    }
+    glBindVertexArray(0);
+}
+
+void eogllDrawRange(const EogllRangedBufferObject* bufferObject, GLenum mode, uint32_t index) {
+    const EogllDrawRange* range = &bufferObject->ranges[index];
+    const void* offset = (const void*)((size_t)range->firstIndex * eogllSizeOf(bufferObject->buffer.indicesType));
+    if (range->baseVertex != 0) {
+        glDrawElementsBaseVertex(mode, (GLint)range->numIndices, bufferObject->buffer.indicesType, offset, range->baseVertex);
+    } else {
+        glDrawElements(mode, (GLint)range->numIndices, bufferObject->buffer.indicesType, offset);
+    }
+}
+
+void eogllDeleteRangedBufferObject(EogllRangedBufferObject* bufferObject) {
+    eogllDeleteBufferObject(&bufferObject->buffer);
+    free(bufferObject->ranges);
+    bufferObject->ranges = NULL;
+    bufferObject->numRanges = 0;
+}
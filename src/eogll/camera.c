@@ -112,4 +112,9 @@ void eogllMoveCamera(EogllCamera *cam, EogllCameraDirection dir, float amount) {
 void eogllUpdateCameraMatrix(EogllCamera *camera, EogllShaderProgram *program, const char *name) {
     EogllCameraMatrix view = eogllCameraMatrix(camera);
     eogllSetUniformMatrix4fv(program, name, view.view);
-}
\ No newline at end of file
+}
+
+void eogllUpdateCameraUniforms(EogllCamera *camera, EogllFrameUniformBuffer *frame) {
+    EogllCameraMatrix view = eogllCameraMatrix(camera);
+    eogllSetFrameView(frame, view.view, camera->pos);
+}
@@ -0,0 +1,189 @@
+#include "eogll/material.h"
+
+#include "eogll/logging.h"
+#include "eogll/util.h"
+
+EogllMaterialLibrary eogllCreateMaterialLibrary() {
+    EogllMaterialLibrary library;
+    library.numMaterials = 0;
+    library.materials = NULL;
+    return library;
+}
+
+static void eogllMaterialDefaults(EogllMaterial* material) {
+    memset(material, 0, sizeof(EogllMaterial));
+    for (int i = 0; i < 3; i++) {
+        material->diffuse[i] = 1.0f;
+    }
+    material->opacity = 1.0f;
+    material->illumination = 2;
+}
+
+static inline bool eogllMaterialIsSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+}
+
+// copies the line from p to lineEnd (without surrounding spaces) into out, cut off if it doesn't fit
+static void eogllMaterialCopyRest(const char* p, const char* lineEnd, char* out, size_t size) {
+    while (p < lineEnd && eogllMaterialIsSpace(*p)) {
+        p++;
+    }
+    while (lineEnd > p && eogllMaterialIsSpace(lineEnd[-1])) {
+        lineEnd--;
+    }
+    size_t length = (size_t)(lineEnd - p);
+    if (length >= size) {
+        length = size - 1;
+    }
+    memcpy(out, p, length);
+    out[length] = '\0';
+}
+
+// reads up to count floats, missing ones are copies of the last one read (so "Kd 0.5" is gray)
+static void eogllMaterialParseFloats(const char* p, const char* lineEnd, float* out, int count) {
+    char line[128];
+    eogllMaterialCopyRest(p, lineEnd, line, sizeof(line));
+    char* cursor = line;
+    int numRead = 0;
+    for (; numRead < count; numRead++) {
+        char* next;
+        float value = strtof(cursor, &next);
+        if (next == cursor) {
+            break;
+        }
+        out[numRead] = value;
+        cursor = next;
+    }
+    for (int i = numRead; numRead > 0 && i < count; i++) {
+        out[i] = out[numRead - 1];
+    }
+}
+
+// texture statements can have options before the file name (like "map_Kd -s 2 2 1 texture.png"), the file name is the last word
+static void eogllMaterialParseMap(const char* p, const char* lineEnd, const char* path, char* out) {
+    char name[EOGLL_MATERIAL_PATH_SIZE];
+    eogllMaterialCopyRest(p, lineEnd, name, sizeof(name));
+    const char* file = name;
+    for (const char* c = name; *c; c++) {
+        if (eogllMaterialIsSpace(*c) && c[1] != '\0' && !eogllMaterialIsSpace(c[1])) {
+            file = c + 1;
+        }
+    }
+    if (*file == '\0' || eogllResolveRelativePath(path, file, out, EOGLL_MATERIAL_PATH_SIZE) != EOGLL_SUCCESS) {
+        out[0] = '\0';
+    }
+}
+
+// whether the line at p starts with the keyword followed by a space
+static inline bool eogllMaterialKeyword(const char* p, const char* lineEnd, const char* keyword) {
+    size_t length = strlen(keyword);
+    return (size_t)(lineEnd - p) > length && memcmp(p, keyword, length) == 0 && eogllMaterialIsSpace(p[length]);
+}
+
+EogllResult eogllParseMaterialBuffer(const char* buffer, size_t size, const char* path, EogllMaterialLibrary* library) {
+    uint32_t capacity = library->numMaterials;
+    EogllMaterial* material = NULL;
+    const char* p = buffer;
+    const char* end = buffer + size;
+    while (p < end) {
+        const char* lineEnd = (const char*)memchr(p, '\n', end - p);
+        const char* next = lineEnd ? lineEnd + 1 : end;
+        if (!lineEnd) {
+            lineEnd = end;
+        }
+        while (p < lineEnd && eogllMaterialIsSpace(*p)) {
+            p++;
+        }
+
+        if (eogllMaterialKeyword(p, lineEnd, "newmtl")) {
+            char name[EOGLL_MATERIAL_NAME_SIZE];
+            eogllMaterialCopyRest(p + 6, lineEnd, name, sizeof(name));
+            int existing = eogllFindMaterial(library, name);
+            if (existing >= 0) {
+                EOGLL_LOG_WARN(stderr, "Material %s is defined again in %s, replacing it\n", name, path);
+                material = &library->materials[existing];
+            } else {
+                if (library->numMaterials == capacity) {
+                    uint32_t newCapacity = capacity ? capacity * 2 : 8;
+                    EogllMaterial* materials = (EogllMaterial*)realloc(library->materials, sizeof(EogllMaterial) * newCapacity);
+                    if (!materials) {
+                        EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for materials\n");
+                        return EOGLL_FAILURE;
+                    }
+                    library->materials = materials;
+                    capacity = newCapacity;
+                }
+                material = &library->materials[library->numMaterials++];
+            }
+            eogllMaterialDefaults(material);
+            memcpy(material->name, name, sizeof(name));
+        } else if (material == NULL || p >= lineEnd || *p == '#') {
+            // comments, empty lines and statements before the first material
+        } else if (eogllMaterialKeyword(p, lineEnd, "Ka")) {
+            eogllMaterialParseFloats(p + 2, lineEnd, material->ambient, 3);
+        } else if (eogllMaterialKeyword(p, lineEnd, "Kd")) {
+            eogllMaterialParseFloats(p + 2, lineEnd, material->diffuse, 3);
+        } else if (eogllMaterialKeyword(p, lineEnd, "Ks")) {
+            eogllMaterialParseFloats(p + 2, lineEnd, material->specular, 3);
+        } else if (eogllMaterialKeyword(p, lineEnd, "Ke")) {
+            eogllMaterialParseFloats(p + 2, lineEnd, material->emissive, 3);
+        } else if (eogllMaterialKeyword(p, lineEnd, "Ns")) {
+            eogllMaterialParseFloats(p + 2, lineEnd, &material->shininess, 1);
+        } else if (eogllMaterialKeyword(p, lineEnd, "d")) {
+            eogllMaterialParseFloats(p + 1, lineEnd, &material->opacity, 1);
+        } else if (eogllMaterialKeyword(p, lineEnd, "Tr")) {
+            float transparency = 0.0f;
+            eogllMaterialParseFloats(p + 2, lineEnd, &transparency, 1);
+            material->opacity = 1.0f - transparency;
+        } else if (eogllMaterialKeyword(p, lineEnd, "illum")) {
+            float illumination = (float)material->illumination;
+            eogllMaterialParseFloats(p + 5, lineEnd, &illumination, 1);
+            material->illumination = (int)illumination;
+        } else if (eogllMaterialKeyword(p, lineEnd, "map_Ka")) {
+            eogllMaterialParseMap(p + 6, lineEnd, path, material->ambientMap);
+        } else if (eogllMaterialKeyword(p, lineEnd, "map_Kd")) {
+            eogllMaterialParseMap(p + 6, lineEnd, path, material->diffuseMap);
+        } else if (eogllMaterialKeyword(p, lineEnd, "map_Ks")) {
+            eogllMaterialParseMap(p + 6, lineEnd, path, material->specularMap);
+        } else if (eogllMaterialKeyword(p, lineEnd, "map_Ke")) {
+            eogllMaterialParseMap(p + 6, lineEnd, path, material->emissiveMap);
+        } else if (eogllMaterialKeyword(p, lineEnd, "map_d")) {
+            eogllMaterialParseMap(p + 5, lineEnd, path, material->opacityMap);
+        } else if (eogllMaterialKeyword(p, lineEnd, "norm")) {
+            eogllMaterialParseMap(p + 4, lineEnd, path, material->normalMap);
+        } else if (eogllMaterialKeyword(p, lineEnd, "map_Bump") || eogllMaterialKeyword(p, lineEnd, "map_bump")) {
+            eogllMaterialParseMap(p + 8, lineEnd, path, material->normalMap);
+        } else if (eogllMaterialKeyword(p, lineEnd, "bump")) {
+            eogllMaterialParseMap(p + 4, lineEnd, path, material->normalMap);
+        }
+        p = next;
+    }
+    return EOGLL_SUCCESS;
+}
+
+EogllResult eogllParseMaterialFile(const char* path, EogllMaterialLibrary* library) {
+    EogllMappedFile file;
+    if (eogllMapFile(path, &file) != EOGLL_SUCCESS) {
+        return EOGLL_FAILURE;
+    }
+    uint32_t before = library->numMaterials;
+    EogllResult result = eogllParseMaterialBuffer(file.data, file.size, path, library);
+    eogllUnmapFile(&file);
+    EOGLL_LOG_DEBUG(stdout, "Read %u materials from %s\n", library->numMaterials - before, path);
+    return result;
+}
+
+int eogllFindMaterial(const EogllMaterialLibrary* library, const char* name) {
+    for (uint32_t i = 0; i < library->numMaterials; i++) {
+        if (strcmp(library->materials[i].name, name) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+void eogllDeleteMaterialLibrary(EogllMaterialLibrary* library) {
+    free(library->materials);
+    library->materials = NULL;
+    library->numMaterials = 0;
+}
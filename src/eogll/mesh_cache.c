@@ -0,0 +1,339 @@
+#include "eogll/mesh_cache.h"
+
+#include "eogll/logging.h"
+#include "eogll/util.h"
+#include "eogll/gl.h"
+
+#define EOGLL_MESH_CACHE_ENDIAN_CHECK 0x01020304u
+#define EOGLL_MESH_CACHE_ALIGN 16
+
+// every field is naturally aligned, so there is no padding and the struct can be written as is
+// (version 2 added the component count of each attribute and the position quantization,
+// version 3 the load options that change the geometry)
+typedef struct EogllMeshCacheAttr {
+    uint32_t attrType;
+    int32_t num;
+    uint32_t glType;
+    int32_t size;
+    uint32_t normalized;
+    int32_t glNum;
+} EogllMeshCacheAttr;
+
+typedef struct EogllMeshCacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t endianCheck;
+    uint32_t numAttrs;
+    EogllMeshCacheAttr attrs[8];
+    uint32_t stride;
+    uint32_t numVertices;
+    uint32_t numIndices;
+    uint32_t indicesType;
+    uint32_t parseMode;
+    uint32_t normalMode;
+    uint32_t optimizeMesh;
+    uint32_t padding;
+    float positionOffset[3];
+    float positionScale[3];
+    uint64_t sourceTime;
+    uint64_t sourceSize;
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+} EogllMeshCacheHeader;
+
+static uint64_t eogllMeshCacheAlign(uint64_t offset) {
+    return (offset + EOGLL_MESH_CACHE_ALIGN - 1) & ~(uint64_t)(EOGLL_MESH_CACHE_ALIGN - 1);
+}
+
+static uint32_t eogllMeshCacheStride(const EogllObjectAttrs* attrs) {
+    uint32_t stride = 0;
+    for (uint32_t i = 0; i < attrs->builder.numAttribs; i++) {
+        stride += (uint32_t)attrs->builder.attribs[i].size;
+    }
+    return stride;
+}
+
+static bool eogllMeshCacheWritePadding(FILE* file, uint64_t* offset) {
+    static const char zeros[EOGLL_MESH_CACHE_ALIGN] = {0};
+    uint64_t aligned = eogllMeshCacheAlign(*offset);
+    size_t padding = (size_t)(aligned - *offset);
+    *offset = aligned;
+    return fwrite(zeros, 1, padding, file) == padding;
+}
+
+EogllResult eogllWriteMeshCache(const char* path, EogllObjectAttrs attrs, const void* vertices, uint32_t numVertices, const void* indices, uint32_t numIndices, GLenum indicesType, const EogllObjectQuantization* quantization, const EogllObjectLoadOptions* options, uint64_t sourceTime, uint64_t sourceSize) {
+    EogllObjectLoadOptions defaultOptions = eogllDefaultObjectLoadOptions();
+    if (!options) {
+        options = &defaultOptions;
+    }
+    if (indicesType != GL_UNSIGNED_SHORT && indicesType != GL_UNSIGNED_INT) {
+        EOGLL_LOG_ERROR(stderr, "Unsupported index type %d for mesh cache %s\n", indicesType, path);
+        return EOGLL_FAILURE;
+    }
+    if (attrs.builder.numAttribs > 8 || attrs.numTypes != attrs.builder.numAttribs) {
+        EOGLL_LOG_ERROR(stderr, "Unsupported attribute layout for mesh cache %s\n", path);
+        return EOGLL_FAILURE;
+    }
+
+    EogllMeshCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "EOM", 4);
+    header.version = EOGLL_MESH_CACHE_VERSION;
+    header.endianCheck = EOGLL_MESH_CACHE_ENDIAN_CHECK;
+    header.numAttrs = attrs.numTypes;
+    for (uint32_t i = 0; i < attrs.numTypes; i++) {
+        header.attrs[i].attrType = (uint32_t)attrs.types[i].type;
+        header.attrs[i].num = attrs.types[i].num;
+        header.attrs[i].glType = attrs.builder.attribs[i].type;
+        header.attrs[i].size = attrs.builder.attribs[i].size;
+        header.attrs[i].normalized = attrs.builder.attribs[i].normalized;
+        header.attrs[i].glNum = attrs.builder.attribs[i].num;
+    }
+    header.stride = eogllMeshCacheStride(&attrs);
+    header.numVertices = numVertices;
+    header.numIndices = numIndices;
+    header.indicesType = indicesType;
+    header.parseMode = (uint32_t)options->parseMode;
+    header.normalMode = (uint32_t)options->normalMode;
+    header.optimizeMesh = options->optimizeMesh ? 1 : 0;
+    for (int i = 0; i < 3; i++) {
+        header.positionOffset[i] = quantization ? quantization->offset[i] : 0.0f;
+        header.positionScale[i] = quantization ? quantization->scale[i] : 1.0f;
+    }
+    header.sourceTime = sourceTime;
+    header.sourceSize = sourceSize;
+    uint64_t vertexSize = (uint64_t)header.stride * numVertices;
+    uint64_t indexSize = (uint64_t)eogllSizeOf(indicesType) * numIndices;
+    header.vertexOffset = eogllMeshCacheAlign(sizeof(header));
+    header.indexOffset = eogllMeshCacheAlign(header.vertexOffset + vertexSize);
+
+    size_t pathLength = strlen(path);
+    char* tempPath = (char*)malloc(pathLength + 5);
+    if (!tempPath) {
+        EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for mesh cache path\n");
+        return EOGLL_FAILURE;
+    }
+    memcpy(tempPath, path, pathLength);
+    memcpy(tempPath + pathLength, ".tmp", 5);
+
+    FILE* file = fopen(tempPath, "wb");
+    if (!file) {
+        EOGLL_LOG_ERROR(stderr, "Failed to open %s for writing\n", tempPath);
+        free(tempPath);
+        return EOGLL_FAILURE;
+    }
+    uint64_t offset = sizeof(header);
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = ok && eogllMeshCacheWritePadding(file, &offset);
+    ok = ok && (vertexSize == 0 || fwrite(vertices, 1, (size_t)vertexSize, file) == vertexSize);
+    offset += vertexSize;
+    ok = ok && eogllMeshCacheWritePadding(file, &offset);
+    ok = ok && (indexSize == 0 || fwrite(indices, 1, (size_t)indexSize, file) == indexSize);
+    ok = fclose(file) == 0 && ok;
+    if (!ok) {
+        EOGLL_LOG_ERROR(stderr, "Failed to write mesh cache %s\n", tempPath);
+        remove(tempPath);
+        free(tempPath);
+        return EOGLL_FAILURE;
+    }
+    // rename doesn't replace existing files on windows
+    remove(path);
+    if (rename(tempPath, path) != 0) {
+        EOGLL_LOG_ERROR(stderr, "Failed to move mesh cache %s to %s\n", tempPath, path);
+        remove(tempPath);
+        free(tempPath);
+        return EOGLL_FAILURE;
+    }
+    free(tempPath);
+    EOGLL_LOG_DEBUG(stdout, "Wrote mesh cache %s (%u vertices, %u indices)\n", path, numVertices, numIndices);
+    return EOGLL_SUCCESS;
+}
+
+// checks that the header is from this version and that everything it points to is inside the file
+static EogllResult eogllMeshCacheValidate(const EogllMappedFile* file, const char* path) {
+    if (file->size < sizeof(EogllMeshCacheHeader)) {
+        EOGLL_LOG_ERROR(stderr, "Mesh cache %s is too small\n", path);
+        return EOGLL_FAILURE;
+    }
+    EogllMeshCacheHeader header;
+    memcpy(&header, file->data, sizeof(header));
+    if (memcmp(header.magic, "EOM", 4) != 0 || header.endianCheck != EOGLL_MESH_CACHE_ENDIAN_CHECK) {
+        EOGLL_LOG_ERROR(stderr, "%s is not a mesh cache\n", path);
+        return EOGLL_FAILURE;
+    }
+    if (header.version != EOGLL_MESH_CACHE_VERSION) {
+        EOGLL_LOG_WARN(stderr, "Mesh cache %s has version %u, expected %u\n", path, header.version, EOGLL_MESH_CACHE_VERSION);
+        return EOGLL_FAILURE;
+    }
+    uint32_t stride = 0;
+    for (uint32_t i = 0; i < header.numAttrs && i < 8; i++) {
+        stride += (uint32_t)header.attrs[i].size;
+    }
+    if (header.numAttrs > 8 || stride != header.stride ||
+        (header.indicesType != GL_UNSIGNED_SHORT && header.indicesType != GL_UNSIGNED_INT) ||
+        header.vertexOffset > file->size || (uint64_t)header.stride * header.numVertices > file->size - header.vertexOffset ||
+        header.indexOffset > file->size || (uint64_t)eogllSizeOf(header.indicesType) * header.numIndices > file->size - header.indexOffset) {
+        EOGLL_LOG_ERROR(stderr, "Mesh cache %s is corrupt\n", path);
+        return EOGLL_FAILURE;
+    }
+    return EOGLL_SUCCESS;
+}
+
+static EogllObjectAttrs eogllMeshCacheAttrs(const EogllMeshCacheHeader* header) {
+    EogllObjectAttrs attrs = eogllCreateObjectAttrs();
+    for (uint32_t i = 0; i < header->numAttrs; i++) {
+        attrs.types[i].type = (EogllObjectAttrType)header->attrs[i].attrType;
+        attrs.types[i].num = header->attrs[i].num;
+        attrs.builder.attribs[i].type = header->attrs[i].glType;
+        attrs.builder.attribs[i].size = header->attrs[i].size;
+        attrs.builder.attribs[i].normalized = (GLboolean)header->attrs[i].normalized;
+        attrs.builder.attribs[i].num = header->attrs[i].glNum;
+    }
+    attrs.numTypes = header->numAttrs;
+    attrs.builder.numAttribs = header->numAttrs;
+    return attrs;
+}
+
+static bool eogllMeshCacheAttrsEqual(const EogllObjectAttrs* a, const EogllObjectAttrs* b) {
+    if (a->numTypes != b->numTypes || a->builder.numAttribs != b->builder.numAttribs) {
+        return false;
+    }
+    for (uint32_t i = 0; i < a->numTypes; i++) {
+        if (a->types[i].type != b->types[i].type || a->types[i].num != b->types[i].num ||
+            a->builder.attribs[i].type != b->builder.attribs[i].type ||
+            a->builder.attribs[i].size != b->builder.attribs[i].size ||
+            a->builder.attribs[i].normalized != b->builder.attribs[i].normalized ||
+            a->builder.attribs[i].num != b->builder.attribs[i].num) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static EogllBufferObject eogllMeshCacheUpload(const EogllMappedFile* file, EogllObjectAttrs* attrs, GLenum usage) {
+    const EogllMeshCacheHeader* header = (const EogllMeshCacheHeader*)file->data;
+    unsigned int vao = eogllGenVertexArray();
+    unsigned int vbo = eogllGenBuffer(vao, GL_ARRAY_BUFFER, (GLsizeiptr)header->stride * header->numVertices, file->data + header->vertexOffset, usage);
+    GLsizeiptr indicesSize = (GLsizeiptr)eogllSizeOf(header->indicesType) * header->numIndices;
+    unsigned int ebo = eogllGenBuffer(vao, GL_ELEMENT_ARRAY_BUFFER, indicesSize, file->data + header->indexOffset, usage);
+    eogllBuildAttributes(&attrs->builder, vao);
+    EogllBufferObject bufferObject = eogllCreateBufferObject(vao, vbo, ebo, indicesSize, header->indicesType);
+    memcpy(bufferObject.positionOffset, header->positionOffset, sizeof(header->positionOffset));
+    memcpy(bufferObject.positionScale, header->positionScale, sizeof(header->positionScale));
+    return bufferObject;
+}
+
+EogllBufferObject eogllLoadMeshCache(const char* path, EogllObjectAttrs* attrs, GLenum usage) {
+    EogllMappedFile file;
+    if (eogllMapFile(path, &file) != EOGLL_SUCCESS) {
+        return (EogllBufferObject){0};
+    }
+    if (eogllMeshCacheValidate(&file, path) != EOGLL_SUCCESS) {
+        eogllUnmapFile(&file);
+        return (EogllBufferObject){0};
+    }
+    // the mapping is page aligned, so the header can be read in place
+    EogllObjectAttrs cacheAttrs = eogllMeshCacheAttrs((const EogllMeshCacheHeader*)file.data);
+    EogllBufferObject bufferObject = eogllMeshCacheUpload(&file, &cacheAttrs, usage);
+    eogllUnmapFile(&file);
+    if (attrs) {
+        *attrs = cacheAttrs;
+    }
+    return bufferObject;
+}
+
+EogllResult eogllLoadMeshCacheIfFresh(const char* cachePath, const char* sourcePath, EogllObjectAttrs attrs, const EogllObjectLoadOptions* options, GLenum usage, EogllBufferObject* bufferObject) {
+    EogllObjectLoadOptions defaultOptions = eogllDefaultObjectLoadOptions();
+    if (!options) {
+        options = &defaultOptions;
+    }
+    uint64_t sourceTime, sourceSize;
+    if (eogllGetFileInfo(sourcePath, &sourceTime, &sourceSize) != EOGLL_SUCCESS) {
+        return EOGLL_FAILURE;
+    }
+    // no cache yet is a normal miss (the first load with useCache), eogllGetFileInfo checks for it without the error eogllMapFile would log
+    uint64_t cacheTime, cacheSize;
+    if (eogllGetFileInfo(cachePath, &cacheTime, &cacheSize) != EOGLL_SUCCESS) {
+        EOGLL_LOG_DEBUG(stdout, "No mesh cache %s\n", cachePath);
+        return EOGLL_FAILURE;
+    }
+    EogllMappedFile file;
+    if (eogllMapFile(cachePath, &file) != EOGLL_SUCCESS) {
+        return EOGLL_FAILURE;
+    }
+    if (eogllMeshCacheValidate(&file, cachePath) != EOGLL_SUCCESS) {
+        eogllUnmapFile(&file);
+        return EOGLL_FAILURE;
+    }
+    const EogllMeshCacheHeader* header = (const EogllMeshCacheHeader*)file.data;
+    if (header->sourceTime != sourceTime || header->sourceSize != sourceSize) {
+        EOGLL_LOG_DEBUG(stdout, "Mesh cache %s is out of date\n", cachePath);
+        eogllUnmapFile(&file);
+        return EOGLL_FAILURE;
+    }
+    if (header->parseMode != (uint32_t)options->parseMode || header->normalMode != (uint32_t)options->normalMode ||
+        header->optimizeMesh != (options->optimizeMesh ? 1u : 0u)) {
+        EOGLL_LOG_DEBUG(stdout, "Mesh cache %s was written with different load options\n", cachePath);
+        eogllUnmapFile(&file);
+        return EOGLL_FAILURE;
+    }
+    EogllObjectAttrs cacheAttrs = eogllMeshCacheAttrs(header);
+    if (!eogllMeshCacheAttrsEqual(&cacheAttrs, &attrs)) {
+        EOGLL_LOG_DEBUG(stdout, "Mesh cache %s was written with different attributes\n", cachePath);
+        eogllUnmapFile(&file);
+        return EOGLL_FAILURE;
+    }
+    *bufferObject = eogllMeshCacheUpload(&file, &attrs, usage);
+    eogllUnmapFile(&file);
+    return EOGLL_SUCCESS;
+}
+
+char* eogllGetMeshCachePath(const char* path) {
+    size_t length = strlen(path);
+    size_t extension = length;
+    for (size_t i = length; i > 0; i--) {
+        char c = path[i - 1];
+        if (c == '/' || c == '\\') {
+            break;
+        }
+        if (c == '.') {
+            extension = i - 1;
+            break;
+        }
+    }
+    char* cachePath = (char*)malloc(extension + 5);
+    if (!cachePath) {
+        EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for mesh cache path\n");
+        return NULL;
+    }
+    memcpy(cachePath, path, extension);
+    memcpy(cachePath + extension, ".eom", 5);
+    return cachePath;
+}
+
+EogllResult eogllConvertObjectToMeshCache(const char* path, const char* cachePath, EogllObjectAttrs attrs, const EogllObjectLoadOptions* options) {
+    EogllObjectLoadOptions defaultOptions = eogllDefaultObjectLoadOptions();
+    if (!options) {
+        options = &defaultOptions;
+    }
+    uint64_t sourceTime, sourceSize;
+    if (eogllGetFileInfo(path, &sourceTime, &sourceSize) != EOGLL_SUCCESS) {
+        EOGLL_LOG_ERROR(stderr, "Failed to open file %s\n", path);
+        return EOGLL_FAILURE;
+    }
+    float* vertices;
+    unsigned int* indices;
+    uint32_t numVertices;
+    uint32_t numIndices;
+    EogllObjectQuantization quantization;
+    if (eogllLoadObjectFileEx(path, attrs, options, &vertices, &numVertices, &indices, &numIndices, &quantization) != EOGLL_SUCCESS) {
+        EOGLL_LOG_ERROR(stderr, "Failed to load object %s\n", path);
+        return EOGLL_FAILURE;
+    }
+    GLsizeiptr indicesSize;
+    GLenum indicesType = eogllObjNarrowIndices(indices, numIndices, numVertices, &indicesSize);
+    EogllResult result = eogllWriteMeshCache(cachePath, attrs, vertices, numVertices, indices, numIndices, indicesType, &quantization, options, sourceTime, sourceSize);
+    free(vertices);
+    free(indices);
+    return result;
+}
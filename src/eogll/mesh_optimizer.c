@@ -0,0 +1,441 @@
+#include "eogll/mesh_optimizer.h"
+
+#include "eogll/logging.h"
+
+#include <math.h>
+
+// a vertex is in the FIFO cache if fewer than cacheSize vertices were added after it
+// times start at cacheSize + 1, so a time of 0 means never added
+static inline bool eogllMeshInCache(const uint32_t* cacheTime, uint32_t time, uint32_t cacheSize, unsigned int vertex) {
+    return time - cacheTime[vertex] <= cacheSize;
+}
+
+EogllVertexCacheStats eogllAnalyzeVertexCache(const unsigned int* indices, uint32_t numIndices, uint32_t numVertices, uint32_t cacheSize) {
+    EogllVertexCacheStats stats;
+    memset(&stats, 0, sizeof(stats));
+    if (cacheSize == 0) {
+        cacheSize = EOGLL_VERTEX_CACHE_SIZE;
+    }
+    if (numIndices < 3 || numVertices == 0) {
+        return stats;
+    }
+    uint32_t* cacheTime = (uint32_t*)calloc(numVertices, sizeof(uint32_t));
+    if (!cacheTime) {
+        EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for vertex cache analysis\n");
+        return stats;
+    }
+    bool* used = (bool*)calloc(numVertices, sizeof(bool));
+    if (!used) {
+        EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for vertex cache analysis\n");
+        free(cacheTime);
+        return stats;
+    }
+    uint32_t time = cacheSize + 1;
+    for (uint32_t i = 0; i < numIndices - numIndices % 3; i++) {
+        unsigned int vertex = indices[i];
+        if (vertex >= numVertices) {
+            continue;
+        }
+        if (!used[vertex]) {
+            used[vertex] = true;
+            stats.numVertices++;
+        }
+        if (!eogllMeshInCache(cacheTime, time, cacheSize, vertex)) {
+            cacheTime[vertex] = time++;
+            stats.numTransforms++;
+        }
+    }
+    stats.numTriangles = numIndices / 3;
+    stats.acmr = (float)stats.numTransforms / (float)stats.numTriangles;
+    stats.atvr = stats.numVertices ? (float)stats.numTransforms / (float)stats.numVertices : 0.0f;
+    free(cacheTime);
+    free(used);
+    return stats;
+}
+
+// the triangles around each vertex, triangles of vertex v are adjacency[offsets[v]] to adjacency[offsets[v + 1]]
+typedef struct EogllMeshAdjacency {
+    uint32_t* offsets;
+    uint32_t* triangles;
+} EogllMeshAdjacency;
+
+static EogllResult eogllMeshBuildAdjacency(const unsigned int* indices, uint32_t numIndices, uint32_t numVertices, EogllMeshAdjacency* adjacency) {
+    adjacency->offsets = (uint32_t*)calloc((size_t)numVertices + 1, sizeof(uint32_t));
+    adjacency->triangles = (uint32_t*)malloc(sizeof(uint32_t) * numIndices);
+    if (!adjacency->offsets || !adjacency->triangles) {
+        free(adjacency->offsets);
+        free(adjacency->triangles);
+        return EOGLL_FAILURE;
+    }
+    for (uint32_t i = 0; i < numIndices; i++) {
+        adjacency->offsets[indices[i] + 1]++;
+    }
+    for (uint32_t v = 0; v < numVertices; v++) {
+        adjacency->offsets[v + 1] += adjacency->offsets[v];
+    }
+    // fill using offsets[v] as the write position, then shift them back
+    for (uint32_t i = 0; i < numIndices; i++) {
+        adjacency->triangles[adjacency->offsets[indices[i]]++] = i / 3;
+    }
+    for (uint32_t v = numVertices; v > 0; v--) {
+        adjacency->offsets[v] = adjacency->offsets[v - 1];
+    }
+    adjacency->offsets[0] = 0;
+    return EOGLL_SUCCESS;
+}
+
+static bool eogllMeshIndicesInRange(const unsigned int* indices, uint32_t numIndices, uint32_t numVertices) {
+    for (uint32_t i = 0; i < numIndices; i++) {
+        if (indices[i] >= numVertices) {
+            return false;
+        }
+    }
+    return true;
+}
+
+EogllResult eogllOptimizeVertexCache(unsigned int* indices, uint32_t numIndices, uint32_t numVertices, uint32_t cacheSize) {
+    if (cacheSize == 0) {
+        cacheSize = EOGLL_VERTEX_CACHE_SIZE;
+    }
+    if (numIndices % 3 != 0 || !eogllMeshIndicesInRange(indices, numIndices, numVertices)) {
+        EOGLL_LOG_ERROR(stderr, "Can't optimize indices that aren't triangles of the given vertices\n");
+        return EOGLL_FAILURE;
+    }
+    if (numIndices == 0) {
+        return EOGLL_SUCCESS;
+    }
+    uint32_t numTriangles = numIndices / 3;
+
+    EogllMeshAdjacency adjacency;
+    if (eogllMeshBuildAdjacency(indices, numIndices, numVertices, &adjacency) != EOGLL_SUCCESS) {
+        EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for vertex cache optimization\n");
+        return EOGLL_FAILURE;
+    }
+    // live is the number of triangles around a vertex that still have to be emitted
+    uint32_t* live = (uint32_t*)malloc(sizeof(uint32_t) * numVertices);
+    uint32_t* cacheTime = (uint32_t*)calloc(numVertices, sizeof(uint32_t));
+    bool* emitted = (bool*)calloc(numTriangles, sizeof(bool));
+    // every emitted vertex is pushed once, so both fit in numIndices
+    unsigned int* deadEnd = (unsigned int*)malloc(sizeof(unsigned int) * numIndices);
+    unsigned int* candidates = (unsigned int*)malloc(sizeof(unsigned int) * numIndices);
+    unsigned int* output = (unsigned int*)malloc(sizeof(unsigned int) * numIndices);
+    if (!live || !cacheTime || !emitted || !deadEnd || !candidates || !output) {
+        EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for vertex cache optimization\n");
+        free(live);
+        free(cacheTime);
+        free(emitted);
+        free(deadEnd);
+        free(candidates);
+        free(output);
+        free(adjacency.offsets);
+        free(adjacency.triangles);
+        return EOGLL_FAILURE;
+    }
+    for (uint32_t v = 0; v < numVertices; v++) {
+        live[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+    }
+
+    uint32_t time = cacheSize + 1;
+    uint32_t numOutput = 0;
+    uint32_t numDeadEnd = 0;
+    uint32_t cursor = 0;
+    int64_t fanning = 0;
+    while (fanning >= 0) {
+        uint32_t numCandidates = 0;
+        // emit every triangle around the fanning vertex
+        for (uint32_t a = adjacency.offsets[fanning]; a < adjacency.offsets[fanning + 1]; a++) {
+            uint32_t triangle = adjacency.triangles[a];
+            if (emitted[triangle]) {
+                continue;
+            }
+            emitted[triangle] = true;
+            for (int k = 0; k < 3; k++) {
+                unsigned int vertex = indices[triangle * 3 + k];
+                output[numOutput++] = vertex;
+                deadEnd[numDeadEnd++] = vertex;
+                candidates[numCandidates++] = vertex;
+                live[vertex]--;
+                if (!eogllMeshInCache(cacheTime, time, cacheSize, vertex)) {
+                    cacheTime[vertex] = time++;
+                }
+            }
+        }
+
+        // the next fanning vertex is the candidate that will stay in the cache the longest while its triangles are emitted
+        int64_t next = -1;
+        int64_t best = -1;
+        for (uint32_t c = 0; c < numCandidates; c++) {
+            unsigned int vertex = candidates[c];
+            if (live[vertex] == 0) {
+                continue;
+            }
+            int64_t priority = 0;
+            int64_t age = (int64_t)time - cacheTime[vertex];
+            if (age + 2 * (int64_t)live[vertex] <= (int64_t)cacheSize) {
+                priority = age;
+            }
+            if (priority > best) {
+                best = priority;
+                next = vertex;
+            }
+        }
+        if (next < 0) {
+            // dead end, go back to a recently used vertex, or else the next vertex with triangles left
+            while (numDeadEnd > 0) {
+                unsigned int vertex = deadEnd[--numDeadEnd];
+                if (live[vertex] > 0) {
+                    next = vertex;
+                    break;
+                }
+            }
+            while (next < 0 && cursor < numVertices) {
+                if (live[cursor] > 0) {
+                    next = cursor;
+                }
+                cursor++;
+            }
+        }
+        fanning = next;
+    }
+
+    // meshes that were already optimized by the exporter can come out slightly worse, those are left alone
+    EogllVertexCacheStats before = eogllAnalyzeVertexCache(indices, numIndices, numVertices, cacheSize);
+    EogllVertexCacheStats after = eogllAnalyzeVertexCache(output, numIndices, numVertices, cacheSize);
+    if (after.numTransforms < before.numTransforms) {
+        memcpy(indices, output, sizeof(unsigned int) * numIndices);
+    }
+    free(live);
+    free(cacheTime);
+    free(emitted);
+    free(deadEnd);
+    free(candidates);
+    free(output);
+    free(adjacency.offsets);
+    free(adjacency.triangles);
+    return EOGLL_SUCCESS;
+}
+
+typedef struct EogllMeshCluster {
+    uint32_t firstTriangle;
+    uint32_t numTriangles;
+    float sortKey;
+} EogllMeshCluster;
+
+static int eogllMeshCompareClusters(const void* a, const void* b) {
+    const EogllMeshCluster* clusterA = (const EogllMeshCluster*)a;
+    const EogllMeshCluster* clusterB = (const EogllMeshCluster*)b;
+    if (clusterA->sortKey != clusterB->sortKey) {
+        return clusterA->sortKey > clusterB->sortKey ? -1 : 1;
+    }
+    // keep the order of equal clusters, so the result doesn't depend on the qsort implementation
+    return clusterA->firstTriangle < clusterB->firstTriangle ? -1 : (clusterA->firstTriangle > clusterB->firstTriangle ? 1 : 0);
+}
+
+// counts the vertices of a triangle that miss the cache and adds them
+static inline uint32_t eogllMeshCacheTriangle(const unsigned int* triangle, uint32_t* cacheTime, uint32_t* time, uint32_t cacheSize) {
+    uint32_t misses = 0;
+    for (int k = 0; k < 3; k++) {
+        if (!eogllMeshInCache(cacheTime, *time, cacheSize, triangle[k])) {
+            cacheTime[triangle[k]] = (*time)++;
+            misses++;
+        }
+    }
+    return misses;
+}
+
+// the area weighted center and the (unnormalized, area weighted) normal of a range of triangles, returns the area
+static float eogllMeshClusterShape(const unsigned int* indices, const EogllMeshCluster* cluster, const float* positions, size_t positionStride, float* center, float* normal) {
+    float area = 0.0f;
+    for (int k = 0; k < 3; k++) {
+        center[k] = 0.0f;
+        normal[k] = 0.0f;
+    }
+    for (uint32_t t = cluster->firstTriangle; t < cluster->firstTriangle + cluster->numTriangles; t++) {
+        const float* a = (const float*)((const unsigned char*)positions + positionStride * indices[t * 3]);
+        const float* b = (const float*)((const unsigned char*)positions + positionStride * indices[t * 3 + 1]);
+        const float* c = (const float*)((const unsigned char*)positions + positionStride * indices[t * 3 + 2]);
+        float ab[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+        float ac[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+        float cross[3] = {ab[1] * ac[2] - ab[2] * ac[1], ab[2] * ac[0] - ab[0] * ac[2], ab[0] * ac[1] - ab[1] * ac[0]};
+        float triangleArea = sqrtf(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+        for (int k = 0; k < 3; k++) {
+            center[k] += (a[k] + b[k] + c[k]) * triangleArea / 3.0f;
+            normal[k] += cross[k];
+        }
+        area += triangleArea;
+    }
+    if (area > 0.0f) {
+        for (int k = 0; k < 3; k++) {
+            center[k] /= area;
+        }
+    }
+    return area;
+}
+
+EogllResult eogllOptimizeOverdraw(unsigned int* indices, uint32_t numIndices, const float* positions, size_t positionStride, uint32_t numVertices, uint32_t cacheSize, float threshold) {
+    if (cacheSize == 0) {
+        cacheSize = EOGLL_VERTEX_CACHE_SIZE;
+    }
+    if (numIndices % 3 != 0 || !eogllMeshIndicesInRange(indices, numIndices, numVertices)) {
+        EOGLL_LOG_ERROR(stderr, "Can't optimize indices that aren't triangles of the given vertices\n");
+        return EOGLL_FAILURE;
+    }
+    uint32_t numTriangles = numIndices / 3;
+    if (numTriangles < 2) {
+        return EOGLL_SUCCESS;
+    }
+    // hard boundaries (where all 3 vertices of a triangle miss, the cache optimizer jumped somewhere else) are
+    // collected in hard, soft boundaries split those further, at most one cluster per triangle for both
+    uint32_t* hard = (uint32_t*)malloc(sizeof(uint32_t) * (numTriangles + 1));
+    EogllMeshCluster* clusters = (EogllMeshCluster*)malloc(sizeof(EogllMeshCluster) * numTriangles);
+    uint32_t* cacheTime = (uint32_t*)calloc(numVertices, sizeof(uint32_t));
+    unsigned int* output = (unsigned int*)malloc(sizeof(unsigned int) * numIndices);
+    if (!hard || !clusters || !cacheTime || !output) {
+        EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for overdraw optimization\n");
+        free(hard);
+        free(clusters);
+        free(cacheTime);
+        free(output);
+        return EOGLL_FAILURE;
+    }
+
+    uint32_t numHard = 0;
+    uint32_t time = cacheSize + 1;
+    for (uint32_t t = 0; t < numTriangles; t++) {
+        if (eogllMeshCacheTriangle(indices + t * 3, cacheTime, &time, cacheSize) == 3 || t == 0) {
+            hard[numHard++] = t;
+        }
+    }
+    hard[numHard] = numTriangles;
+
+    // a soft boundary goes where the miss ratio since the last boundary is already within threshold of the ratio of the whole hard cluster,
+    // this gives the sort more freedom while keeping most of the cache efficiency
+    // (moving time past every cached vertex empties the cache)
+    uint32_t numClusters = 0;
+    for (uint32_t h = 0; h < numHard; h++) {
+        uint32_t first = hard[h];
+        uint32_t end = hard[h + 1];
+        time += cacheSize + 1;
+        uint32_t clusterMisses = 0;
+        for (uint32_t t = first; t < end; t++) {
+            clusterMisses += eogllMeshCacheTriangle(indices + t * 3, cacheTime, &time, cacheSize);
+        }
+        float limit = threshold * (float)clusterMisses / (float)(end - first);
+
+        time += cacheSize + 1;
+        uint32_t start = first;
+        uint32_t misses = 0;
+        for (uint32_t t = first; t < end; t++) {
+            misses += eogllMeshCacheTriangle(indices + t * 3, cacheTime, &time, cacheSize);
+            if (t + 1 < end && (float)misses / (float)(t + 1 - start) <= limit) {
+                clusters[numClusters].firstTriangle = start;
+                clusters[numClusters].numTriangles = t + 1 - start;
+                numClusters++;
+                start = t + 1;
+                misses = 0;
+                time += cacheSize + 1;
+            }
+        }
+        clusters[numClusters].firstTriangle = start;
+        clusters[numClusters].numTriangles = end - start;
+        numClusters++;
+    }
+    free(hard);
+    free(cacheTime);
+
+    // clusters facing away from the mesh center are drawn first, the sort key is dot(clusterCenter - meshCenter, clusterNormal)
+    float* shapes = (float*)malloc(sizeof(float) * 6 * numClusters);
+    if (!shapes) {
+        EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for overdraw optimization\n");
+        free(clusters);
+        free(output);
+        return EOGLL_FAILURE;
+    }
+    float meshCenter[3] = {0.0f, 0.0f, 0.0f};
+    float meshArea = 0.0f;
+    for (uint32_t c = 0; c < numClusters; c++) {
+        float* center = shapes + c * 6;
+        float* normal = shapes + c * 6 + 3;
+        float area = eogllMeshClusterShape(indices, &clusters[c], positions, positionStride, center, normal);
+        for (int k = 0; k < 3; k++) {
+            meshCenter[k] += center[k] * area;
+        }
+        meshArea += area;
+    }
+    if (meshArea > 0.0f) {
+        for (int k = 0; k < 3; k++) {
+            meshCenter[k] /= meshArea;
+        }
+    }
+    for (uint32_t c = 0; c < numClusters; c++) {
+        const float* center = shapes + c * 6;
+        const float* normal = shapes + c * 6 + 3;
+        float normalLength = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        clusters[c].sortKey = 0.0f;
+        if (normalLength > 0.0f) {
+            for (int k = 0; k < 3; k++) {
+                clusters[c].sortKey += (center[k] - meshCenter[k]) * normal[k] / normalLength;
+            }
+        }
+    }
+    free(shapes);
+
+    qsort(clusters, numClusters, sizeof(EogllMeshCluster), eogllMeshCompareClusters);
+    uint32_t numOutput = 0;
+    for (uint32_t c = 0; c < numClusters; c++) {
+        memcpy(output + numOutput, indices + clusters[c].firstTriangle * 3, sizeof(unsigned int) * 3 * clusters[c].numTriangles);
+        numOutput += clusters[c].numTriangles * 3;
+    }
+    // clusters that shared vertices across their boundaries can lose more than threshold once they are apart
+    EogllVertexCacheStats before = eogllAnalyzeVertexCache(indices, numIndices, numVertices, cacheSize);
+    EogllVertexCacheStats after = eogllAnalyzeVertexCache(output, numIndices, numVertices, cacheSize);
+    if ((float)after.numTransforms <= threshold * (float)before.numTransforms) {
+        memcpy(indices, output, sizeof(unsigned int) * numIndices);
+    }
+    free(output);
+    free(clusters);
+    return EOGLL_SUCCESS;
+}
+
+EogllResult eogllOptimizeVertexFetch(void* vertices, uint32_t* numVertices, uint32_t stride, unsigned int* indices, uint32_t numIndices) {
+    if (!eogllMeshIndicesInRange(indices, numIndices, *numVertices)) {
+        EOGLL_LOG_ERROR(stderr, "Can't optimize indices that point outside of the vertices\n");
+        return EOGLL_FAILURE;
+    }
+    unsigned int* remap = (unsigned int*)malloc(sizeof(unsigned int) * (*numVertices ? *numVertices : 1));
+    unsigned char* reordered = (unsigned char*)malloc((size_t)stride * (*numVertices ? *numVertices : 1));
+    if (!remap || !reordered) {
+        EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for vertex fetch optimization\n");
+        free(remap);
+        free(reordered);
+        return EOGLL_FAILURE;
+    }
+    memset(remap, 0xFF, sizeof(unsigned int) * *numVertices);
+    uint32_t numUsed = 0;
+    for (uint32_t i = 0; i < numIndices; i++) {
+        unsigned int vertex = indices[i];
+        if (remap[vertex] == UINT32_MAX) {
+            memcpy(reordered + (size_t)numUsed * stride, (const unsigned char*)vertices + (size_t)vertex * stride, stride);
+            remap[vertex] = numUsed++;
+        }
+        indices[i] = remap[vertex];
+    }
+    memcpy(vertices, reordered, (size_t)numUsed * stride);
+    *numVertices = numUsed;
+    free(remap);
+    free(reordered);
+    return EOGLL_SUCCESS;
+}
+
+EogllResult eogllOptimizeMesh(void* vertices, uint32_t* numVertices, uint32_t stride, int positionOffset, unsigned int* indices, uint32_t numIndices) {
+    if (eogllOptimizeVertexCache(indices, numIndices, *numVertices, EOGLL_VERTEX_CACHE_SIZE) != EOGLL_SUCCESS) {
+        return EOGLL_FAILURE;
+    }
+    if (positionOffset >= 0) {
+        const float* positions = (const float*)((const unsigned char*)vertices + positionOffset);
+        if (eogllOptimizeOverdraw(indices, numIndices, positions, stride, *numVertices, EOGLL_VERTEX_CACHE_SIZE, EOGLL_OVERDRAW_THRESHOLD) != EOGLL_SUCCESS) {
+            return EOGLL_FAILURE;
+        }
+    }
+    return eogllOptimizeVertexFetch(vertices, numVertices, stride, indices, numIndices);
+}
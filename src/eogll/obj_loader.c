@@ -3,6 +3,26 @@
 #include "eogll/logging.h"
 #include "eogll/util.h"
 #include "eogll/gl.h"
+#include "eogll/mesh_cache.h"
+#include "eogll/mesh_optimizer.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+EogllObjectLoadOptions eogllDefaultObjectLoadOptions() {
+    EogllObjectLoadOptions options;
+    options.parseMode = EOGLL_OBJ_PARSE_FAST;
+    options.numThreads = 1;
+    options.useCache = false;
+    options.normalMode = EOGLL_OBJ_NORMALS_SMOOTH;
+    options.streamBudget = 0;
+    options.optimizeMesh = false;
+    return options;
+}
 
 EogllObjectAttrs eogllCreateObjectAttrs() {
     EogllObjectAttrs attrs = {{0}, 0, eogllCreateAttribBuilder()};
@@ -11,20 +31,67 @@ EogllObjectAttrs eogllCreateObjectAttrs() {
 
 void eogllAddObjectAttr(EogllObjectAttrs* attrs, GLenum type, GLint num, EogllObjectAttrType attrType) {
     attrs->types[attrs->numTypes++] = (EogllObjectAttr){attrType, num};
-    eogllAddAttribute(&attrs->builder, type, num);
+    // packed types read as floats in the shader, integer ones are normalized and everything is padded to 4 bytes
+    switch (type) {
+        case GL_HALF_FLOAT:
+            eogllAddAttributeEx(&attrs->builder, type, (num + 1) & ~1, GL_FALSE);
+            break;
+        case GL_SHORT:
+        case GL_UNSIGNED_SHORT:
+            eogllAddAttributeEx(&attrs->builder, type, (num + 1) & ~1, GL_TRUE);
+            break;
+        case GL_BYTE:
+        case GL_UNSIGNED_BYTE:
+            eogllAddAttributeEx(&attrs->builder, type, (num + 3) & ~3, GL_TRUE);
+            break;
+        case GL_INT_2_10_10_10_REV:
+        case GL_UNSIGNED_INT_2_10_10_10_REV:
+            eogllAddAttributeEx(&attrs->builder, type, 4, GL_TRUE);
+            break;
+        default:
+            eogllAddAttribute(&attrs->builder, type, num);
+            break;
+    }
+}
+
+// growable array helper used by the parsers
+static bool eogllObjReserve(void** array, unsigned int* capacity, unsigned int needed, size_t elementSize) {
+    if (needed <= *capacity) {
+        return true;
+    }
+    unsigned int newCapacity = *capacity ? *capacity : 256;
+    while (newCapacity < needed) {
+        newCapacity *= 2;
+    }
+    void* newArray = realloc(*array, elementSize * newCapacity);
+    if (!newArray) {
+        return false;
+    }
+    *array = newArray;
+    *capacity = newCapacity;
+    return true;
 }
 
+static EogllResult eogllObjTriangulate(EogllObjectFileData* data);
+static bool eogllObjAddGroup(EogllObjectFileData* data, unsigned int* capacity, unsigned int firstFace, const char* p, const char* lineEnd);
+static bool eogllObjAddMaterialLibraries(EogllObjectFileData* data, unsigned int* capacity, const char* p, const char* lineEnd);
 
 EogllResult eogllParseObjectFile(FILE* file, EogllObjectFileData *data) {
     char line[256];
     data->numFaces = 0;
+    data->numIndices = 0;
     data->numPositions = 0;
     data->numNormals = 0;
     data->numTexCoords = 0;
     data->faces = NULL;
+    data->indices = NULL;
     data->positions = NULL;
     data->normals = NULL;
     data->texCoords = NULL;
+    data->numGroups = 0;
+    data->groups = NULL;
+    data->numMaterialLibraries = 0;
+    data->materialLibraries = NULL;
     while (fgets(line, sizeof(line), file)) {
         if (line[0] == 'v' && line[1] == ' ') {
             data->numPositions++;
@@ -49,6 +116,9 @@ EogllResult eogllParseObjectFile(FILE* file, EogllObjectFileData *data) {
     unsigned int normalIndex = 0;
     unsigned int texCoordIndex = 0;
     unsigned int faceIndex = 0;
+    unsigned int indicesCapacity = 0;
+    unsigned int groupsCapacity = 0;
+    unsigned int librariesCapacity = 0;
     while (fgets(line, sizeof(line), file)) {
         if (line[0] == 'v' && line[1] == ' ') {
             EogllObjectPosition position;
@@ -82,28 +152,12 @@ EogllResult eogllParseObjectFile(FILE* file, EogllObjectFileData *data) {
         } else if (line[0] == 'f' && line[1] == ' ') {
             EogllObjectFileFace face;
             face.numIndices = 0;
-            // figure out how many indices there are
-            for (int i = 0; i < strlen(line); i++) {
-                if (line[i] == ' ') { // TODO: better way to do this?
-                    face.numIndices++;
-                }
-            }
-            if (face.numIndices != 3) {
-                EOGLL_LOG_WARN(stderr, "Face %d has %d indices, but only 3 are supported\n", faceIndex, face.numIndices);
-                EOGLL_LOG_WARN(stderr, "Skipping face\n");
-                continue;
-            }
-            face.indices = (EogllObjectIndex*)malloc(sizeof(EogllObjectIndex) * face.numIndices);
-            if (!face.indices) {
-                EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for object file face indices\n");
-                return EOGLL_FAILURE;
-            }
+            face.firstIndex = data->numIndices;
             // parse the indices
-            char *token = strtok(line, " ");
-            int index = 0;
+            char *token = strtok(line, " \r\n");
             while (token) {
                 if (token[0] == 'f') {
-                    token = strtok(NULL, " ");
+                    token = strtok(NULL, " \r\n");
                     continue;
                 }
                 EogllObjectIndex objectIndex;
@@ -127,268 +181,2212 @@ EogllResult eogllParseObjectFile(FILE* file, EogllObjectFileData *data) {
                     sscanf(token, "%d", &objectIndex.geomIndex);
                 }
 
-                face.indices[index++] = objectIndex;
-                token = strtok(NULL, " ");
+                if (!eogllObjReserve((void**)&data->indices, &indicesCapacity, data->numIndices + 1, sizeof(EogllObjectIndex))) {
+                    EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for object file face indices\n");
+                    return EOGLL_FAILURE;
+                }
+                data->indices[data->numIndices++] = objectIndex;
+                face.numIndices++;
+                token = strtok(NULL, " \r\n");
+            }
+            if (face.numIndices < 3) {
+                EOGLL_LOG_WARN(stderr, "Face %d has %d indices, but at least 3 are needed\n", faceIndex, face.numIndices);
+                EOGLL_LOG_WARN(stderr, "Skipping face\n");
+                data->numIndices = face.firstIndex;
+                data->numFaces--;
+                continue;
             }
             data->faces[faceIndex++] = face;
+        } else if (strncmp(line, "usemtl", 6) == 0 || strncmp(line, "mtllib", 6) == 0) {
+            bool added = line[0] == 'u' ? eogllObjAddGroup(data, &groupsCapacity, faceIndex, line + 6, line + strlen(line))
+                                        : eogllObjAddMaterialLibraries(data, &librariesCapacity, line + 6, line + strlen(line));
+            if (!added) {
+                EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for object file materials\n");
+                return EOGLL_FAILURE;
+            }
         }
 
     }
-    return EOGLL_SUCCESS;
+    return eogllObjTriangulate(data);
 }
 
-void eogllDeleteObjectFileData(EogllObjectFileData *data) {
-    for (int i = 0; i < data->numFaces; i++) {
-        free(data->faces[i].indices);
+static inline bool eogllObjIsSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+}
+
+static inline bool eogllObjIsDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static inline const char* eogllObjSkipSpace(const char* p, const char* end) {
+    while (p < end && eogllObjIsSpace(*p)) {
+        p++;
     }
-    free(data->faces);
-    free(data->positions);
-    free(data->normals);
-    free(data->texCoords);
+    return p;
 }
 
-EogllResult eogllObjectFileDataToVertices(EogllObjectFileData *data, EogllObjectAttrs attrs, float** vertices, uint32_t* numVertices, unsigned int** indices, uint32_t* numIndices) {
-    // since at the moment, our indices have multiple attributes, we cannot index it easily.
-    // The unoptimized easiest way to do this is to not use indices at all and just duplicate vertices
-    // one thing we can do is to create a map of indices to vertices, and then use that to create the indices (maps are hard in C)
-    // another is to do the first method, but then optimize it by removing duplicate vertices and using indices to reference them
-    // TODO: optimize this
-    // TODO: support rectangles and other polygons by triangulating them
+// starts a material group at firstFace, p is right after "usemtl"
+// only firstFace is set here, eogllObjFinishGroups counts the faces once the file is triangulated
+static bool eogllObjAddGroup(EogllObjectFileData* data, unsigned int* capacity, unsigned int firstFace, const char* p, const char* lineEnd) {
+    p = eogllObjSkipSpace(p, lineEnd);
+    while (lineEnd > p && (eogllObjIsSpace(lineEnd[-1]) || lineEnd[-1] == '\n')) {
+        lineEnd--;
+    }
+    if (!eogllObjReserve((void**)&data->groups, capacity, data->numGroups + 1, sizeof(EogllObjectMaterialGroup))) {
+        return false;
+    }
+    EogllObjectMaterialGroup* group = &data->groups[data->numGroups++];
+    size_t length = (size_t)(lineEnd - p);
+    if (length >= sizeof(group->material)) {
+        length = sizeof(group->material) - 1;
+    }
+    memcpy(group->material, p, length);
+    group->material[length] = '\0';
+    group->firstFace = firstFace;
+    group->numFaces = 0;
+    return true;
+}
 
-    bool attrHasNormal = false;
-    for (int i = 0; i < attrs.numTypes; i++) {
-        if (attrs.types[i].type == EOGLL_ATTR_NORMAL) {
-            attrHasNormal = true;
-            break;
+// adds every file name after "mtllib"
+static bool eogllObjAddMaterialLibraries(EogllObjectFileData* data, unsigned int* capacity, const char* p, const char* lineEnd) {
+    while (true) {
+        p = eogllObjSkipSpace(p, lineEnd);
+        const char* nameEnd = p;
+        while (nameEnd < lineEnd && !eogllObjIsSpace(*nameEnd) && *nameEnd != '\n') {
+            nameEnd++;
+        }
+        if (nameEnd == p) {
+            return true;
+        }
+        if (!eogllObjReserve((void**)&data->materialLibraries, capacity, data->numMaterialLibraries + 1, sizeof(char*))) {
+            return false;
+        }
+        char* name = (char*)malloc((size_t)(nameEnd - p) + 1);
+        if (!name) {
+            return false;
         }
+        memcpy(name, p, (size_t)(nameEnd - p));
+        name[nameEnd - p] = '\0';
+        data->materialLibraries[data->numMaterialLibraries++] = name;
+        p = nameEnd;
     }
-    if (attrHasNormal && (data->numNormals == 0 || data->faces[0].indices[0].hasNormal == false)) {
-        // this means that we requested normals, but the obj file does not have them
-        // we will do some calculations to approximate them
-        eogllGenerateNormals(data);
+}
+
+static const double eogllObjPow10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// reads a float starting at *cursor (leading whitespace is skipped), returns false if there is no number
+static bool eogllObjParseFloat(const char** cursor, const char* end, float* out) {
+    const char* p = eogllObjSkipSpace(*cursor, end);
+    if (p >= end) {
+        return false;
+    }
+    const char* start = p;
+    bool negative = false;
+    if (*p == '-' || *p == '+') {
+        negative = *p == '-';
+        p++;
+    }
+    uint64_t mantissa = 0;
+    int significant = 0;
+    int exponent = 0;
+    bool any = false;
+    while (p < end && eogllObjIsDigit(*p)) {
+        if (significant < 19) {
+            mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+            if (mantissa) significant++;
+        } else {
+            exponent++;
+        }
+        any = true;
+        p++;
+    }
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && eogllObjIsDigit(*p)) {
+            if (significant < 19) {
+                mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+                if (mantissa) significant++;
+                exponent--;
+            }
+            any = true;
+            p++;
+        }
+    }
+    if (!any) {
+        // not a plain decimal number (nan, inf, ...), let the C library deal with it
+        char token[64];
+        size_t len = 0;
+        p = start;
+        while (p < end && !eogllObjIsSpace(*p) && *p != '\n' && len < sizeof(token) - 1) {
+            token[len++] = *p++;
+        }
+        token[len] = '\0';
+        char* tokenEnd;
+        double value = strtod(token, &tokenEnd);
+        if (tokenEnd == token) {
+            return false;
+        }
+        *out = (float)value;
+        *cursor = start + (tokenEnd - token);
+        return true;
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char* e = p + 1;
+        bool expNegative = false;
+        if (e < end && (*e == '-' || *e == '+')) {
+            expNegative = *e == '-';
+            e++;
+        }
+        if (e < end && eogllObjIsDigit(*e)) {
+            int exp = 0;
+            while (e < end && eogllObjIsDigit(*e)) {
+                if (exp < 10000) exp = exp * 10 + (*e - '0');
+                e++;
+            }
+            exponent += expNegative ? -exp : exp;
+            p = e;
+        }
+    }
+    double value = (double)mantissa;
+    if (mantissa != 0 && exponent != 0) {
+        if (exponent < 0 && exponent >= -22) {
+            value /= eogllObjPow10[-exponent];
+        } else if (exponent > 0 && exponent <= 22) {
+            value *= eogllObjPow10[exponent];
+        } else {
+            value *= pow(10.0, exponent);
+        }
     }
+    *out = (float)(negative ? -value : value);
+    *cursor = p;
+    return true;
+}
 
-    // first we need to calculate the number of vertices
-    *numVertices = 0;
-    for (int i = 0; i < data->numFaces; i++) {
-        *numVertices += data->faces[i].numIndices;
+// reads a (possibly negative) integer starting at *cursor, does not skip whitespace
+static bool eogllObjParseInt(const char** cursor, const char* end, long* out) {
+    const char* p = *cursor;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+    if (p >= end || !eogllObjIsDigit(*p)) {
+        return false;
     }
-    *numIndices = *numVertices;
+    long value = 0;
+    while (p < end && eogllObjIsDigit(*p)) {
+        value = value * 10 + (*p - '0');
+        p++;
+    }
+    *out = negative ? -value : value;
+    *cursor = p;
+    return true;
+}
 
-    unsigned int numVerts = 0;
-    for (int i = 0; i < attrs.numTypes; i++) {
-        numVerts += attrs.builder.attribs[i].size / eogllSizeOf(attrs.builder.attribs[i].type);
+// obj indices are 1 based, negative indices are relative to the end of the list read so far
+static inline unsigned int eogllObjResolveIndex(long index, unsigned int count) {
+    if (index < 0) {
+        index += (long)count + 1;
     }
+    return index > 0 ? (unsigned int)index : 0;
+}
 
-    *vertices = (float*)malloc(sizeof(float) * *numVertices * numVerts);
-    *indices = (unsigned int*)malloc(sizeof(unsigned int) * *numIndices);
-    for (int i = 0; i < *numIndices; i++) {
-        (*indices)[i] = i;
+// the bodies of "v", "vn" and "vt" lines, p is right after the keyword
+static void eogllObjParsePosition(const char* p, const char* lineEnd, EogllObjectPosition* position) {
+    position->x = 0.0f;
+    position->y = 0.0f;
+    position->z = 0.0f;
+    position->w = 1.0f;
+    position->hasW = false;
+    eogllObjParseFloat(&p, lineEnd, &position->x);
+    eogllObjParseFloat(&p, lineEnd, &position->y);
+    eogllObjParseFloat(&p, lineEnd, &position->z);
+    if (eogllObjParseFloat(&p, lineEnd, &position->w)) {
+        position->hasW = true;
     }
-    unsigned int vertexIndex = 0;
-    unsigned int max = *numVertices * numVerts;
+}
 
-    for (int i = 0; i < data->numFaces; i++) {
-        for (int j = 0; j < data->faces[i].numIndices; j++) {
-            EogllObjectIndex index = data->faces[i].indices[j];
-            EogllObjectPosition position;
-            EogllObjectNormal normal;
-            EogllObjectTexCoord texCoord;
-            if (data->numPositions > 0) {
-                position = data->positions[index.geomIndex - 1];
+static void eogllObjParseNormal(const char* p, const char* lineEnd, EogllObjectNormal* normal) {
+    normal->x = 0.0f;
+    normal->y = 0.0f;
+    normal->z = 0.0f;
+    eogllObjParseFloat(&p, lineEnd, &normal->x);
+    eogllObjParseFloat(&p, lineEnd, &normal->y);
+    eogllObjParseFloat(&p, lineEnd, &normal->z);
+}
+
+static void eogllObjParseTexCoord(const char* p, const char* lineEnd, EogllObjectTexCoord* texCoord) {
+    texCoord->u = 0.0f;
+    texCoord->v = 0.0f;
+    texCoord->w = 0.0f;
+    texCoord->hasV = false;
+    texCoord->hasW = false;
+    eogllObjParseFloat(&p, lineEnd, &texCoord->u);
+    if (eogllObjParseFloat(&p, lineEnd, &texCoord->v)) {
+        texCoord->hasV = true;
+        if (eogllObjParseFloat(&p, lineEnd, &texCoord->w)) {
+            texCoord->hasW = true;
+        }
+    }
+}
+
+/*
+ * A range of an object file that is parsed on its own.
+ * When the file is split into several chunks, relative indices can't be resolved yet because the chunk doesn't
+ * know how many positions/normals/texture coordinates came before it. In that case they are resolved against the
+ * chunk's own counts (wrapping around if they point into an earlier chunk) and remembered in fixups, so that the
+ * amount from earlier chunks can be added once all chunks are done.
+ */
+typedef struct EogllObjParseChunk {
+    const char* begin;
+    const char* end;
+    EogllObjectFileData data;
+    bool deferRelative;
+    // (corner << 2) | component, corner is the position in data.indices, component 0 = position, 1 = texture coordinate, 2 = normal
+    uint64_t* fixups;
+    unsigned int numFixups;
+    unsigned int fixupsCapacity;
+    EogllResult result;
+} EogllObjParseChunk;
+
+static inline unsigned int eogllObjResolveChunkIndex(EogllObjParseChunk* chunk, long index, unsigned int count, uint64_t corner, unsigned int component) {
+    if (index >= 0 || !chunk->deferRelative) {
+        return eogllObjResolveIndex(index, count);
+    }
+    if (!eogllObjReserve((void**)&chunk->fixups, &chunk->fixupsCapacity, chunk->numFixups + 1, sizeof(uint64_t))) {
+        chunk->result = EOGLL_FAILURE;
+        return 0;
+    }
+    chunk->fixups[chunk->numFixups++] = (corner << 2) | component;
+    // unsigned arithmetic, this may wrap around until the chunk offset is added
+    return (unsigned int)((long)count + 1 + index);
+}
+
+// parses one face vertex (v, v/t, v//n or v/t/n), the cursor must be on the first character
+static bool eogllObjParseFaceIndex(const char** cursor, const char* end, EogllObjParseChunk* chunk, uint64_t corner, EogllObjectIndex* index) {
+    const char* p = *cursor;
+    const EogllObjectFileData* data = &chunk->data;
+    long value;
+    index->hasNormal = false;
+    index->hasTexCoord = false;
+    index->normalIndex = 0;
+    index->texCoordIndex = 0;
+    if (!eogllObjParseInt(&p, end, &value)) {
+        return false;
+    }
+    index->geomIndex = eogllObjResolveChunkIndex(chunk, value, data->numPositions, corner, 0);
+    if (p < end && *p == '/') {
+        p++;
+        if (p < end && *p != '/') {
+            if (eogllObjParseInt(&p, end, &value)) {
+                index->texCoordIndex = eogllObjResolveChunkIndex(chunk, value, data->numTexCoords, corner, 1);
+                index->hasTexCoord = true;
+            }
+        }
+        if (p < end && *p == '/') {
+            p++;
+            if (eogllObjParseInt(&p, end, &value)) {
+                index->normalIndex = eogllObjResolveChunkIndex(chunk, value, data->numNormals, corner, 2);
+                index->hasNormal = true;
+            }
+        }
+    }
+    // skip anything we don't understand in this token
+    while (p < end && !eogllObjIsSpace(*p)) {
+        p++;
+    }
+    *cursor = p;
+    return true;
+}
+
+static void eogllObjParseChunk(EogllObjParseChunk* chunk) {
+    EogllObjectFileData* data = &chunk->data;
+    data->numFaces = 0;
+    data->numIndices = 0;
+    data->numPositions = 0;
+    data->numNormals = 0;
+    data->numTexCoords = 0;
+    data->faces = NULL;
+    data->indices = NULL;
+    data->positions = NULL;
+    data->normals = NULL;
+    data->texCoords = NULL;
+    data->numGroups = 0;
+    data->groups = NULL;
+    data->numMaterialLibraries = 0;
+    data->materialLibraries = NULL;
+    chunk->fixups = NULL;
+    chunk->numFixups = 0;
+    chunk->fixupsCapacity = 0;
+    chunk->result = EOGLL_SUCCESS;
+    unsigned int facesCapacity = 0;
+    unsigned int indicesCapacity = 0;
+    unsigned int positionsCapacity = 0;
+    unsigned int normalsCapacity = 0;
+    unsigned int texCoordsCapacity = 0;
+    unsigned int groupsCapacity = 0;
+    unsigned int librariesCapacity = 0;
+
+    const char* p = chunk->begin;
+    const char* end = chunk->end;
+    while (p < end) {
+        const char* lineEnd = (const char*)memchr(p, '\n', end - p);
+        const char* next = lineEnd ? lineEnd + 1 : end;
+        if (!lineEnd) {
+            lineEnd = end;
+        }
+        p = eogllObjSkipSpace(p, lineEnd);
+        if (lineEnd - p < 2) {
+            p = next;
+            continue;
+        }
+
+        if (p[0] == 'v' && eogllObjIsSpace(p[1])) {
+            if (!eogllObjReserve((void**)&data->positions, &positionsCapacity, data->numPositions + 1, sizeof(EogllObjectPosition))) {
+                goto fail;
             }
-            if (data->numNormals > 0) {
-                normal = data->normals[index.normalIndex - 1];
+            eogllObjParsePosition(p + 2, lineEnd, &data->positions[data->numPositions++]);
+        } else if (p[0] == 'v' && p[1] == 'n') {
+            if (!eogllObjReserve((void**)&data->normals, &normalsCapacity, data->numNormals + 1, sizeof(EogllObjectNormal))) {
+                goto fail;
             }
-            if (data->numTexCoords > 0) {
-                texCoord = data->texCoords[index.texCoordIndex - 1];
+            eogllObjParseNormal(p + 2, lineEnd, &data->normals[data->numNormals++]);
+        } else if (p[0] == 'v' && p[1] == 't') {
+            if (!eogllObjReserve((void**)&data->texCoords, &texCoordsCapacity, data->numTexCoords + 1, sizeof(EogllObjectTexCoord))) {
+                goto fail;
             }
-            for (int k = 0; k < attrs.numTypes; k++) {
-                if (vertexIndex >= max) {
-                    EOGLL_LOG_ERROR(stderr, "Vertex index %d is out of bounds\n", vertexIndex);
-                    return EOGLL_FAILURE;
+            eogllObjParseTexCoord(p + 2, lineEnd, &data->texCoords[data->numTexCoords++]);
+        } else if (p[0] == 'f' && eogllObjIsSpace(p[1])) {
+            EogllObjectFileFace face;
+            face.numIndices = 0;
+            face.firstIndex = data->numIndices;
+            unsigned int fixupsBefore = chunk->numFixups;
+            p += 2;
+            while (true) {
+                p = eogllObjSkipSpace(p, lineEnd);
+                if (p >= lineEnd) {
+                    break;
                 }
-                GLint num = attrs.types[k].num;
-                switch (attrs.types[k].type) {
-                    case EOGLL_ATTR_POSITION: {
-                        if (num == 4) {
-                            (*vertices)[vertexIndex++] = position.x;
-                            (*vertices)[vertexIndex++] = position.y;
-                            (*vertices)[vertexIndex++] = position.z;
-                            if (position.hasW) {
-                                (*vertices)[vertexIndex++] = position.w;
-                            } else {
-                                (*vertices)[vertexIndex++] = 1.0f;
-                            }
-                        } else if (num == 3) {
-                            (*vertices)[vertexIndex++] = position.x;
-                            (*vertices)[vertexIndex++] = position.y;
-                            (*vertices)[vertexIndex++] = position.z;
-                        } else if (num == 2) {
-                            (*vertices)[vertexIndex++] = position.x;
-                            (*vertices)[vertexIndex++] = position.y;
-                        } else {
-                            EOGLL_LOG_WARN(stderr, "Unknown number of position components %d\n", num);
-                        }
-
-                    } break;
-                    case EOGLL_ATTR_NORMAL: {
-                        if (num != 3) {
-                            EOGLL_LOG_WARN(stderr, "Unknown number of normal components %d (expected 3)\n", num);
-                        }
-                        (*vertices)[vertexIndex++] = normal.x;
-                        (*vertices)[vertexIndex++] = normal.y;
-                        (*vertices)[vertexIndex++] = normal.z;
-                    } break;
-                    case EOGLL_ATTR_TEXTURE: {
-                        if (num == 3) {
-                            (*vertices)[vertexIndex++] = texCoord.u;
-                            if (texCoord.hasV) {
-                                (*vertices)[vertexIndex++] = texCoord.v;
-                            } else {
-                                EOGLL_LOG_WARN(stderr, "Texture coordinate %d has no v component\n", index.texCoordIndex);
-                                (*vertices)[vertexIndex++] = 0.0f;
-                            }
-                            if (texCoord.hasW) {
-                                (*vertices)[vertexIndex++] = texCoord.w;
-                            } else {
-                                EOGLL_LOG_WARN(stderr, "Texture coordinate %d has no w component\n", index.texCoordIndex);
-                                (*vertices)[vertexIndex++] = 0.0f;
-                            }
-                        } else if (num == 2) {
-                            (*vertices)[vertexIndex++] = texCoord.u;
-                            if (texCoord.hasV) {
-                                (*vertices)[vertexIndex++] = texCoord.v;
-                            } else {
-                                EOGLL_LOG_WARN(stderr, "Texture coordinate %d has no v component\n", index.texCoordIndex);
-                                (*vertices)[vertexIndex++] = 0.0f;
-                            }
-                        } else if (num == 1) {
-                            (*vertices)[vertexIndex++] = texCoord.u;
-                        } else {
-                            EOGLL_LOG_WARN(stderr, "Unknown number of texture components %d\n", num);
-                        }
-                    } break;
-                    default:
-                        EOGLL_LOG_WARN(stderr, "Unknown attribute type %d\n", attrs.types[k].type);
-                        break;
+                if (!eogllObjReserve((void**)&data->indices, &indicesCapacity, data->numIndices + 1, sizeof(EogllObjectIndex))) {
+                    goto fail;
                 }
+                if (!eogllObjParseFaceIndex(&p, lineEnd, chunk, data->numIndices, &data->indices[data->numIndices])) {
+                    break;
+                }
+                data->numIndices++;
+                face.numIndices++;
+            }
+            if (chunk->result != EOGLL_SUCCESS) {
+                goto fail;
+            }
+            if (face.numIndices < 3) {
+                EOGLL_LOG_WARN(stderr, "Face %d has %d indices, but at least 3 are needed\n", data->numFaces, face.numIndices);
+                EOGLL_LOG_WARN(stderr, "Skipping face\n");
+                data->numIndices = face.firstIndex;
+                chunk->numFixups = fixupsBefore;
+                p = next;
+                continue;
+            }
+            if (!eogllObjReserve((void**)&data->faces, &facesCapacity, data->numFaces + 1, sizeof(EogllObjectFileFace))) {
+                goto fail;
+            }
+            data->faces[data->numFaces++] = face;
+        } else if (lineEnd - p > 6 && (memcmp(p, "usemtl", 6) == 0 || memcmp(p, "mtllib", 6) == 0) && eogllObjIsSpace(p[6])) {
+            bool added = p[0] == 'u' ? eogllObjAddGroup(data, &groupsCapacity, data->numFaces, p + 6, lineEnd)
+                                     : eogllObjAddMaterialLibraries(data, &librariesCapacity, p + 6, lineEnd);
+            if (!added) {
+                goto fail;
             }
         }
+        p = next;
     }
-    return EOGLL_SUCCESS;
+    return;
+
+fail:
+    EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for object file data\n");
+    eogllDeleteObjectFileData(data);
+    free(chunk->fixups);
+    chunk->fixups = NULL;
+    chunk->numFixups = 0;
+    chunk->result = EOGLL_FAILURE;
 }
 
-//void eogllPrintObjectData(EogllObjectFileData* data) {
-//    printf("Positions:\n");
-//    for (int i = 0; i < data->numPositions; i++) {
-//        printf("%f %f %f %f\n", data->positions[i].x, data->positions[i].y, data->positions[i].z, data->positions[i].w);
-//    }
-//    printf("Normals:\n");
-//    for (int i = 0; i < data->numNormals; i++) {
-//        printf("%f %f %f\n", data->normals[i].x, data->normals[i].y, data->normals[i].z);
-//    }
-//    printf("Texture Coordinates:\n");
-//    for (int i = 0; i < data->numTexCoords; i++) {
-//        printf("%f %f %f\n", data->texCoords[i].u, data->texCoords[i].v, data->texCoords[i].w);
-//    }
-//    printf("Faces:\n");
-//    for (int i = 0; i < data->numFaces; i++) {
-//        printf("Face %d:\n", i);
-//        for (int j = 0; j < data->faces[i].numIndices; j++) {
-//            printf("%d/%d/%d ", data->faces[i].indices[j].geomIndex, data->faces[i].indices[j].texCoordIndex,
-//                   data->faces[i].indices[j].normalIndex);
-//        }
-//        printf("\n");
-//    }
-//}
+// fan triangulation, only correct for convex polygons
+static void eogllObjFan(unsigned int n, unsigned int* triangles) {
+    for (unsigned int i = 1; i + 1 < n; i++) {
+        *triangles++ = 0;
+        *triangles++ = i;
+        *triangles++ = i + 1;
+    }
+}
 
-EogllResult eogllLoadObjectFile(const char* path, EogllObjectAttrs attrs, float** vertices, uint32_t* numVertices, unsigned int** indices, uint32_t* numIndices) {
-    FILE* file = fopen(path, "r");
-    if (!file) {
-        EOGLL_LOG_ERROR(stderr, "Failed to open file %s\n", path);
-        return EOGLL_FAILURE;
+static inline float eogllObjCross2(const float* a, const float* b, const float* c) {
+    return (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]);
+}
+
+/*
+ * Writes (n - 2) triangles as corner numbers (0 to n - 1) of the polygon into triangles.
+ * The polygon is projected onto the plane of its largest normal component, convex polygons are fanned
+ * and concave ones are ear clipped. Degenerate polygons (or ones that reference positions we don't have) are fanned.
+ * points must hold 2n floats and remaining must hold n ints.
+ */
+static void eogllObjTriangulatePolygon(const EogllObjectFileData* data, const EogllObjectIndex* polygon, unsigned int n, unsigned int* triangles, float* points, unsigned int* remaining) {
+    for (unsigned int i = 0; i < n; i++) {
+        if (polygon[i].geomIndex == 0 || polygon[i].geomIndex > data->numPositions) {
+            eogllObjFan(n, triangles);
+            return;
+        }
     }
-    double start = eogllGetTime();
-    EogllObjectFileData data;
-    if (eogllParseObjectFile(file, &data) != EOGLL_SUCCESS) {
-        EOGLL_LOG_ERROR(stderr, "Failed to parse object file %s\n", path);
-        return EOGLL_FAILURE;
+    // Newell's method, works for any (even concave) planar polygon
+    float nx = 0.0f, ny = 0.0f, nz = 0.0f;
+    for (unsigned int i = 0; i < n; i++) {
+        const EogllObjectPosition* a = &data->positions[polygon[i].geomIndex - 1];
+        const EogllObjectPosition* b = &data->positions[polygon[(i + 1) % n].geomIndex - 1];
+        nx += (a->y - b->y) * (a->z + b->z);
+        ny += (a->z - b->z) * (a->x + b->x);
+        nz += (a->x - b->x) * (a->y + b->y);
+    }
+    float ax = fabsf(nx), ay = fabsf(ny), az = fabsf(nz);
+    if (ax + ay + az == 0.0f) {
+        eogllObjFan(n, triangles);
+        return;
+    }
+    // drop the largest axis, keep the winding so that the projected area is positive
+    float orientation;
+    for (unsigned int i = 0; i < n; i++) {
+        const EogllObjectPosition* position = &data->positions[polygon[i].geomIndex - 1];
+        if (ax >= ay && ax >= az) {
+            points[i * 2] = position->y;
+            points[i * 2 + 1] = position->z;
+        } else if (ay >= az) {
+            points[i * 2] = position->z;
+            points[i * 2 + 1] = position->x;
+        } else {
+            points[i * 2] = position->x;
+            points[i * 2 + 1] = position->y;
+        }
+    }
+    if (ax >= ay && ax >= az) {
+        orientation = nx > 0.0f ? 1.0f : -1.0f;
+    } else if (ay >= az) {
+        orientation = ny > 0.0f ? 1.0f : -1.0f;
+    } else {
+        orientation = nz > 0.0f ? 1.0f : -1.0f;
     }
 
-    EOGLL_LOG_DEBUG(stdout, "Parsed object file %s\n", path);
+    bool convex = true;
+    for (unsigned int i = 0; i < n && convex; i++) {
+        const float* prev = &points[((i + n - 1) % n) * 2];
+        const float* cur = &points[i * 2];
+        const float* next = &points[((i + 1) % n) * 2];
+        if (eogllObjCross2(prev, cur, next) * orientation < 0.0f) {
+            convex = false;
+        }
+    }
+    if (convex) {
+        eogllObjFan(n, triangles);
+        return;
+    }
 
-    double middle = eogllGetTime();
+    // ear clipping
+    for (unsigned int i = 0; i < n; i++) {
+        remaining[i] = i;
+    }
+    unsigned int count = n;
+    unsigned int i = 0;
+    unsigned int sinceLastEar = 0;
+    while (count > 3) {
+        unsigned int prevCorner = remaining[(i + count - 1) % count];
+        unsigned int corner = remaining[i];
+        unsigned int nextCorner = remaining[(i + 1) % count];
+        const float* a = &points[prevCorner * 2];
+        const float* b = &points[corner * 2];
+        const float* c = &points[nextCorner * 2];
+        bool ear = eogllObjCross2(a, b, c) * orientation > 0.0f;
+        for (unsigned int j = 0; j < count && ear; j++) {
+            unsigned int other = remaining[j];
+            if (other == prevCorner || other == corner || other == nextCorner) {
+                continue;
+            }
+            const float* p = &points[other * 2];
+            if (eogllObjCross2(a, b, p) * orientation >= 0.0f &&
+                eogllObjCross2(b, c, p) * orientation >= 0.0f &&
+                eogllObjCross2(c, a, p) * orientation >= 0.0f) {
+                ear = false;
+            }
+        }
+        if (ear) {
+            *triangles++ = prevCorner;
+            *triangles++ = corner;
+            *triangles++ = nextCorner;
+            memmove(&remaining[i], &remaining[i + 1], sizeof(unsigned int) * (count - i - 1));
+            count--;
+            if (i >= count) {
+                i = 0;
+            }
+            sinceLastEar = 0;
+        } else {
+            i = (i + 1) % count;
+            if (++sinceLastEar > count) {
+                // self intersecting or degenerate, fan what is left
+                for (unsigned int k = 1; k + 1 < count; k++) {
+                    *triangles++ = remaining[0];
+                    *triangles++ = remaining[k];
+                    *triangles++ = remaining[k + 1];
+                }
+                return;
+            }
+        }
+    }
+    *triangles++ = remaining[0];
+    *triangles++ = remaining[1];
+    *triangles++ = remaining[2];
+}
 
-    if (eogllObjectFileDataToVertices(&data, attrs, vertices, numVertices, indices, numIndices) != EOGLL_SUCCESS) {
-        EOGLL_LOG_ERROR(stderr, "Failed to convert object file data to vertices\n");
-        return EOGLL_FAILURE;
+// sets numFaces of every material group, faces before the first usemtl get a group without a material
+static EogllResult eogllObjFinishGroups(EogllObjectFileData* data) {
+    if (data->numGroups == 0) {
+        return EOGLL_SUCCESS;
+    }
+    if (data->groups[0].firstFace > 0) {
+        EogllObjectMaterialGroup* groups = (EogllObjectMaterialGroup*)realloc(data->groups, sizeof(EogllObjectMaterialGroup) * (data->numGroups + 1));
+        if (!groups) {
+            EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for object file materials\n");
+            eogllDeleteObjectFileData(data);
+            return EOGLL_FAILURE;
+        }
+        memmove(groups + 1, groups, sizeof(EogllObjectMaterialGroup) * data->numGroups);
+        groups[0].material[0] = '\0';
+        groups[0].firstFace = 0;
+        data->groups = groups;
+        data->numGroups++;
     }
+    for (unsigned int i = 0; i < data->numGroups; i++) {
+        unsigned int end = i + 1 < data->numGroups ? data->groups[i + 1].firstFace : data->numFaces;
+        data->groups[i].numFaces = end - data->groups[i].firstFace;
+    }
+    return EOGLL_SUCCESS;
+}
 
-    double end = eogllGetTime();
+// replaces every face with more than 3 indices with triangles
+static EogllResult eogllObjTriangulate(EogllObjectFileData* data) {
+    unsigned int numTriangleIndices = 0;
+    unsigned int maxIndices = 3;
+    for (unsigned int i = 0; i < data->numFaces; i++) {
+        numTriangleIndices += (data->faces[i].numIndices - 2) * 3;
+        if (data->faces[i].numIndices > maxIndices) {
+            maxIndices = data->faces[i].numIndices;
+        }
+    }
+    if (maxIndices == 3) {
+        return eogllObjFinishGroups(data);
+    }
 
+    unsigned int numTriangles = numTriangleIndices / 3;
+    EogllObjectFileFace* faces = (EogllObjectFileFace*)malloc(sizeof(EogllObjectFileFace) * numTriangles);
+    EogllObjectIndex* indices = (EogllObjectIndex*)malloc(sizeof(EogllObjectIndex) * numTriangleIndices);
+    unsigned int* triangles = (unsigned int*)malloc(sizeof(unsigned int) * (maxIndices - 2) * 3);
+    float* points = (float*)malloc(sizeof(float) * maxIndices * 2);
+    unsigned int* remaining = (unsigned int*)malloc(sizeof(unsigned int) * maxIndices);
+    if (!faces || !indices || !triangles || !points || !remaining) {
+        EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for triangulation\n");
+        free(faces);
+        free(indices);
+        free(triangles);
+        free(points);
+        free(remaining);
+        eogllDeleteObjectFileData(data);
+        return EOGLL_FAILURE;
+    }
 
-    eogllDeleteObjectFileData(&data);
+    unsigned int numPolygons = 0;
+    unsigned int out = 0;
+    unsigned int group = 0;
+    for (unsigned int i = 0; i < data->numFaces; i++) {
+        // groups point to the first triangle of their first face from now on
+        while (group < data->numGroups && data->groups[group].firstFace <= i) {
+            data->groups[group++].firstFace = out / 3;
+        }
+        const EogllObjectIndex* polygon = &data->indices[data->faces[i].firstIndex];
+        unsigned int n = data->faces[i].numIndices;
+        if (n == 3) {
+            triangles[0] = 0;
+            triangles[1] = 1;
+            triangles[2] = 2;
+        } else {
+            eogllObjTriangulatePolygon(data, polygon, n, triangles, points, remaining);
+            numPolygons++;
+        }
+        for (unsigned int j = 0; j < (n - 2) * 3; j += 3) {
+            faces[out / 3].numIndices = 3;
+            faces[out / 3].firstIndex = out;
+            indices[out++] = polygon[triangles[j]];
+            indices[out++] = polygon[triangles[j + 1]];
+            indices[out++] = polygon[triangles[j + 2]];
+        }
+    }
+    free(triangles);
+    free(points);
+    free(remaining);
 
-    EOGLL_LOG_DEBUG(stdout, "Object Loaded.\n");
-    EOGLL_LOG_DEBUG(stdout, "Num vertices: %d\n", *numVertices);
-    EOGLL_LOG_DEBUG(stdout, "Parsed in %f seconds\n", middle - start);
-    EOGLL_LOG_DEBUG(stdout, "Converted in %f seconds\n", end - middle);
+    free(data->faces);
+    free(data->indices);
+    data->faces = faces;
+    data->indices = indices;
+    data->numFaces = numTriangles;
+    data->numIndices = numTriangleIndices;
+    while (group < data->numGroups) {
+        data->groups[group++].firstFace = numTriangles;
+    }
+    EOGLL_LOG_DEBUG(stdout, "Triangulated %u polygons\n", numPolygons);
+    return eogllObjFinishGroups(data);
+}
 
-    return EOGLL_SUCCESS;
+EogllResult eogllParseObjectBuffer(const char* buffer, size_t size, EogllObjectFileData *data) {
+    EogllObjParseChunk chunk;
+    chunk.begin = buffer;
+    chunk.end = buffer + size;
+    chunk.deferRelative = false;
+    eogllObjParseChunk(&chunk);
+    free(chunk.fixups);
+    *data = chunk.data;
+    if (chunk.result != EOGLL_SUCCESS) {
+        return EOGLL_FAILURE;
+    }
+    return eogllObjTriangulate(data);
+}
 
+#ifdef _WIN32
+static DWORD WINAPI eogllObjParseThread(LPVOID arg) {
+    eogllObjParseChunk((EogllObjParseChunk*)arg);
+    return 0;
 }
+#else
+static void* eogllObjParseThread(void* arg) {
+    eogllObjParseChunk((EogllObjParseChunk*)arg);
+    return NULL;
+}
+#endif
 
-EogllBufferObject eogllLoadBufferObject(const char* path, EogllObjectAttrs attrs, GLenum usage) {
-    float* vertices;
-    unsigned int* indices;
-    uint32_t numVertices;
-    uint32_t numIndices;
-    if (eogllLoadObjectFile(path, attrs, &vertices, &numVertices, &indices, &numIndices) != EOGLL_SUCCESS) {
-        EOGLL_LOG_ERROR(stderr, "Failed to load object %s\n", path);
-        return (EogllBufferObject){0};
+// concatenates the chunks into data and applies the relative index fixups, the chunks' arrays are freed
+static EogllResult eogllObjMergeChunks(EogllObjParseChunk* chunks, unsigned int numChunks, EogllObjectFileData* data) {
+    data->numFaces = 0;
+    data->numIndices = 0;
+    data->numPositions = 0;
+    data->numNormals = 0;
+    data->numTexCoords = 0;
+    data->numGroups = 0;
+    data->numMaterialLibraries = 0;
+    for (unsigned int i = 0; i < numChunks; i++) {
+        data->numGroups += chunks[i].data.numGroups;
+        data->numMaterialLibraries += chunks[i].data.numMaterialLibraries;
+        data->numFaces += chunks[i].data.numFaces;
+        data->numIndices += chunks[i].data.numIndices;
+        data->numPositions += chunks[i].data.numPositions;
+        data->numNormals += chunks[i].data.numNormals;
+        data->numTexCoords += chunks[i].data.numTexCoords;
+    }
+    data->faces = (EogllObjectFileFace*)malloc(sizeof(EogllObjectFileFace) * (data->numFaces ? data->numFaces : 1));
+    data->indices = (EogllObjectIndex*)malloc(sizeof(EogllObjectIndex) * (data->numIndices ? data->numIndices : 1));
+    data->positions = (EogllObjectPosition*)malloc(sizeof(EogllObjectPosition) * (data->numPositions ? data->numPositions : 1));
+    data->normals = (EogllObjectNormal*)malloc(sizeof(EogllObjectNormal) * (data->numNormals ? data->numNormals : 1));
+    data->texCoords = (EogllObjectTexCoord*)malloc(sizeof(EogllObjectTexCoord) * (data->numTexCoords ? data->numTexCoords : 1));
+    data->groups = (EogllObjectMaterialGroup*)malloc(sizeof(EogllObjectMaterialGroup) * (data->numGroups ? data->numGroups : 1));
+    data->materialLibraries = (char**)malloc(sizeof(char*) * (data->numMaterialLibraries ? data->numMaterialLibraries : 1));
+    bool failed = !data->faces || !data->indices || !data->positions || !data->normals || !data->texCoords || !data->groups || !data->materialLibraries;
+    if (failed) {
+        EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for object file data\n");
+        // the library names are still owned by the chunks
+        data->numMaterialLibraries = 0;
+        eogllDeleteObjectFileData(data);
     }
 
-    unsigned int numVerts = 0;
-    for (int i = 0; i < attrs.numTypes; i++) {
-        numVerts += attrs.builder.attribs[i].size / eogllSizeOf(attrs.builder.attribs[i].type);
+    // prefix sums of everything that came before each chunk
+    unsigned int faceOffset = 0;
+    unsigned int indexOffset = 0;
+    unsigned int positionOffset = 0;
+    unsigned int normalOffset = 0;
+    unsigned int texCoordOffset = 0;
+    unsigned int groupOffset = 0;
+    unsigned int libraryOffset = 0;
+    for (unsigned int i = 0; i < numChunks; i++) {
+        EogllObjParseChunk* chunk = &chunks[i];
+        if (!failed) {
+            for (unsigned int j = 0; j < chunk->numFixups; j++) {
+                EogllObjectIndex* index = &chunk->data.indices[chunk->fixups[j] >> 2];
+                switch (chunk->fixups[j] & 3) {
+                    case 0: index->geomIndex += positionOffset; break;
+                    case 1: index->texCoordIndex += texCoordOffset; break;
+                    default: index->normalIndex += normalOffset; break;
+                }
+            }
+            for (unsigned int j = 0; j < chunk->data.numFaces; j++) {
+                data->faces[faceOffset + j].numIndices = chunk->data.faces[j].numIndices;
+                data->faces[faceOffset + j].firstIndex = chunk->data.faces[j].firstIndex + indexOffset;
+            }
+            memcpy(data->indices + indexOffset, chunk->data.indices, sizeof(EogllObjectIndex) * chunk->data.numIndices);
+            memcpy(data->positions + positionOffset, chunk->data.positions, sizeof(EogllObjectPosition) * chunk->data.numPositions);
+            memcpy(data->normals + normalOffset, chunk->data.normals, sizeof(EogllObjectNormal) * chunk->data.numNormals);
+            memcpy(data->texCoords + texCoordOffset, chunk->data.texCoords, sizeof(EogllObjectTexCoord) * chunk->data.numTexCoords);
+            for (unsigned int j = 0; j < chunk->data.numGroups; j++) {
+                data->groups[groupOffset + j] = chunk->data.groups[j];
+                data->groups[groupOffset + j].firstFace += faceOffset;
+            }
+            // the names move to data, so the chunk doesn't free them
+            memcpy(data->materialLibraries + libraryOffset, chunk->data.materialLibraries, sizeof(char*) * chunk->data.numMaterialLibraries);
+            libraryOffset += chunk->data.numMaterialLibraries;
+            chunk->data.numMaterialLibraries = 0;
+        }
+        groupOffset += chunk->data.numGroups;
+        faceOffset += chunk->data.numFaces;
+        indexOffset += chunk->data.numIndices;
+        positionOffset += chunk->data.numPositions;
+        normalOffset += chunk->data.numNormals;
+        texCoordOffset += chunk->data.numTexCoords;
+        eogllDeleteObjectFileData(&chunk->data);
+        free(chunk->fixups);
     }
-    unsigned int vao = eogllGenVertexArray();
-    unsigned int vbo = eogllGenBuffer(vao, GL_ARRAY_BUFFER, (unsigned int)sizeof(float) * numVertices * numVerts, vertices, usage);
-    unsigned int ebo = eogllGenBuffer(vao, GL_ELEMENT_ARRAY_BUFFER, (unsigned int)sizeof(unsigned int) * numIndices, indices, usage);
-    eogllBuildAttributes(&attrs.builder, vao);
-    free(vertices);
-    free(indices);
-    return eogllCreateBufferObject(vao, vbo, ebo, (unsigned int)sizeof(unsigned int) * numIndices, GL_UNSIGNED_INT);
+    return failed ? EOGLL_FAILURE : EOGLL_SUCCESS;
 }
 
-void eogllGenerateNormals(EogllObjectFileData *data) {
-    for (int i = 0; i < data->numFaces; i++) {
-        if (data->faces[i].numIndices != 3) {
-            EOGLL_LOG_WARN(stderr, "Face %d has %d indices, but only 3 are supported\n", i, data->faces[i].numIndices);
-            continue;
+EogllResult eogllParseObjectBufferParallel(const char* buffer, size_t size, EogllObjectFileData *data, unsigned int numThreads) {
+    if (numThreads == 0) {
+        numThreads = eogllGetProcessorCount();
+    }
+    // below this there isn't enough work to be worth starting threads
+    const size_t minChunkSize = 1 << 20;
+    if (numThreads > size / minChunkSize) {
+        numThreads = (unsigned int)(size / minChunkSize);
+    }
+    if (numThreads <= 1) {
+        return eogllParseObjectBuffer(buffer, size, data);
+    }
+
+    EogllObjParseChunk* chunks = (EogllObjParseChunk*)malloc(sizeof(EogllObjParseChunk) * numThreads);
+    if (!chunks) {
+        EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for object file chunks\n");
+        return EOGLL_FAILURE;
+    }
+    // split the buffer into roughly equal chunks that each start at the beginning of a line
+    const char* end = buffer + size;
+    const char* begin = buffer;
+    unsigned int numChunks = 0;
+    for (unsigned int i = 0; i < numThreads && begin < end; i++) {
+        const char* chunkEnd = end;
+        if (i != numThreads - 1) {
+            chunkEnd = buffer + size / numThreads * (i + 1);
+            if (chunkEnd < begin) {
+                chunkEnd = begin;
+            }
+            const char* newline = (const char*)memchr(chunkEnd, '\n', end - chunkEnd);
+            chunkEnd = newline ? newline + 1 : end;
+        }
+        chunks[numChunks].begin = begin;
+        chunks[numChunks].end = chunkEnd;
+        chunks[numChunks].deferRelative = numChunks != 0;
+        numChunks++;
+        begin = chunkEnd;
+    }
+
+    // the first chunk is parsed on this thread
+#ifdef _WIN32
+    HANDLE* threads = (HANDLE*)malloc(sizeof(HANDLE) * numChunks);
+#else
+    pthread_t* threads = (pthread_t*)malloc(sizeof(pthread_t) * numChunks);
+#endif
+    bool* started = (bool*)calloc(numChunks, sizeof(bool));
+    if (!threads || !started) {
+        EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for object file threads\n");
+        free(threads);
+        free(started);
+        free(chunks);
+        return EOGLL_FAILURE;
+    }
+    for (unsigned int i = 1; i < numChunks; i++) {
+#ifdef _WIN32
+        threads[i] = CreateThread(NULL, 0, eogllObjParseThread, &chunks[i], 0, NULL);
+        started[i] = threads[i] != NULL;
+#else
+        started[i] = pthread_create(&threads[i], NULL, eogllObjParseThread, &chunks[i]) == 0;
+#endif
+    }
+    eogllObjParseChunk(&chunks[0]);
+    EogllResult result = chunks[0].result;
+    for (unsigned int i = 1; i < numChunks; i++) {
+        if (started[i]) {
+#ifdef _WIN32
+            WaitForSingleObject(threads[i], INFINITE);
+            CloseHandle(threads[i]);
+#else
+            pthread_join(threads[i], NULL);
+#endif
+        } else {
+            // couldn't start a thread, just do the work here
+            eogllObjParseChunk(&chunks[i]);
+        }
+        if (chunks[i].result != EOGLL_SUCCESS) {
+            result = EOGLL_FAILURE;
         }
-        EogllObjectIndex indexA = data->faces[i].indices[0];
-        EogllObjectIndex indexB = data->faces[i].indices[1];
-        EogllObjectIndex indexC = data->faces[i].indices[2];
-        EogllObjectPosition positionA = data->positions[indexA.geomIndex - 1];
-        EogllObjectPosition positionB = data->positions[indexB.geomIndex - 1];
-        EogllObjectPosition positionC = data->positions[indexC.geomIndex - 1];
-        // cross(b-a, c-a)
-        float nx = (positionB.x - positionA.x) * (positionC.y - positionA.y) - (positionC.x - positionA.x) * (positionB.y - positionA.y);
-        float ny = (positionB.y - positionA.y) * (positionC.z - positionA.z) - (positionC.y - positionA.y) * (positionB.z - positionA.z);
-        float nz = (positionB.z - positionA.z) * (positionC.x - positionA.x) - (positionC.z - positionA.z) * (positionB.x - positionA.x);
-        // we have our normal
-        EogllObjectNormal normal;
-        normal.x = nx;
-        normal.y = ny;
-        normal.z = nz;
-        data->normals[data->numNormals++] = normal;
-        indexA.hasNormal = true;
-        indexB.hasNormal = true;
-        indexC.hasNormal = true;
-        indexA.normalIndex = data->numNormals - 1;
-        indexB.normalIndex = data->numNormals - 1;
-        indexC.normalIndex = data->numNormals - 1;
-    }
-}
\ No newline at end of file
+    }
+    free(threads);
+    free(started);
+
+    if (result != EOGLL_SUCCESS) {
+        for (unsigned int i = 0; i < numChunks; i++) {
+            if (chunks[i].result == EOGLL_SUCCESS) {
+                eogllDeleteObjectFileData(&chunks[i].data);
+                free(chunks[i].fixups);
+            }
+        }
+        free(chunks);
+        return EOGLL_FAILURE;
+    }
+
+    result = eogllObjMergeChunks(chunks, numChunks, data);
+    EOGLL_LOG_DEBUG(stdout, "Parsed object file in %u chunks\n", numChunks);
+    free(chunks);
+    if (result != EOGLL_SUCCESS) {
+        return EOGLL_FAILURE;
+    }
+    return eogllObjTriangulate(data);
+}
+
+EogllResult eogllParseObjectFileFast(const char* path, EogllObjectFileData *data) {
+    return eogllParseObjectFileParallel(path, data, 1);
+}
+
+EogllResult eogllParseObjectFileParallel(const char* path, EogllObjectFileData *data, unsigned int numThreads) {
+    EogllMappedFile file;
+    if (eogllMapFile(path, &file) != EOGLL_SUCCESS) {
+        return EOGLL_FAILURE;
+    }
+    EogllResult result = eogllParseObjectBufferParallel(file.data, file.size, data, numThreads);
+    eogllUnmapFile(&file);
+    return result;
+}
+
+void eogllDeleteObjectFileData(EogllObjectFileData *data) {
+    free(data->faces);
+    free(data->indices);
+    free(data->positions);
+    free(data->normals);
+    free(data->texCoords);
+    free(data->groups);
+    for (unsigned int i = 0; i < data->numMaterialLibraries; i++) {
+        free(data->materialLibraries[i]);
+    }
+    free(data->materialLibraries);
+    data->faces = NULL;
+    data->indices = NULL;
+    data->positions = NULL;
+    data->normals = NULL;
+    data->texCoords = NULL;
+    data->groups = NULL;
+    data->materialLibraries = NULL;
+    data->numFaces = 0;
+    data->numIndices = 0;
+    data->numGroups = 0;
+    data->numMaterialLibraries = 0;
+}
+
+// writes a single vertex for the given face index, returns the number of floats written
+static unsigned int eogllObjWriteVertex(EogllObjectFileData *data, EogllObjectAttrs* attrs, EogllObjectIndex index, float* out) {
+    EogllObjectPosition position = {0.0f, 0.0f, 0.0f, 1.0f, false};
+    EogllObjectNormal normal = {0.0f, 0.0f, 0.0f};
+    EogllObjectTexCoord texCoord = {0.0f, 0.0f, 0.0f, false, false};
+    if (index.geomIndex > 0 && index.geomIndex <= data->numPositions) {
+        position = data->positions[index.geomIndex - 1];
+    }
+    if (index.normalIndex > 0 && index.normalIndex <= data->numNormals) {
+        normal = data->normals[index.normalIndex - 1];
+    }
+    if (index.texCoordIndex > 0 && index.texCoordIndex <= data->numTexCoords) {
+        texCoord = data->texCoords[index.texCoordIndex - 1];
+    }
+    unsigned int vertexIndex = 0;
+    for (int k = 0; k < attrs->numTypes; k++) {
+        GLint num = attrs->types[k].num;
+        switch (attrs->types[k].type) {
+            case EOGLL_ATTR_POSITION: {
+                if (num == 4) {
+                    out[vertexIndex++] = position.x;
+                    out[vertexIndex++] = position.y;
+                    out[vertexIndex++] = position.z;
+                    if (position.hasW) {
+                        out[vertexIndex++] = position.w;
+                    } else {
+                        out[vertexIndex++] = 1.0f;
+                    }
+                } else if (num == 3) {
+                    out[vertexIndex++] = position.x;
+                    out[vertexIndex++] = position.y;
+                    out[vertexIndex++] = position.z;
+                } else if (num == 2) {
+                    out[vertexIndex++] = position.x;
+                    out[vertexIndex++] = position.y;
+                } else {
+                    EOGLL_LOG_WARN(stderr, "Unknown number of position components %d\n", num);
+                }
+
+            } break;
+            case EOGLL_ATTR_NORMAL: {
+                // 2 components are octahedral encoded when the vertex is packed
+                if (num != 3 && num != 2) {
+                    EOGLL_LOG_WARN(stderr, "Unknown number of normal components %d (expected 3 or 2)\n", num);
+                }
+                out[vertexIndex++] = normal.x;
+                out[vertexIndex++] = normal.y;
+                out[vertexIndex++] = normal.z;
+            } break;
+            case EOGLL_ATTR_TEXTURE: {
+                if (num == 3) {
+                    out[vertexIndex++] = texCoord.u;
+                    if (texCoord.hasV) {
+                        out[vertexIndex++] = texCoord.v;
+                    } else {
+                        EOGLL_LOG_WARN(stderr, "Texture coordinate %d has no v component\n", index.texCoordIndex);
+                        out[vertexIndex++] = 0.0f;
+                    }
+                    if (texCoord.hasW) {
+                        out[vertexIndex++] = texCoord.w;
+                    } else {
+                        EOGLL_LOG_WARN(stderr, "Texture coordinate %d has no w component\n", index.texCoordIndex);
+                        out[vertexIndex++] = 0.0f;
+                    }
+                } else if (num == 2) {
+                    out[vertexIndex++] = texCoord.u;
+                    if (texCoord.hasV) {
+                        out[vertexIndex++] = texCoord.v;
+                    } else {
+                        EOGLL_LOG_WARN(stderr, "Texture coordinate %d has no v component\n", index.texCoordIndex);
+                        out[vertexIndex++] = 0.0f;
+                    }
+                } else if (num == 1) {
+                    out[vertexIndex++] = texCoord.u;
+                } else {
+                    EOGLL_LOG_WARN(stderr, "Unknown number of texture components %d\n", num);
+                }
+            } break;
+            default:
+                EOGLL_LOG_WARN(stderr, "Unknown attribute type %d\n", attrs->types[k].type);
+                break;
+        }
+    }
+    return vertexIndex;
+}
+
+// the number of floats eogllObjWriteVertex writes for an attribute
+static unsigned int eogllObjAttrFloatCount(EogllObjectAttr attr) {
+    switch (attr.type) {
+        case EOGLL_ATTR_POSITION:
+            return attr.num >= 2 && attr.num <= 4 ? (unsigned int)attr.num : 0;
+        case EOGLL_ATTR_NORMAL:
+            return 3;
+        case EOGLL_ATTR_TEXTURE:
+            return attr.num >= 1 && attr.num <= 3 ? (unsigned int)attr.num : 0;
+        default:
+            return 0;
+    }
+}
+
+static inline bool eogllObjIsSignedIntegerType(GLenum type) {
+    return type == GL_BYTE || type == GL_SHORT || type == GL_INT || type == GL_INT_2_10_10_10_REV;
+}
+
+static inline bool eogllObjIsIntegerType(GLenum type) {
+    return eogllObjIsSignedIntegerType(type) || type == GL_UNSIGNED_BYTE || type == GL_UNSIGNED_SHORT || type == GL_UNSIGNED_INT || type == GL_UNSIGNED_INT_2_10_10_10_REV;
+}
+
+// whether every attribute is written exactly as eogllObjWriteVertex writes it
+static bool eogllObjAttrsAreFloats(const EogllObjectAttrs* attrs) {
+    for (uint32_t i = 0; i < attrs->numTypes; i++) {
+        if (attrs->builder.attribs[i].type != GL_FLOAT || (unsigned int)attrs->builder.attribs[i].num != eogllObjAttrFloatCount(attrs->types[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static uint32_t eogllObjStride(const EogllObjectAttrs* attrs) {
+    uint32_t stride = 0;
+    for (uint32_t i = 0; i < attrs->builder.numAttribs; i++) {
+        stride += (uint32_t)attrs->builder.attribs[i].size;
+    }
+    return stride;
+}
+
+// the byte offset of the position in a vertex if it is stored as 3 or more floats, -1 if not
+static int eogllObjFloatPositionOffset(const EogllObjectAttrs* attrs) {
+    int offset = 0;
+    for (uint32_t i = 0; i < attrs->numTypes; i++) {
+        if (attrs->types[i].type == EOGLL_ATTR_POSITION && attrs->builder.attribs[i].type == GL_FLOAT && attrs->builder.attribs[i].num >= 3) {
+            return offset;
+        }
+        offset += attrs->builder.attribs[i].size;
+    }
+    return -1;
+}
+
+// positions in normalized integer types are mapped from the bounding box of all positions
+static void eogllObjComputeQuantization(const EogllObjectFileData* data, const EogllObjectAttrs* attrs, EogllObjectQuantization* quantization) {
+    for (int i = 0; i < 3; i++) {
+        quantization->offset[i] = 0.0f;
+        quantization->scale[i] = 1.0f;
+    }
+    GLenum type = GL_FLOAT;
+    for (uint32_t i = 0; i < attrs->numTypes; i++) {
+        if (attrs->types[i].type == EOGLL_ATTR_POSITION && attrs->builder.attribs[i].normalized && eogllObjIsIntegerType(attrs->builder.attribs[i].type)) {
+            type = attrs->builder.attribs[i].type;
+            break;
+        }
+    }
+    if (type == GL_FLOAT || data->numPositions == 0) {
+        return;
+    }
+    float min[3] = {data->positions[0].x, data->positions[0].y, data->positions[0].z};
+    float max[3] = {min[0], min[1], min[2]};
+    for (unsigned int i = 1; i < data->numPositions; i++) {
+        const float p[3] = {data->positions[i].x, data->positions[i].y, data->positions[i].z};
+        for (int j = 0; j < 3; j++) {
+            min[j] = p[j] < min[j] ? p[j] : min[j];
+            max[j] = p[j] > max[j] ? p[j] : max[j];
+        }
+    }
+    bool isSigned = eogllObjIsSignedIntegerType(type);
+    for (int i = 0; i < 3; i++) {
+        float extent = max[i] - min[i];
+        if (extent <= 0.0f) {
+            extent = 1.0f;
+        }
+        // signed values are in [-1, 1], so they are centered on the box
+        quantization->offset[i] = isSigned ? (min[i] + max[i]) * 0.5f : min[i];
+        quantization->scale[i] = isSigned ? extent * 0.5f : extent;
+    }
+}
+
+static uint16_t eogllObjFloatToHalf(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    uint32_t floatExponent = (bits >> 23) & 0xFFu;
+    uint32_t mantissa = bits & 0x7FFFFFu;
+    if (floatExponent == 0xFF) {
+        // inf or nan
+        return (uint16_t)(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+    }
+    int32_t exponent = (int32_t)floatExponent - 127 + 15;
+    if (exponent >= 31) {
+        return (uint16_t)(sign | 0x7C00u);
+    }
+    if (exponent <= 0) {
+        // subnormal half (or zero), rounded to nearest even
+        if (exponent < -10) {
+            return (uint16_t)sign;
+        }
+        mantissa |= 0x800000u;
+        uint32_t shift = (uint32_t)(14 - exponent);
+        uint32_t half = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (half & 1))) {
+            half++;
+        }
+        return (uint16_t)(sign | half);
+    }
+    uint32_t half = sign | ((uint32_t)exponent << 10) | (mantissa >> 13);
+    uint32_t remainder = mantissa & 0x1FFFu;
+    // a carry out of the mantissa correctly bumps the exponent
+    if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1))) {
+        half++;
+    }
+    return (uint16_t)half;
+}
+
+static inline int32_t eogllObjToSigned(float value, bool normalized, int32_t max) {
+    float scaled = normalized ? (value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value)) * (float)max : value;
+    scaled = scaled < (float)(-max - 1) ? (float)(-max - 1) : (scaled > (float)max ? (float)max : scaled);
+    return (int32_t)lrintf(scaled);
+}
+
+static inline uint32_t eogllObjToUnsigned(float value, bool normalized, uint32_t max) {
+    float scaled = normalized ? (value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value)) * (float)max : value;
+    scaled = scaled < 0.0f ? 0.0f : (scaled > (float)max ? (float)max : scaled);
+    return (uint32_t)lrintf(scaled);
+}
+
+// maps a unit vector onto the octahedron and unfolds it into a square, both results are in [-1, 1]
+static void eogllObjOctahedralEncode(const float* normal, float* out) {
+    float length = fabsf(normal[0]) + fabsf(normal[1]) + fabsf(normal[2]);
+    if (length <= 0.0f) {
+        out[0] = 0.0f;
+        out[1] = 0.0f;
+        return;
+    }
+    float x = normal[0] / length;
+    float y = normal[1] / length;
+    if (normal[2] < 0.0f) {
+        float foldedX = (1.0f - fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        float foldedY = (1.0f - fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = foldedX;
+        y = foldedY;
+    }
+    out[0] = x;
+    out[1] = y;
+}
+
+// writes one attribute in its GL type, values has attribute->num components
+static void eogllObjPackAttribute(const EogllVertAttribData* attribute, const float* values, unsigned char* out) {
+    bool normalized = attribute->normalized == GL_TRUE;
+    switch (attribute->type) {
+        case GL_FLOAT:
+            memcpy(out, values, sizeof(float) * attribute->num);
+            break;
+        case GL_HALF_FLOAT:
+            for (GLint i = 0; i < attribute->num; i++) {
+                uint16_t half = eogllObjFloatToHalf(values[i]);
+                memcpy(out + i * 2, &half, sizeof(half));
+            }
+            break;
+        case GL_SHORT:
+            for (GLint i = 0; i < attribute->num; i++) {
+                int16_t value = (int16_t)eogllObjToSigned(values[i], normalized, INT16_MAX);
+                memcpy(out + i * 2, &value, sizeof(value));
+            }
+            break;
+        case GL_UNSIGNED_SHORT:
+            for (GLint i = 0; i < attribute->num; i++) {
+                uint16_t value = (uint16_t)eogllObjToUnsigned(values[i], normalized, UINT16_MAX);
+                memcpy(out + i * 2, &value, sizeof(value));
+            }
+            break;
+        case GL_BYTE:
+            for (GLint i = 0; i < attribute->num; i++) {
+                out[i] = (unsigned char)(int8_t)eogllObjToSigned(values[i], normalized, INT8_MAX);
+            }
+            break;
+        case GL_UNSIGNED_BYTE:
+            for (GLint i = 0; i < attribute->num; i++) {
+                out[i] = (unsigned char)eogllObjToUnsigned(values[i], normalized, UINT8_MAX);
+            }
+            break;
+        case GL_INT:
+            for (GLint i = 0; i < attribute->num; i++) {
+                int32_t value = (int32_t)lrintf(values[i]);
+                memcpy(out + i * 4, &value, sizeof(value));
+            }
+            break;
+        case GL_UNSIGNED_INT:
+            for (GLint i = 0; i < attribute->num; i++) {
+                uint32_t value = values[i] > 0.0f ? (uint32_t)lrintf(values[i]) : 0;
+                memcpy(out + i * 4, &value, sizeof(value));
+            }
+            break;
+        case GL_INT_2_10_10_10_REV: {
+            uint32_t packed = ((uint32_t)eogllObjToSigned(values[0], normalized, 511) & 0x3FFu) |
+                              (((uint32_t)eogllObjToSigned(values[1], normalized, 511) & 0x3FFu) << 10) |
+                              (((uint32_t)eogllObjToSigned(values[2], normalized, 511) & 0x3FFu) << 20) |
+                              (((uint32_t)eogllObjToSigned(values[3], normalized, 1) & 0x3u) << 30);
+            memcpy(out, &packed, sizeof(packed));
+        } break;
+        case GL_UNSIGNED_INT_2_10_10_10_REV: {
+            uint32_t packed = eogllObjToUnsigned(values[0], normalized, 1023) |
+                              (eogllObjToUnsigned(values[1], normalized, 1023) << 10) |
+                              (eogllObjToUnsigned(values[2], normalized, 1023) << 20) |
+                              (eogllObjToUnsigned(values[3], normalized, 3) << 30);
+            memcpy(out, &packed, sizeof(packed));
+        } break;
+        default:
+            EOGLL_LOG_WARN(stderr, "Can't pack vertex attribute type %d\n", attribute->type);
+            memset(out, 0, attribute->size);
+            break;
+    }
+}
+
+// converts the floats of one vertex (as written by eogllObjWriteVertex) into the types of attrs, returns the bytes written
+static unsigned int eogllObjPackVertex(const EogllObjectAttrs* attrs, const EogllObjectQuantization* quantization, const float* vertex, unsigned char* out) {
+    unsigned int written = 0;
+    for (uint32_t k = 0; k < attrs->numTypes; k++) {
+        const EogllVertAttribData* attribute = &attrs->builder.attribs[k];
+        EogllObjectAttr attr = attrs->types[k];
+        unsigned int count = eogllObjAttrFloatCount(attr);
+        float values[4];
+        for (GLint i = 0; i < attribute->num && i < 4; i++) {
+            if ((unsigned int)i < count) {
+                values[i] = vertex[i];
+            } else {
+                values[i] = attr.type == EOGLL_ATTR_POSITION && i == 3 ? 1.0f : 0.0f;
+            }
+        }
+        // test the requested count, the builder pads byte normals to 4 components
+        if (attr.type == EOGLL_ATTR_NORMAL && attr.num == 2) {
+            eogllObjOctahedralEncode(vertex, values);
+            values[2] = 0.0f;
+            values[3] = 0.0f;
+        } else if (attr.type == EOGLL_ATTR_POSITION && attribute->normalized && eogllObjIsIntegerType(attribute->type)) {
+            for (unsigned int i = 0; i < 3 && i < count; i++) {
+                values[i] = (values[i] - quantization->offset[i]) / quantization->scale[i];
+            }
+        }
+        eogllObjPackAttribute(attribute, values, out + written);
+        vertex += count;
+        written += (unsigned int)attribute->size;
+    }
+    return written;
+}
+
+// writes a single vertex for the given face index in the types of attrs, returns the number of bytes written
+static unsigned int eogllObjEmitVertex(EogllObjectFileData *data, EogllObjectAttrs* attrs, const EogllObjectQuantization* quantization, bool floatsOnly, EogllObjectIndex index, unsigned char* out) {
+    if (floatsOnly) {
+        return eogllObjWriteVertex(data, attrs, index, (float*)out) * (unsigned int)sizeof(float);
+    }
+    // at most 8 attributes of at most 4 components
+    float vertex[32];
+    eogllObjWriteVertex(data, attrs, index, vertex);
+    return eogllObjPackVertex(attrs, quantization, vertex, out);
+}
+
+static inline uint32_t eogllObjHashIndex(EogllObjectIndex index) {
+    uint32_t h = index.geomIndex * 0x9E3779B1u;
+    h ^= index.texCoordIndex * 0x85EBCA77u + (h << 6) + (h >> 2);
+    h ^= index.normalIndex * 0xC2B2AE3Du + (h << 6) + (h >> 2);
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    h ^= h >> 12;
+    return h;
+}
+
+// whether normals were requested, but the obj file does not have them
+static bool eogllObjNeedsNormals(const EogllObjectFileData* data, const EogllObjectAttrs* attrs) {
+    bool attrHasNormal = false;
+    for (int i = 0; i < attrs->numTypes; i++) {
+        if (attrs->types[i].type == EOGLL_ATTR_NORMAL) {
+            attrHasNormal = true;
+            break;
+        }
+    }
+    return attrHasNormal && data->numFaces > 0 && (data->numNormals == 0 || data->indices[data->faces[0].firstIndex].hasNormal == false);
+}
+
+EogllResult eogllObjectFileDataToVertices(EogllObjectFileData *data, EogllObjectAttrs attrs, float** vertices, uint32_t* numVertices, unsigned int** indices, uint32_t* numIndices) {
+    return eogllObjectFileDataToVerticesEx(data, attrs, vertices, numVertices, indices, numIndices, NULL);
+}
+
+EogllResult eogllObjectFileDataToVerticesEx(EogllObjectFileData *data, EogllObjectAttrs attrs, float** vertices, uint32_t* numVertices, unsigned int** indices, uint32_t* numIndices, EogllObjectQuantization* quantization) {
+    // every face corner is an (position, texcoord, normal) index triple, corners with the same triple
+    // become the same vertex. A hash table from the triple to the vertex number welds them together,
+    // so we get a compact vertex array and a real index buffer.
+
+    if (eogllObjNeedsNormals(data, &attrs)) {
+        // we will do some calculations to approximate them
+        if (eogllGenerateNormalsEx(data, EOGLL_OBJ_NORMALS_SMOOTH) != EOGLL_SUCCESS) {
+            return EOGLL_FAILURE;
+        }
+    }
+
+    // first we need to calculate the number of face corners
+    uint32_t numCorners = 0;
+    for (int i = 0; i < data->numFaces; i++) {
+        numCorners += data->faces[i].numIndices;
+    }
+    *numIndices = numCorners;
+
+    // vertices are written in the types of attrs, so the stride is in bytes
+    uint32_t stride = eogllObjStride(&attrs);
+    bool floatsOnly = eogllObjAttrsAreFloats(&attrs);
+    EogllObjectQuantization vertexQuantization;
+    eogllObjComputeQuantization(data, &attrs, &vertexQuantization);
+    if (quantization) {
+        *quantization = vertexQuantization;
+    }
+
+    // the table is kept at most half full
+    uint32_t tableSize = 16;
+    while (tableSize < numCorners * 2) {
+        tableSize *= 2;
+    }
+    uint32_t mask = tableSize - 1;
+    uint32_t* table = (uint32_t*)malloc(sizeof(uint32_t) * tableSize);
+    EogllObjectIndex* keys = (EogllObjectIndex*)malloc(sizeof(EogllObjectIndex) * (numCorners ? numCorners : 1));
+    unsigned char* vertexData = (unsigned char*)malloc((size_t)(numCorners ? numCorners : 1) * (stride ? stride : 1));
+    *vertices = (float*)vertexData;
+    *indices = (unsigned int*)malloc(sizeof(unsigned int) * (numCorners ? numCorners : 1));
+    if (!table || !keys || !*vertices || !*indices) {
+        EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for object vertices\n");
+        free(table);
+        free(keys);
+        free(*vertices);
+        free(*indices);
+        *vertices = NULL;
+        *indices = NULL;
+        return EOGLL_FAILURE;
+    }
+    memset(table, 0xFF, sizeof(uint32_t) * tableSize);
+
+    uint32_t numUnique = 0;
+    uint32_t corner = 0;
+    for (int i = 0; i < data->numFaces; i++) {
+        for (int j = 0; j < data->faces[i].numIndices; j++) {
+            EogllObjectIndex index = data->indices[data->faces[i].firstIndex + j];
+            uint32_t slot = eogllObjHashIndex(index) & mask;
+            while (table[slot] != UINT32_MAX) {
+                EogllObjectIndex other = keys[table[slot]];
+                if (other.geomIndex == index.geomIndex && other.texCoordIndex == index.texCoordIndex && other.normalIndex == index.normalIndex) {
+                    break;
+                }
+                slot = (slot + 1) & mask;
+            }
+            if (table[slot] == UINT32_MAX) {
+                // at most 8 attributes of at most 4 components of at most 4 bytes
+                float vertex[32];
+                unsigned int written = eogllObjEmitVertex(data, &attrs, &vertexQuantization, floatsOnly, index, (unsigned char*)vertex);
+                if (written > stride) {
+                    EOGLL_LOG_ERROR(stderr, "Vertex %u is %u bytes, but the attributes only have %u\n", numUnique, written, stride);
+                    free(table);
+                    free(keys);
+                    free(*vertices);
+                    free(*indices);
+                    *vertices = NULL;
+                    *indices = NULL;
+                    return EOGLL_FAILURE;
+                }
+                memcpy(vertexData + (size_t)numUnique * stride, vertex, written);
+                keys[numUnique] = index;
+                table[slot] = numUnique++;
+            }
+            (*indices)[corner++] = table[slot];
+        }
+    }
+    free(table);
+    free(keys);
+
+    *numVertices = numUnique;
+    if (numUnique > 0 && numUnique < numCorners) {
+        float* shrunk = (float*)realloc(*vertices, (size_t)numUnique * stride);
+        if (shrunk) {
+            *vertices = shrunk;
+        }
+    }
+
+    EOGLL_LOG_DEBUG(stdout, "Welded %u face corners into %u vertices (%zu VBO bytes saved)\n", numCorners, numUnique, (size_t)(numCorners - numUnique) * stride);
+    return EOGLL_SUCCESS;
+}
+
+//void eogllPrintObjectData(EogllObjectFileData* data) {
+//    printf("Positions:\n");
+//    for (int i = 0; i < data->numPositions; i++) {
+//        printf("%f %f %f %f\n", data->positions[i].x, data->positions[i].y, data->positions[i].z, data->positions[i].w);
+//    }
+//    printf("Normals:\n");
+//    for (int i = 0; i < data->numNormals; i++) {
+//        printf("%f %f %f\n", data->normals[i].x, data->normals[i].y, data->normals[i].z);
+//    }
+//    printf("Texture Coordinates:\n");
+//    for (int i = 0; i < data->numTexCoords; i++) {
+//        printf("%f %f %f\n", data->texCoords[i].u, data->texCoords[i].v, data->texCoords[i].w);
+//    }
+//    printf("Faces:\n");
+//    for (int i = 0; i < data->numFaces; i++) {
+//        printf("Face %d:\n", i);
+//        for (int j = 0; j < data->faces[i].numIndices; j++) {
+//            EogllObjectIndex index = data->indices[data->faces[i].firstIndex + j];
+//            printf("%d/%d/%d ", index.geomIndex, index.texCoordIndex, index.normalIndex);
+//        }
+//        printf("\n");
+//    }
+//}
+
+EogllResult eogllLoadObjectFile(const char* path, EogllObjectAttrs attrs, float** vertices, uint32_t* numVertices, unsigned int** indices, uint32_t* numIndices) {
+    EogllObjectLoadOptions options = eogllDefaultObjectLoadOptions();
+    return eogllLoadObjectFileEx(path, attrs, &options, vertices, numVertices, indices, numIndices, NULL);
+}
+
+// parses the object file with the parser the options ask for and generates normals if the attributes need them
+static EogllResult eogllObjParseWithOptions(const char* path, const EogllObjectAttrs* attrs, const EogllObjectLoadOptions* options, EogllObjectFileData* data, const char** parserName) {
+    if (options->parseMode == EOGLL_OBJ_PARSE_LEGACY) {
+        *parserName = "legacy";
+        FILE* file = fopen(path, "r");
+        if (!file) {
+            EOGLL_LOG_ERROR(stderr, "Failed to open file %s\n", path);
+            return EOGLL_FAILURE;
+        }
+        EogllResult result = eogllParseObjectFile(file, data);
+        fclose(file);
+        if (result != EOGLL_SUCCESS) {
+            EOGLL_LOG_ERROR(stderr, "Failed to parse object file %s\n", path);
+            return EOGLL_FAILURE;
+        }
+    } else {
+        *parserName = options->numThreads == 1 ? "fast" : "parallel";
+        if (eogllParseObjectFileParallel(path, data, options->numThreads) != EOGLL_SUCCESS) {
+            EOGLL_LOG_ERROR(stderr, "Failed to parse object file %s\n", path);
+            return EOGLL_FAILURE;
+        }
+    }
+
+    EOGLL_LOG_DEBUG(stdout, "Parsed object file %s\n", path);
+
+    if (eogllObjNeedsNormals(data, attrs) && eogllGenerateNormalsEx(data, options->normalMode) != EOGLL_SUCCESS) {
+        EOGLL_LOG_ERROR(stderr, "Failed to generate normals for %s\n", path);
+        eogllDeleteObjectFileData(data);
+        return EOGLL_FAILURE;
+    }
+    return EOGLL_SUCCESS;
+}
+
+EogllResult eogllLoadObjectFileEx(const char* path, EogllObjectAttrs attrs, const EogllObjectLoadOptions* options, float** vertices, uint32_t* numVertices, unsigned int** indices, uint32_t* numIndices, EogllObjectQuantization* quantization) {
+    double start = eogllGetTime();
+    EogllObjectFileData data;
+    const char* parserName;
+    if (eogllObjParseWithOptions(path, &attrs, options, &data, &parserName) != EOGLL_SUCCESS) {
+        return EOGLL_FAILURE;
+    }
+
+    double middle = eogllGetTime();
+
+    if (eogllObjectFileDataToVerticesEx(&data, attrs, vertices, numVertices, indices, numIndices, quantization) != EOGLL_SUCCESS) {
+        EOGLL_LOG_ERROR(stderr, "Failed to convert object file data to vertices\n");
+        eogllDeleteObjectFileData(&data);
+        return EOGLL_FAILURE;
+    }
+
+    double end = eogllGetTime();
+
+    if (options->optimizeMesh) {
+        EogllVertexCacheStats before = eogllAnalyzeVertexCache(*indices, *numIndices, *numVertices, EOGLL_VERTEX_CACHE_SIZE);
+        if (eogllOptimizeMesh(*vertices, numVertices, eogllObjStride(&attrs), eogllObjFloatPositionOffset(&attrs), *indices, *numIndices) != EOGLL_SUCCESS) {
+            EOGLL_LOG_WARN(stderr, "Failed to optimize %s, keeping the original order\n", path);
+        } else {
+            EogllVertexCacheStats after = eogllAnalyzeVertexCache(*indices, *numIndices, *numVertices, EOGLL_VERTEX_CACHE_SIZE);
+            EOGLL_LOG_DEBUG(stdout, "Optimized in %f seconds, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", eogllGetTime() - end, before.acmr, after.acmr, before.atvr, after.atvr);
+        }
+    }
+
+    eogllDeleteObjectFileData(&data);
+
+    EOGLL_LOG_DEBUG(stdout, "Object Loaded.\n");
+    EOGLL_LOG_DEBUG(stdout, "Num vertices: %d\n", *numVertices);
+    EOGLL_LOG_DEBUG(stdout, "Parsed in %f seconds (%s parser)\n", middle - start, parserName);
+    EOGLL_LOG_DEBUG(stdout, "Converted in %f seconds\n", end - middle);
+    EOGLL_LOG_DEBUG(stdout, "Peak resident memory: %zu KB\n", eogllGetPeakMemoryUsage() / 1024);
+
+    return EOGLL_SUCCESS;
+
+}
+
+GLenum eogllObjNarrowIndices(unsigned int* indices, uint32_t numIndices, uint32_t numVertices, GLsizeiptr* indicesSize) {
+    if (numVertices > UINT16_MAX + 1) {
+        *indicesSize = (GLsizeiptr)sizeof(unsigned int) * numIndices;
+        return GL_UNSIGNED_INT;
+    }
+    uint16_t* shortIndices = (uint16_t*)indices;
+    for (uint32_t i = 0; i < numIndices; i++) {
+        shortIndices[i] = (uint16_t)indices[i];
+    }
+    *indicesSize = (GLsizeiptr)sizeof(uint16_t) * numIndices;
+    EOGLL_LOG_DEBUG(stdout, "Using 16 bit indices (%zu EBO bytes saved)\n", (size_t)numIndices * (sizeof(unsigned int) - sizeof(uint16_t)));
+    return GL_UNSIGNED_SHORT;
+}
+
+// uploads the vertices and indices into a new buffer object and frees them
+static EogllBufferObject eogllObjUpload(EogllObjectAttrs* attrs, GLenum usage, float* vertices, uint32_t numVertices, unsigned int* indices, GLsizeiptr indicesSize, GLenum indicesType, const EogllObjectQuantization* quantization) {
+    unsigned int vao = eogllGenVertexArray();
+    unsigned int vbo = eogllGenBuffer(vao, GL_ARRAY_BUFFER, (GLsizeiptr)eogllObjStride(attrs) * numVertices, vertices, usage);
+    unsigned int ebo = eogllGenBuffer(vao, GL_ELEMENT_ARRAY_BUFFER, indicesSize, indices, usage);
+    eogllBuildAttributes(&attrs->builder, vao);
+    free(vertices);
+    free(indices);
+    EogllBufferObject bufferObject = eogllCreateBufferObject(vao, vbo, ebo, indicesSize, indicesType);
+    memcpy(bufferObject.positionOffset, quantization->offset, sizeof(quantization->offset));
+    memcpy(bufferObject.positionScale, quantization->scale, sizeof(quantization->scale));
+    return bufferObject;
+}
+
+EogllBufferObject eogllLoadBufferObject(const char* path, EogllObjectAttrs attrs, GLenum usage) {
+    EogllObjectLoadOptions options = eogllDefaultObjectLoadOptions();
+    return eogllLoadBufferObjectEx(path, attrs, usage, &options);
+}
+
+EogllBufferObject eogllLoadBufferObjectEx(const char* path, EogllObjectAttrs attrs, GLenum usage, const EogllObjectLoadOptions* options) {
+    char* cachePath = NULL;
+    uint64_t sourceTime = 0;
+    uint64_t sourceSize = 0;
+    if (options->useCache && eogllGetFileInfo(path, &sourceTime, &sourceSize) == EOGLL_SUCCESS) {
+        cachePath = eogllGetMeshCachePath(path);
+        EogllBufferObject bufferObject;
+        double start = eogllGetTime();
+        if (cachePath && eogllLoadMeshCacheIfFresh(cachePath, path, attrs, options, usage, &bufferObject) == EOGLL_SUCCESS) {
+            EOGLL_LOG_DEBUG(stdout, "Loaded %s from mesh cache in %f seconds\n", path, eogllGetTime() - start);
+            free(cachePath);
+            return bufferObject;
+        }
+    }
+    if (options->streamBudget > 0) {
+        // there is never a whole vertex array to write a cache from
+        free(cachePath);
+        return eogllLoadBufferObjectStreamed(path, attrs, usage, options);
+    }
+
+    float* vertices;
+    unsigned int* indices;
+    uint32_t numVertices;
+    uint32_t numIndices;
+    EogllObjectQuantization quantization;
+    if (eogllLoadObjectFileEx(path, attrs, options, &vertices, &numVertices, &indices, &numIndices, &quantization) != EOGLL_SUCCESS) {
+        EOGLL_LOG_ERROR(stderr, "Failed to load object %s\n", path);
+        free(cachePath);
+        return (EogllBufferObject){0};
+    }
+    GLsizeiptr indicesSize;
+    GLenum indicesType = eogllObjNarrowIndices(indices, numIndices, numVertices, &indicesSize);
+
+    if (cachePath) {
+        // a failed write only costs us the next startup, so it isn't an error
+        if (eogllWriteMeshCache(cachePath, attrs, vertices, numVertices, indices, numIndices, indicesType, &quantization, options, sourceTime, sourceSize) != EOGLL_SUCCESS) {
+            EOGLL_LOG_WARN(stderr, "Failed to write mesh cache for %s\n", path);
+        }
+        free(cachePath);
+    }
+
+    return eogllObjUpload(&attrs, usage, vertices, numVertices, indices, indicesSize, indicesType, &quantization);
+}
+
+// groups the faces (in place, keeping their order within a material) so every material is one contiguous range
+static EogllResult eogllObjGroupFacesByMaterial(EogllObjectFileData* data, const EogllMaterialLibrary* library, const char* path, EogllDrawRange** ranges, uint32_t* numRanges) {
+    // key 0 is for faces without a (known) material, key i + 1 for material i
+    uint32_t numKeys = library->numMaterials + 1;
+    uint32_t* starts = (uint32_t*)calloc(numKeys + 1, sizeof(uint32_t));
+    uint32_t* groupKeys = (uint32_t*)malloc(sizeof(uint32_t) * (data->numGroups ? data->numGroups : 1));
+    EogllObjectFileFace* faces = (EogllObjectFileFace*)malloc(sizeof(EogllObjectFileFace) * (data->numFaces ? data->numFaces : 1));
+    *ranges = (EogllDrawRange*)malloc(sizeof(EogllDrawRange) * numKeys);
+    if (!starts || !groupKeys || !faces || !*ranges) {
+        EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for material ranges\n");
+        free(starts);
+        free(groupKeys);
+        free(faces);
+        free(*ranges);
+        *ranges = NULL;
+        return EOGLL_FAILURE;
+    }
+
+    if (data->numGroups == 0) {
+        starts[1] = data->numFaces;
+    }
+    for (unsigned int i = 0; i < data->numGroups; i++) {
+        int material = eogllFindMaterial(library, data->groups[i].material);
+        if (material < 0 && data->groups[i].material[0] != '\0') {
+            EOGLL_LOG_WARN(stderr, "Material %s used by %s isn't in any material library\n", data->groups[i].material, path);
+        }
+        groupKeys[i] = (uint32_t)(material + 1);
+        starts[groupKeys[i] + 1] += data->groups[i].numFaces;
+    }
+    *numRanges = 0;
+    for (uint32_t key = 0; key < numKeys; key++) {
+        uint32_t count = starts[key + 1];
+        starts[key + 1] = starts[key] + count;
+        if (count > 0) {
+            // every face is a triangle by now
+            EogllDrawRange range = {starts[key] * 3, count * 3, (int)key - 1, 0};
+            (*ranges)[(*numRanges)++] = range;
+        }
+    }
+
+    if (data->numGroups > 0) {
+        for (unsigned int i = 0; i < data->numGroups; i++) {
+            uint32_t* next = &starts[groupKeys[i]];
+            memcpy(faces + *next, data->faces + data->groups[i].firstFace, sizeof(EogllObjectFileFace) * data->groups[i].numFaces);
+            *next += data->groups[i].numFaces;
+        }
+        free(data->faces);
+        data->faces = faces;
+    } else {
+        free(faces);
+    }
+    free(starts);
+    free(groupKeys);
+    return EOGLL_SUCCESS;
+}
+
+// optimizes the index order of one range in a vertex space of only the vertices it uses, so it costs the size of the range and not of the mesh
+// localIndex has an entry per vertex of the mesh that is UINT32_MAX and is left that way, globalIndex and positions have room for numIndices vertices
+static EogllResult eogllObjOptimizeRange(unsigned int* indices, uint32_t numIndices, const unsigned char* vertices, uint32_t stride, int positionOffset, uint32_t* localIndex, uint32_t* globalIndex, float* positions) {
+    uint32_t numLocal = 0;
+    for (uint32_t i = 0; i < numIndices; i++) {
+        unsigned int vertex = indices[i];
+        if (localIndex[vertex] == UINT32_MAX) {
+            localIndex[vertex] = numLocal;
+            globalIndex[numLocal] = vertex;
+            if (positionOffset >= 0) {
+                memcpy(positions + numLocal * 3, vertices + (size_t)vertex * stride + positionOffset, sizeof(float) * 3);
+            }
+            numLocal++;
+        }
+        indices[i] = localIndex[vertex];
+    }
+
+    EogllResult result = eogllOptimizeVertexCache(indices, numIndices, numLocal, EOGLL_VERTEX_CACHE_SIZE);
+    if (result == EOGLL_SUCCESS && positionOffset >= 0) {
+        result = eogllOptimizeOverdraw(indices, numIndices, positions, sizeof(float) * 3, numLocal, EOGLL_VERTEX_CACHE_SIZE, EOGLL_OVERDRAW_THRESHOLD);
+    }
+
+    // the passes leave the indices valid when they fail, so they always go back to the mesh's vertices
+    for (uint32_t i = 0; i < numIndices; i++) {
+        indices[i] = globalIndex[indices[i]];
+    }
+    for (uint32_t i = 0; i < numLocal; i++) {
+        localIndex[globalIndex[i]] = UINT32_MAX;
+    }
+    return result;
+}
+
+EogllRangedBufferObject eogllLoadRangedBufferObject(const char* path, EogllObjectAttrs attrs, GLenum usage, const EogllObjectLoadOptions* options, EogllMaterialLibrary* materials) {
+    EogllRangedBufferObject empty = {0};
+    double start = eogllGetTime();
+    EogllObjectFileData data;
+    const char* parserName;
+    if (eogllObjParseWithOptions(path, &attrs, options, &data, &parserName) != EOGLL_SUCCESS) {
+        return empty;
+    }
+
+    // without a library to fill, the materials are only read to group the faces
+    EogllMaterialLibrary ownLibrary = eogllCreateMaterialLibrary();
+    EogllMaterialLibrary* library = materials ? materials : &ownLibrary;
+    for (unsigned int i = 0; i < data.numMaterialLibraries; i++) {
+        char libraryPath[EOGLL_MATERIAL_PATH_SIZE];
+        if (eogllResolveRelativePath(path, data.materialLibraries[i], libraryPath, sizeof(libraryPath)) != EOGLL_SUCCESS ||
+            eogllParseMaterialFile(libraryPath, library) != EOGLL_SUCCESS) {
+            // the faces still load, just without the materials of this library
+            EOGLL_LOG_WARN(stderr, "Failed to read material library %s of %s\n", data.materialLibraries[i], path);
+        }
+    }
+
+    EogllDrawRange* ranges;
+    uint32_t numRanges;
+    EogllResult result = eogllObjGroupFacesByMaterial(&data, library, path, &ranges, &numRanges);
+    eogllDeleteMaterialLibrary(&ownLibrary);
+    if (result != EOGLL_SUCCESS) {
+        eogllDeleteObjectFileData(&data);
+        return empty;
+    }
+
+    float* vertices;
+    unsigned int* indices;
+    uint32_t numVertices;
+    uint32_t numIndices;
+    EogllObjectQuantization quantization;
+    result = eogllObjectFileDataToVerticesEx(&data, attrs, &vertices, &numVertices, &indices, &numIndices, &quantization);
+    eogllDeleteObjectFileData(&data);
+    if (result != EOGLL_SUCCESS) {
+        EOGLL_LOG_ERROR(stderr, "Failed to convert object file data to vertices\n");
+        free(ranges);
+        return empty;
+    }
+
+    if (options->optimizeMesh) {
+        // triangles can't move between ranges, so the index order is optimized one range at a time
+        uint32_t stride = eogllObjStride(&attrs);
+        int positionOffset = eogllObjFloatPositionOffset(&attrs);
+        uint32_t largestRange = 0;
+        for (uint32_t i = 0; i < numRanges; i++) {
+            largestRange = ranges[i].numIndices > largestRange ? ranges[i].numIndices : largestRange;
+        }
+        uint32_t* localIndex = (uint32_t*)malloc(sizeof(uint32_t) * (numVertices > 0 ? numVertices : 1));
+        uint32_t* globalIndex = (uint32_t*)malloc(sizeof(uint32_t) * (largestRange > 0 ? largestRange : 1));
+        float* positions = (float*)malloc(sizeof(float) * 3 * (largestRange > 0 ? largestRange : 1));
+        result = localIndex && globalIndex && positions ? EOGLL_SUCCESS : EOGLL_FAILURE;
+        if (localIndex) {
+            memset(localIndex, 0xFF, sizeof(uint32_t) * numVertices);
+        }
+        for (uint32_t i = 0; i < numRanges && result == EOGLL_SUCCESS; i++) {
+            result = eogllObjOptimizeRange(indices + ranges[i].firstIndex, ranges[i].numIndices, (const unsigned char*)vertices, stride, positionOffset, localIndex, globalIndex, positions);
+        }
+        free(localIndex);
+        free(globalIndex);
+        free(positions);
+        if (result == EOGLL_SUCCESS) {
+            result = eogllOptimizeVertexFetch(vertices, &numVertices, stride, indices, numIndices);
+        }
+        if (result != EOGLL_SUCCESS) {
+            EOGLL_LOG_WARN(stderr, "Failed to optimize %s\n", path);
+        }
+    }
+
+    GLsizeiptr indicesSize;
+    GLenum indicesType = eogllObjNarrowIndices(indices, numIndices, numVertices, &indicesSize);
+    EogllBufferObject buffer = eogllObjUpload(&attrs, usage, vertices, numVertices, indices, indicesSize, indicesType, &quantization);
+    EogllRangedBufferObject bufferObject = eogllCreateRangedBufferObject(buffer, ranges, numRanges);
+    free(ranges);
+    EOGLL_LOG_DEBUG(stdout, "Loaded %s with %u material ranges in %f seconds (%s parser)\n", path, numRanges, eogllGetTime() - start, parserName);
+    return bufferObject;
+}
+
+// unit normal of a triangle, zero if it is degenerate or references missing positions
+static void eogllObjTriangleNormal(const EogllObjectFileData* data, const EogllObjectIndex* corners, EogllObjectNormal* normal) {
+    normal->x = 0.0f;
+    normal->y = 0.0f;
+    normal->z = 0.0f;
+    if (corners[0].geomIndex - 1 >= data->numPositions || corners[1].geomIndex - 1 >= data->numPositions || corners[2].geomIndex - 1 >= data->numPositions) {
+        return;
+    }
+    const EogllObjectPosition* a = &data->positions[corners[0].geomIndex - 1];
+    const EogllObjectPosition* b = &data->positions[corners[1].geomIndex - 1];
+    const EogllObjectPosition* c = &data->positions[corners[2].geomIndex - 1];
+    // cross(b - a, c - a)
+    float e1x = b->x - a->x, e1y = b->y - a->y, e1z = b->z - a->z;
+    float e2x = c->x - a->x, e2y = c->y - a->y, e2z = c->z - a->z;
+    float nx = e1y * e2z - e1z * e2y;
+    float ny = e1z * e2x - e1x * e2z;
+    float nz = e1x * e2y - e1y * e2x;
+    float length = sqrtf(nx * nx + ny * ny + nz * nz);
+    float scale = length > 0.0f ? 1.0f / length : 0.0f;
+    normal->x = nx * scale;
+    normal->y = ny * scale;
+    normal->z = nz * scale;
+}
+
+// flat: one normal per triangle
+static EogllResult eogllObjGenerateFlatNormals(EogllObjectFileData* data) {
+    EogllObjectNormal* normals = (EogllObjectNormal*)malloc(sizeof(EogllObjectNormal) * (data->numFaces ? data->numFaces : 1));
+    if (!normals) {
+        EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for normals\n");
+        return EOGLL_FAILURE;
+    }
+    for (unsigned int i = 0; i < data->numFaces; i++) {
+        EogllObjectIndex* corners = &data->indices[data->faces[i].firstIndex];
+        eogllObjTriangleNormal(data, corners, &normals[i]);
+        for (unsigned int j = 0; j < 3; j++) {
+            corners[j].normalIndex = i + 1;
+            corners[j].hasNormal = true;
+        }
+    }
+    free(data->normals);
+    data->normals = normals;
+    data->numNormals = data->numFaces;
+    return EOGLL_SUCCESS;
+}
+
+static inline float eogllObjCornerAngle(float ux, float uy, float uz, float vx, float vy, float vz) {
+    float lengths = sqrtf((ux * ux + uy * uy + uz * uz) * (vx * vx + vy * vy + vz * vz));
+    if (lengths <= 0.0f) {
+        return 0.0f;
+    }
+    float cosine = (ux * vx + uy * vy + uz * vz) / lengths;
+    cosine = cosine > 1.0f ? 1.0f : (cosine < -1.0f ? -1.0f : cosine);
+    return acosf(cosine);
+}
+
+/*
+ * Smooth normals are the sum of the unit normals of the triangles around a position weighted by the corner angle.
+ * The sums are kept as separate x, y and z arrays of numPositions floats each so the normalize loop vectorizes.
+ */
+static void eogllObjAccumulateSmoothNormal(const EogllObjectFileData* data, const EogllObjectIndex* corners, float* sumX, float* sumY, float* sumZ) {
+    unsigned int ia = corners[0].geomIndex - 1;
+    unsigned int ib = corners[1].geomIndex - 1;
+    unsigned int ic = corners[2].geomIndex - 1;
+    if (ia >= data->numPositions || ib >= data->numPositions || ic >= data->numPositions) {
+        return;
+    }
+    const EogllObjectPosition* a = &data->positions[ia];
+    const EogllObjectPosition* b = &data->positions[ib];
+    const EogllObjectPosition* c = &data->positions[ic];
+    float abx = b->x - a->x, aby = b->y - a->y, abz = b->z - a->z;
+    float acx = c->x - a->x, acy = c->y - a->y, acz = c->z - a->z;
+    float bcx = c->x - b->x, bcy = c->y - b->y, bcz = c->z - b->z;
+    float nx = aby * acz - abz * acy;
+    float ny = abz * acx - abx * acz;
+    float nz = abx * acy - aby * acx;
+    float length = sqrtf(nx * nx + ny * ny + nz * nz);
+    if (length <= 0.0f) {
+        return;
+    }
+    nx /= length;
+    ny /= length;
+    nz /= length;
+    float angleA = eogllObjCornerAngle(abx, aby, abz, acx, acy, acz);
+    float angleB = eogllObjCornerAngle(-abx, -aby, -abz, bcx, bcy, bcz);
+    float angleC = 3.14159265f - angleA - angleB;
+    if (angleC < 0.0f) {
+        angleC = 0.0f;
+    }
+    sumX[ia] += nx * angleA;
+    sumY[ia] += ny * angleA;
+    sumZ[ia] += nz * angleA;
+    sumX[ib] += nx * angleB;
+    sumY[ib] += ny * angleB;
+    sumZ[ib] += nz * angleB;
+    sumX[ic] += nx * angleC;
+    sumY[ic] += ny * angleC;
+    sumZ[ic] += nz * angleC;
+}
+
+// normalizes the sums and replaces the normals of data with them (one per position), sums is freed
+static EogllResult eogllObjFinishSmoothNormals(EogllObjectFileData* data, float* sums) {
+    unsigned int count = data->numPositions;
+    float* sumX = sums;
+    float* sumY = sums + count;
+    float* sumZ = sums + (size_t)count * 2;
+    for (unsigned int i = 0; i < count; i++) {
+        float length = sqrtf(sumX[i] * sumX[i] + sumY[i] * sumY[i] + sumZ[i] * sumZ[i]);
+        float scale = length > 0.0f ? 1.0f / length : 0.0f;
+        sumX[i] *= scale;
+        sumY[i] *= scale;
+        sumZ[i] *= scale;
+    }
+    EogllObjectNormal* normals = (EogllObjectNormal*)malloc(sizeof(EogllObjectNormal) * (count ? count : 1));
+    if (!normals) {
+        EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for normals\n");
+        free(sums);
+        return EOGLL_FAILURE;
+    }
+    for (unsigned int i = 0; i < count; i++) {
+        normals[i].x = sumX[i];
+        normals[i].y = sumY[i];
+        normals[i].z = sumZ[i];
+    }
+    free(sums);
+    free(data->normals);
+    data->normals = normals;
+    data->numNormals = count;
+    return EOGLL_SUCCESS;
+}
+
+// smooth: one normal per position
+static EogllResult eogllObjGenerateSmoothNormals(EogllObjectFileData* data) {
+    unsigned int count = data->numPositions;
+    float* sums = (float*)calloc((size_t)(count ? count : 1) * 3, sizeof(float));
+    if (!sums) {
+        EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for normals\n");
+        return EOGLL_FAILURE;
+    }
+    for (unsigned int i = 0; i < data->numFaces; i++) {
+        eogllObjAccumulateSmoothNormal(data, &data->indices[data->faces[i].firstIndex], sums, sums + count, sums + (size_t)count * 2);
+    }
+    if (eogllObjFinishSmoothNormals(data, sums) != EOGLL_SUCCESS) {
+        return EOGLL_FAILURE;
+    }
+    for (unsigned int i = 0; i < data->numIndices; i++) {
+        EogllObjectIndex* corner = &data->indices[i];
+        corner->hasNormal = corner->geomIndex - 1 < data->numPositions;
+        corner->normalIndex = corner->hasNormal ? corner->geomIndex : 0;
+    }
+    return EOGLL_SUCCESS;
+}
+
+EogllResult eogllGenerateNormalsEx(EogllObjectFileData *data, EogllObjectNormalMode mode) {
+    for (unsigned int i = 0; i < data->numFaces; i++) {
+        if (data->faces[i].numIndices != 3) {
+            EOGLL_LOG_ERROR(stderr, "Face %u has %u indices, normals can only be generated for triangles\n", i, data->faces[i].numIndices);
+            return EOGLL_FAILURE;
+        }
+    }
+    double start = eogllGetTime();
+    EogllResult result = mode == EOGLL_OBJ_NORMALS_FLAT ? eogllObjGenerateFlatNormals(data) : eogllObjGenerateSmoothNormals(data);
+    EOGLL_LOG_DEBUG(stdout, "Generated %u %s normals in %f seconds\n", data->numNormals, mode == EOGLL_OBJ_NORMALS_FLAT ? "flat" : "smooth", eogllGetTime() - start);
+    return result;
+}
+
+void eogllGenerateNormals(EogllObjectFileData *data) {
+    if (eogllGenerateNormalsEx(data, EOGLL_OBJ_NORMALS_SMOOTH) != EOGLL_SUCCESS) {
+        EOGLL_LOG_ERROR(stderr, "Failed to generate normals\n");
+    }
+}
+
+/*
+ * The streaming loader never builds faces or a vertex array for the whole file.
+ * Pass 1 keeps the positions, normals and texture coordinates and counts the triangles, the next pass walks the
+ * faces again and hands every triangle to a callback (smooth normals need one more pass to sum them up first).
+ * The file is mapped and the parts that were read are released as we go.
+ */
+typedef void (*EogllObjTriangleFunc)(EogllObjectFileData* data, EogllObjectIndex* triangle, void* user);
+
+typedef struct EogllObjStream {
+    EogllMappedFile file;
+    // only the attributes, faces and indices are never filled in
+    EogllObjectFileData data;
+    size_t releaseInterval;
+    uint64_t numTriangles;
+    bool firstFaceHasNormal;
+    // scratch space for one polygon
+    EogllObjectIndex* polygon;
+    unsigned int polygonCapacity;
+    unsigned int* triangles;
+    unsigned int trianglesCapacity;
+    float* points;
+    unsigned int pointsCapacity;
+    unsigned int* remaining;
+    unsigned int remainingCapacity;
+} EogllObjStream;
+
+static EogllResult eogllObjStreamPass(EogllObjStream* stream, bool readAttributes, EogllObjTriangleFunc func, void* user) {
+    EogllObjectFileData* data = &stream->data;
+    // eogllObjParseFaceIndex resolves relative indices against the counts in here
+    EogllObjParseChunk counter;
+    memset(&counter, 0, sizeof(counter));
+    unsigned int positionsCapacity = 0;
+    unsigned int normalsCapacity = 0;
+    unsigned int texCoordsCapacity = 0;
+    if (readAttributes) {
+        stream->numTriangles = 0;
+        stream->firstFaceHasNormal = false;
+    }
+
+    const char* begin = stream->file.data;
+    const char* p = begin;
+    const char* end = begin + stream->file.size;
+    const char* released = begin;
+    while (p < end) {
+        const char* lineEnd = (const char*)memchr(p, '\n', end - p);
+        const char* next = lineEnd ? lineEnd + 1 : end;
+        if (!lineEnd) {
+            lineEnd = end;
+        }
+        if ((size_t)(p - released) >= stream->releaseInterval) {
+            eogllReleaseMappedRange(&stream->file, released - begin, p - released);
+            released = p;
+        }
+        p = eogllObjSkipSpace(p, lineEnd);
+        if (lineEnd - p < 2) {
+            p = next;
+            continue;
+        }
+
+        if (p[0] == 'v' && eogllObjIsSpace(p[1])) {
+            if (readAttributes) {
+                if (!eogllObjReserve((void**)&data->positions, &positionsCapacity, data->numPositions + 1, sizeof(EogllObjectPosition))) {
+                    goto fail;
+                }
+                eogllObjParsePosition(p + 2, lineEnd, &data->positions[data->numPositions++]);
+            }
+            counter.data.numPositions++;
+        } else if (p[0] == 'v' && p[1] == 'n') {
+            if (readAttributes) {
+                if (!eogllObjReserve((void**)&data->normals, &normalsCapacity, data->numNormals + 1, sizeof(EogllObjectNormal))) {
+                    goto fail;
+                }
+                eogllObjParseNormal(p + 2, lineEnd, &data->normals[data->numNormals++]);
+            }
+            counter.data.numNormals++;
+        } else if (p[0] == 'v' && p[1] == 't') {
+            if (readAttributes) {
+                if (!eogllObjReserve((void**)&data->texCoords, &texCoordsCapacity, data->numTexCoords + 1, sizeof(EogllObjectTexCoord))) {
+                    goto fail;
+                }
+                eogllObjParseTexCoord(p + 2, lineEnd, &data->texCoords[data->numTexCoords++]);
+            }
+            counter.data.numTexCoords++;
+        } else if (p[0] == 'f' && eogllObjIsSpace(p[1])) {
+            unsigned int n = 0;
+            p += 2;
+            while (true) {
+                p = eogllObjSkipSpace(p, lineEnd);
+                if (p >= lineEnd) {
+                    break;
+                }
+                if (!eogllObjReserve((void**)&stream->polygon, &stream->polygonCapacity, n + 1, sizeof(EogllObjectIndex))) {
+                    goto fail;
+                }
+                if (!eogllObjParseFaceIndex(&p, lineEnd, &counter, n, &stream->polygon[n])) {
+                    break;
+                }
+                n++;
+            }
+            if (n < 3) {
+                if (readAttributes) {
+                    EOGLL_LOG_WARN(stderr, "Face with %u indices skipped, at least 3 are needed\n", n);
+                }
+                p = next;
+                continue;
+            }
+            if (readAttributes) {
+                if (stream->numTriangles == 0) {
+                    stream->firstFaceHasNormal = stream->polygon[0].hasNormal;
+                }
+                stream->numTriangles += n - 2;
+                p = next;
+                continue;
+            }
+            if (!eogllObjReserve((void**)&stream->triangles, &stream->trianglesCapacity, (n - 2) * 3, sizeof(unsigned int)) ||
+                !eogllObjReserve((void**)&stream->points, &stream->pointsCapacity, n * 2, sizeof(float)) ||
+                !eogllObjReserve((void**)&stream->remaining, &stream->remainingCapacity, n, sizeof(unsigned int))) {
+                goto fail;
+            }
+            if (n == 3) {
+                eogllObjFan(n, stream->triangles);
+            } else {
+                eogllObjTriangulatePolygon(data, stream->polygon, n, stream->triangles, stream->points, stream->remaining);
+            }
+            for (unsigned int i = 0; i < (n - 2) * 3; i += 3) {
+                EogllObjectIndex triangle[3];
+                triangle[0] = stream->polygon[stream->triangles[i]];
+                triangle[1] = stream->polygon[stream->triangles[i + 1]];
+                triangle[2] = stream->polygon[stream->triangles[i + 2]];
+                func(data, triangle, user);
+            }
+        }
+        p = next;
+    }
+    eogllReleaseMappedRange(&stream->file, released - begin, end - released);
+    return EOGLL_SUCCESS;
+
+fail:
+    EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for object file data\n");
+    return EOGLL_FAILURE;
+}
+
+static void eogllObjStreamFree(EogllObjStream* stream) {
+    eogllUnmapFile(&stream->file);
+    eogllDeleteObjectFileData(&stream->data);
+    free(stream->polygon);
+    free(stream->triangles);
+    free(stream->points);
+    free(stream->remaining);
+}
+
+static void eogllObjStreamAccumulateNormals(EogllObjectFileData* data, EogllObjectIndex* triangle, void* user) {
+    float* sums = (float*)user;
+    eogllObjAccumulateSmoothNormal(data, triangle, sums, sums + data->numPositions, sums + (size_t)data->numPositions * 2);
+}
+
+typedef struct EogllObjStreamWriter {
+    EogllObjectAttrs* attrs;
+    // whether normals are generated, and how
+    bool generateNormals;
+    EogllObjectNormalMode normalMode;
+    EogllObjectQuantization quantization;
+    bool floatsOnly;
+    unsigned char* batch;
+    uint32_t stride;
+    uint32_t batchCapacity;
+    uint32_t numBatched;
+    GLintptr offset;
+} EogllObjStreamWriter;
+
+static void eogllObjStreamFlush(EogllObjStreamWriter* writer) {
+    if (writer->numBatched == 0) {
+        return;
+    }
+    GLsizeiptr size = (GLsizeiptr)writer->stride * writer->numBatched;
+    glBufferSubData(GL_ARRAY_BUFFER, writer->offset, size, writer->batch);
+    writer->offset += size;
+    writer->numBatched = 0;
+}
+
+static void eogllObjStreamWriteTriangle(EogllObjectFileData* data, EogllObjectIndex* triangle, void* user) {
+    EogllObjStreamWriter* writer = (EogllObjStreamWriter*)user;
+    EogllObjectNormal* normals = data->normals;
+    unsigned int numNormals = data->numNormals;
+    EogllObjectNormal faceNormal;
+    if (writer->generateNormals && writer->normalMode == EOGLL_OBJ_NORMALS_FLAT) {
+        // point the triangle at a single normal instead of storing one per triangle
+        eogllObjTriangleNormal(data, triangle, &faceNormal);
+        data->normals = &faceNormal;
+        data->numNormals = 1;
+    }
+    for (unsigned int i = 0; i < 3; i++) {
+        if (writer->generateNormals) {
+            bool flat = writer->normalMode == EOGLL_OBJ_NORMALS_FLAT;
+            triangle[i].hasNormal = true;
+            triangle[i].normalIndex = flat ? 1 : triangle[i].geomIndex;
+        }
+        if (writer->numBatched == writer->batchCapacity) {
+            eogllObjStreamFlush(writer);
+        }
+        eogllObjEmitVertex(data, writer->attrs, &writer->quantization, writer->floatsOnly, triangle[i], writer->batch + (size_t)writer->numBatched * writer->stride);
+        writer->numBatched++;
+    }
+    data->normals = normals;
+    data->numNormals = numNormals;
+}
+
+EogllBufferObject eogllLoadBufferObjectStreamed(const char* path, EogllObjectAttrs attrs, GLenum usage, const EogllObjectLoadOptions* options) {
+    double start = eogllGetTime();
+    EogllObjStream stream;
+    memset(&stream, 0, sizeof(stream));
+    // release what was read every budget bytes, but not so often that it costs more than reading
+    stream.releaseInterval = options->streamBudget > (1 << 20) ? options->streamBudget : (1 << 20);
+    if (eogllMapFile(path, &stream.file) != EOGLL_SUCCESS) {
+        EOGLL_LOG_ERROR(stderr, "Failed to open file %s\n", path);
+        return (EogllBufferObject){0};
+    }
+    if (eogllObjStreamPass(&stream, true, NULL, NULL) != EOGLL_SUCCESS) {
+        EOGLL_LOG_ERROR(stderr, "Failed to parse object file %s\n", path);
+        eogllObjStreamFree(&stream);
+        return (EogllBufferObject){0};
+    }
+    if (stream.numTriangles * 3 > INT32_MAX) {
+        EOGLL_LOG_ERROR(stderr, "Object file %s has too many triangles (%llu)\n", path, (unsigned long long)stream.numTriangles);
+        eogllObjStreamFree(&stream);
+        return (EogllBufferObject){0};
+    }
+    double parsed = eogllGetTime();
+
+    EogllObjStreamWriter writer;
+    memset(&writer, 0, sizeof(writer));
+    writer.attrs = &attrs;
+    writer.normalMode = options->normalMode;
+    writer.stride = eogllObjStride(&attrs);
+    writer.floatsOnly = eogllObjAttrsAreFloats(&attrs);
+    eogllObjComputeQuantization(&stream.data, &attrs, &writer.quantization);
+    for (int i = 0; i < attrs.numTypes; i++) {
+        if (attrs.types[i].type == EOGLL_ATTR_NORMAL) {
+            writer.generateNormals = stream.data.numNormals == 0 || !stream.firstFaceHasNormal;
+        }
+    }
+    if (writer.generateNormals && writer.normalMode == EOGLL_OBJ_NORMALS_SMOOTH) {
+        float* sums = (float*)calloc((size_t)(stream.data.numPositions ? stream.data.numPositions : 1) * 3, sizeof(float));
+        if (!sums) {
+            EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for normals\n");
+            eogllObjStreamFree(&stream);
+            return (EogllBufferObject){0};
+        }
+        if (eogllObjStreamPass(&stream, false, eogllObjStreamAccumulateNormals, sums) != EOGLL_SUCCESS ||
+            eogllObjFinishSmoothNormals(&stream.data, sums) != EOGLL_SUCCESS) {
+            eogllObjStreamFree(&stream);
+            return (EogllBufferObject){0};
+        }
+    }
+
+    // the batch is the only thing that grows with the budget, everything else is the attributes of the file
+    size_t vertexSize = writer.stride ? writer.stride : 1;
+    writer.batchCapacity = (uint32_t)(options->streamBudget / vertexSize / 3 * 3);
+    if (writer.batchCapacity < 3) {
+        writer.batchCapacity = 3;
+    }
+    if (writer.batchCapacity > stream.numTriangles * 3 && stream.numTriangles > 0) {
+        writer.batchCapacity = (uint32_t)(stream.numTriangles * 3);
+    }
+    writer.batch = (unsigned char*)malloc(vertexSize * writer.batchCapacity);
+    if (!writer.batch) {
+        EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for object vertices\n");
+        eogllObjStreamFree(&stream);
+        return (EogllBufferObject){0};
+    }
+
+    uint32_t numVertices = (uint32_t)(stream.numTriangles * 3);
+    unsigned int vao = eogllGenVertexArray();
+    unsigned int vbo = eogllGenBuffer(vao, GL_ARRAY_BUFFER, (GLsizeiptr)vertexSize * numVertices, NULL, usage);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    EogllResult result = eogllObjStreamPass(&stream, false, eogllObjStreamWriteTriangle, &writer);
+    eogllObjStreamFlush(&writer);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    free(writer.batch);
+    eogllObjStreamFree(&stream);
+    if (result != EOGLL_SUCCESS) {
+        EOGLL_LOG_ERROR(stderr, "Failed to load object %s\n", path);
+        glDeleteBuffers(1, &vbo);
+        glDeleteVertexArrays(1, &vao);
+        return (EogllBufferObject){0};
+    }
+    eogllBuildAttributes(&attrs.builder, vao);
+
+    double end = eogllGetTime();
+    EOGLL_LOG_DEBUG(stdout, "Streamed %u vertices in batches of %u\n", numVertices, writer.batchCapacity);
+    EOGLL_LOG_DEBUG(stdout, "Parsed attributes in %f seconds, uploaded faces in %f seconds\n", parsed - start, end - parsed);
+    EOGLL_LOG_DEBUG(stdout, "Peak resident memory: %zu KB\n", eogllGetPeakMemoryUsage() / 1024);
+    EogllBufferObject bufferObject = eogllCreateBasicBufferObject(vao, vbo, numVertices);
+    memcpy(bufferObject.positionOffset, writer.quantization.offset, sizeof(writer.quantization.offset));
+    memcpy(bufferObject.positionScale, writer.quantization.scale, sizeof(writer.quantization.scale));
+    return bufferObject;
+}
@@ -0,0 +1,303 @@
+#include "eogll/program_cache.h"
+
+#include "eogll/logging.h"
+#include "eogll/util.h"
+
+#define EOGLL_PROGRAM_CACHE_ENDIAN_CHECK 0x01020304u
+
+// the loader only has OpenGL 3.3, these come from OpenGL 4.1 and ARB_get_program_binary (same names and values)
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+typedef void (GLAD_API_PTR *EogllGetProgramBinaryProc)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (GLAD_API_PTR *EogllProgramBinaryProc)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (GLAD_API_PTR *EogllProgramParameteriProc)(GLuint program, GLenum pname, GLint value);
+
+// -1 until the first check
+static int eogllProgramBinarySupport = -1;
+static EogllGetProgramBinaryProc eogllGetProgramBinary = NULL;
+static EogllProgramBinaryProc eogllProgramBinary = NULL;
+static EogllProgramParameteriProc eogllProgramParameteri = NULL;
+
+static char* eogllProgramCacheDirectory = NULL;
+static EogllProgramCacheStats eogllProgramCacheStats = {0};
+
+// every field is naturally aligned, so there is no padding and the struct can be written as is
+typedef struct EogllProgramCacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t endianCheck;
+    uint32_t format;
+    uint64_t key;
+    uint64_t driver;
+    uint64_t binarySize;
+    uint64_t binaryHash;
+} EogllProgramCacheHeader;
+
+// FNV-1a, continuing from hash
+static uint64_t eogllProgramCacheHash(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// the terminator is hashed too, so moving text from one string to the next changes the hash
+static uint64_t eogllProgramCacheHashString(uint64_t hash, const char* string) {
+    if (!string) {
+        string = "";
+    }
+    return eogllProgramCacheHash(hash, string, strlen(string) + 1);
+}
+
+static uint64_t eogllProgramCacheDriver() {
+    uint64_t hash = 14695981039346656037ull;
+    hash = eogllProgramCacheHashString(hash, (const char*)glGetString(GL_VENDOR));
+    hash = eogllProgramCacheHashString(hash, (const char*)glGetString(GL_RENDERER));
+    hash = eogllProgramCacheHashString(hash, (const char*)glGetString(GL_VERSION));
+    hash = eogllProgramCacheHashString(hash, (const char*)glGetString(GL_SHADING_LANGUAGE_VERSION));
+    return hash;
+}
+
+void eogllSetProgramCacheDirectory(const char* directory) {
+    free(eogllProgramCacheDirectory);
+    eogllProgramCacheDirectory = NULL;
+    if (!directory) {
+        return;
+    }
+    size_t length = strlen(directory) + 1;
+    eogllProgramCacheDirectory = (char*)malloc(length);
+    if (!eogllProgramCacheDirectory) {
+        EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for the program cache directory\n");
+        return;
+    }
+    memcpy(eogllProgramCacheDirectory, directory, length);
+}
+
+const char* eogllGetProgramCacheDirectory() {
+    return eogllProgramCacheDirectory;
+}
+
+bool eogllProgramBinariesSupported() {
+    if (eogllProgramBinarySupport >= 0) {
+        return eogllProgramBinarySupport == 1;
+    }
+    eogllProgramBinarySupport = 0;
+    GLint major = 0;
+    GLint minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    bool available = major > 4 || (major == 4 && minor >= 1);
+    if (!available) {
+        GLint numExtensions = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
+        for (GLint i = 0; i < numExtensions && !available; i++) {
+            const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+            available = extension && strcmp(extension, "GL_ARB_get_program_binary") == 0;
+        }
+    }
+    // drivers can support the functions without having any format to save programs in
+    GLint numFormats = 0;
+    if (available) {
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+    }
+    if (available && numFormats > 0) {
+        eogllGetProgramBinary = (EogllGetProgramBinaryProc)glfwGetProcAddress("glGetProgramBinary");
+        eogllProgramBinary = (EogllProgramBinaryProc)glfwGetProcAddress("glProgramBinary");
+        eogllProgramParameteri = (EogllProgramParameteriProc)glfwGetProcAddress("glProgramParameteri");
+        if (eogllGetProgramBinary && eogllProgramBinary && eogllProgramParameteri) {
+            eogllProgramBinarySupport = 1;
+        }
+    }
+    EOGLL_LOG_DEBUG(stdout, "Program binaries are %s (%d formats)\n", eogllProgramBinarySupport == 1 ? "supported" : "not supported", numFormats);
+    return eogllProgramBinarySupport == 1;
+}
+
+uint64_t eogllHashProgramSources(const char* vertexShaderSource, const char* fragmentShaderSource, const char* defines) {
+    uint64_t hash = eogllProgramCacheDriver();
+    hash = eogllProgramCacheHashString(hash, vertexShaderSource);
+    hash = eogllProgramCacheHashString(hash, fragmentShaderSource);
+    hash = eogllProgramCacheHashString(hash, defines);
+    return hash;
+}
+
+char* eogllGetProgramCachePath(uint64_t key) {
+    if (!eogllProgramCacheDirectory) {
+        return NULL;
+    }
+    size_t length = strlen(eogllProgramCacheDirectory);
+    bool separator = length > 0 && eogllProgramCacheDirectory[length - 1] != '/' && eogllProgramCacheDirectory[length - 1] != '\\';
+    // separator, 16 hex digits, ".eop" and the terminator
+    char* path = (char*)malloc(length + 22);
+    if (!path) {
+        EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for program cache path\n");
+        return NULL;
+    }
+    snprintf(path, length + 22, "%s%s%016llx.eop", eogllProgramCacheDirectory, separator ? "/" : "", (unsigned long long)key);
+    return path;
+}
+
+// checks that the header is from this version, for this program and driver, and that the binary is intact
+static EogllResult eogllProgramCacheValidate(const EogllMappedFile* file, const char* path, uint64_t key) {
+    if (file->size < sizeof(EogllProgramCacheHeader)) {
+        EOGLL_LOG_ERROR(stderr, "Program cache %s is too small\n", path);
+        return EOGLL_FAILURE;
+    }
+    EogllProgramCacheHeader header;
+    memcpy(&header, file->data, sizeof(header));
+    if (memcmp(header.magic, "EOP", 4) != 0 || header.endianCheck != EOGLL_PROGRAM_CACHE_ENDIAN_CHECK) {
+        EOGLL_LOG_ERROR(stderr, "%s is not a program cache\n", path);
+        return EOGLL_FAILURE;
+    }
+    if (header.version != EOGLL_PROGRAM_CACHE_VERSION) {
+        EOGLL_LOG_WARN(stderr, "Program cache %s has version %u, expected %u\n", path, header.version, EOGLL_PROGRAM_CACHE_VERSION);
+        return EOGLL_FAILURE;
+    }
+    if (header.key != key || header.driver != eogllProgramCacheDriver()) {
+        EOGLL_LOG_DEBUG(stdout, "Program cache %s is for another program or driver\n", path);
+        return EOGLL_FAILURE;
+    }
+    const char* binary = file->data + sizeof(header);
+    if (header.binarySize != file->size - sizeof(header) || header.binarySize > INT32_MAX ||
+        eogllProgramCacheHash(14695981039346656037ull, binary, (size_t)header.binarySize) != header.binaryHash) {
+        EOGLL_LOG_ERROR(stderr, "Program cache %s is corrupt\n", path);
+        return EOGLL_FAILURE;
+    }
+    return EOGLL_SUCCESS;
+}
+
+EogllResult eogllLoadProgramBinary(const char* path, uint64_t key, GLuint program) {
+    if (!eogllProgramBinariesSupported()) {
+        return EOGLL_FAILURE;
+    }
+    // a program that wasn't cached yet is a normal miss, eogllGetFileInfo checks for it without the error eogllMapFile would log
+    uint64_t modifiedTime;
+    uint64_t size;
+    if (eogllGetFileInfo(path, &modifiedTime, &size) != EOGLL_SUCCESS) {
+        EOGLL_LOG_DEBUG(stdout, "No program cache %s\n", path);
+        eogllProgramCacheStats.misses++;
+        return EOGLL_FAILURE;
+    }
+    EogllMappedFile file;
+    if (eogllMapFile(path, &file) != EOGLL_SUCCESS) {
+        eogllProgramCacheStats.misses++;
+        return EOGLL_FAILURE;
+    }
+    EogllResult result = eogllProgramCacheValidate(&file, path, key);
+    if (result == EOGLL_SUCCESS) {
+        EogllProgramCacheHeader header;
+        memcpy(&header, file.data, sizeof(header));
+        eogllProgramBinary(program, header.format, file.data + sizeof(header), (GLsizei)header.binarySize);
+        GLint linked = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (!linked) {
+            // drivers refuse binaries from older versions of themselves even when the version strings match
+            EOGLL_LOG_WARN(stderr, "The driver refused program cache %s\n", path);
+            result = EOGLL_FAILURE;
+        }
+    }
+    eogllUnmapFile(&file);
+    if (result != EOGLL_SUCCESS) {
+        eogllProgramCacheStats.rejected++;
+        remove(path);
+        return EOGLL_FAILURE;
+    }
+    eogllProgramCacheStats.hits++;
+    EOGLL_LOG_DEBUG(stdout, "Loaded program %u from cache %s\n", program, path);
+    return EOGLL_SUCCESS;
+}
+
+EogllResult eogllWriteProgramBinary(const char* path, uint64_t key, GLuint program) {
+    if (!eogllProgramBinariesSupported()) {
+        return EOGLL_FAILURE;
+    }
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        EOGLL_LOG_WARN(stderr, "Program %u has no binary to cache\n", program);
+        return EOGLL_FAILURE;
+    }
+    void* binary = malloc((size_t)length);
+    if (!binary) {
+        EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for program binary\n");
+        return EOGLL_FAILURE;
+    }
+    GLsizei written = 0;
+    GLenum format = 0;
+    eogllGetProgramBinary(program, length, &written, &format, binary);
+    if (written <= 0) {
+        EOGLL_LOG_WARN(stderr, "Failed to get the binary of program %u\n", program);
+        free(binary);
+        return EOGLL_FAILURE;
+    }
+
+    EogllProgramCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "EOP", 4);
+    header.version = EOGLL_PROGRAM_CACHE_VERSION;
+    header.endianCheck = EOGLL_PROGRAM_CACHE_ENDIAN_CHECK;
+    header.format = format;
+    header.key = key;
+    header.driver = eogllProgramCacheDriver();
+    header.binarySize = (uint64_t)written;
+    header.binaryHash = eogllProgramCacheHash(14695981039346656037ull, binary, (size_t)written);
+
+    size_t pathLength = strlen(path);
+    char* tempPath = (char*)malloc(pathLength + 5);
+    if (!tempPath) {
+        EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for program cache path\n");
+        free(binary);
+        return EOGLL_FAILURE;
+    }
+    memcpy(tempPath, path, pathLength);
+    memcpy(tempPath + pathLength, ".tmp", 5);
+
+    FILE* file = fopen(tempPath, "wb");
+    if (!file) {
+        EOGLL_LOG_ERROR(stderr, "Failed to open %s for writing\n", tempPath);
+        free(tempPath);
+        free(binary);
+        return EOGLL_FAILURE;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = ok && fwrite(binary, 1, (size_t)written, file) == (size_t)written;
+    ok = fclose(file) == 0 && ok;
+    free(binary);
+    if (!ok) {
+        EOGLL_LOG_ERROR(stderr, "Failed to write program cache %s\n", tempPath);
+        remove(tempPath);
+        free(tempPath);
+        return EOGLL_FAILURE;
+    }
+    // rename doesn't replace existing files on windows
+    remove(path);
+    if (rename(tempPath, path) != 0) {
+        EOGLL_LOG_ERROR(stderr, "Failed to move program cache %s to %s\n", tempPath, path);
+        remove(tempPath);
+        free(tempPath);
+        return EOGLL_FAILURE;
+    }
+    free(tempPath);
+    eogllProgramCacheStats.writes++;
+    EOGLL_LOG_DEBUG(stdout, "Wrote program cache %s (%d bytes)\n", path, written);
+    return EOGLL_SUCCESS;
+}
+
+void eogllPrepareProgramBinary(GLuint program) {
+    if (eogllProgramBinariesSupported()) {
+        eogllProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+}
+
+EogllProgramCacheStats eogllGetProgramCacheStats() {
+    return eogllProgramCacheStats;
+}
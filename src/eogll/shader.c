@@ -2,9 +2,230 @@
 
 #include "eogll/logging.h"
 #include "eogll/util.h"
+#include "eogll/uniform_buffer.h"
+#include "eogll/program_cache.h"
+
+// FNV-1a
+uint32_t eogllHashUniformName(const char* name) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char* c = (const unsigned char*)name; *c; c++) {
+        hash ^= *c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// the slot with the name, or the empty slot it would go in
+static EogllUniform* eogllFindUniformSlot(const EogllUniformTable* table, const char* name, uint32_t hash) {
+    uint32_t mask = table->numSlots - 1;
+    for (uint32_t i = hash & mask;; i = (i + 1) & mask) {
+        EogllUniform* slot = &table->slots[i];
+        if (slot->name == 0 || (slot->hash == hash && strcmp(table->names + slot->name - 1, name) == 0)) {
+            return slot;
+        }
+    }
+}
+
+static bool eogllGrowUniformTable(EogllUniformTable* table, uint32_t numSlots) {
+    EogllUniform* slots = (EogllUniform*)calloc(numSlots, sizeof(EogllUniform));
+    if (!slots) {
+        EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for the uniform table\n");
+        return false;
+    }
+    EogllUniformTable grown = *table;
+    grown.slots = slots;
+    grown.numSlots = numSlots;
+    for (uint32_t i = 0; i < table->numSlots; i++) {
+        if (table->slots[i].name != 0) {
+            *eogllFindUniformSlot(&grown, table->names + table->slots[i].name - 1, table->slots[i].hash) = table->slots[i];
+        }
+    }
+    free(table->slots);
+    *table = grown;
+    return true;
+}
+
+// returns the slot of the uniform, NULL if there isn't enough memory to add it
+static EogllUniform* eogllAddUniform(EogllUniformTable* table, const char* name, uint32_t hash, GLint location, bool array) {
+    if ((table->numUniforms + 1) * 2 > table->numSlots && !eogllGrowUniformTable(table, table->numSlots ? table->numSlots * 2 : 16)) {
+        return NULL;
+    }
+    EogllUniform* slot = eogllFindUniformSlot(table, name, hash);
+    if (slot->name != 0) {
+        slot->location = location;
+        slot->array = slot->array || array;
+        return slot;
+    }
+    slot->array = array;
+    uint32_t length = (uint32_t)strlen(name) + 1;
+    if (table->namesSize + length > table->namesCapacity) {
+        uint32_t capacity = table->namesCapacity ? table->namesCapacity * 2 : 256;
+        while (capacity < table->namesSize + length) {
+            capacity *= 2;
+        }
+        char* names = (char*)realloc(table->names, capacity);
+        if (!names) {
+            EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for the uniform table\n");
+            return NULL;
+        }
+        table->names = names;
+        table->namesCapacity = capacity;
+    }
+    memcpy(table->names + table->namesSize, name, length);
+    slot->hash = hash;
+    slot->location = location;
+    slot->name = table->namesSize + 1;
+    table->namesSize += length;
+    table->numUniforms++;
+    return slot;
+}
+
+// the slot of a uniform, the driver is only asked for names that aren't in the table yet
+static EogllUniform* eogllGetUniform(EogllShaderProgram* shader, const char* name, uint32_t hash) {
+    if (shader->uniforms.numSlots != 0) {
+        EogllUniform* slot = eogllFindUniformSlot(&shader->uniforms, name, hash);
+        if (slot->name != 0) {
+            return slot;
+        }
+    }
+    // not an active uniform (like an element of an array other than the first), so it is asked for once
+    return eogllAddUniform(&shader->uniforms, name, hash, glGetUniformLocation(shader->id, name), strchr(name, '[') != NULL);
+}
+
+// looks the uniform up and checks whether writing value would change it, location is set either way
+// without shadowing every write to a uniform the program has is a change
+static bool eogllUniformChanged(EogllShaderProgram* shader, const char* name, const void* value, uint32_t size, GLint* location) {
+    EogllUniformTable* table = &shader->uniforms;
+    EogllUniform* slot = eogllGetUniform(shader, name, eogllHashUniformName(name));
+    if (!slot) {
+        *location = glGetUniformLocation(shader->id, name);
+        table->issuedWrites++;
+        return true;
+    }
+    *location = slot->location;
+    if (slot->location < 0) {
+        // glUniform would ignore it anyway
+        return false;
+    }
+    // the elements of an array can be written under several names ("lights", "lights[0]", "lights[2]"), so one name's copy can be stale
+    if (!table->shadow || slot->array) {
+        table->issuedWrites++;
+        return true;
+    }
+    if (slot->valueSize == size && memcmp(table->values + slot->value, value, size) == 0) {
+        table->skippedWrites++;
+        return false;
+    }
+    if (size > slot->valueCapacity) {
+        // the first write (or an array written with more elements than before) gets a new place in values
+        // at least doubling it means a uniform that keeps growing leaves less behind than it uses
+        uint32_t reserved = slot->valueCapacity * 2 > size ? slot->valueCapacity * 2 : size;
+        if (table->valuesSize + reserved > table->valuesCapacity) {
+            uint32_t capacity = table->valuesCapacity ? table->valuesCapacity * 2 : 1024;
+            while (capacity < table->valuesSize + reserved) {
+                capacity *= 2;
+            }
+            unsigned char* values = (unsigned char*)realloc(table->values, capacity);
+            if (!values) {
+                EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for uniform values\n");
+                slot->valueSize = 0;
+                table->issuedWrites++;
+                return true;
+            }
+            table->values = values;
+            table->valuesCapacity = capacity;
+        }
+        slot->value = table->valuesSize;
+        slot->valueCapacity = reserved;
+        table->valuesSize += reserved;
+    }
+    slot->valueSize = size;
+    memcpy(table->values + slot->value, value, size);
+    table->issuedWrites++;
+    return true;
+}
+
+static void eogllLoadUniforms(EogllShaderProgram* shader) {
+    GLint count = 0;
+    GLint maxLength = 0;
+    glGetProgramiv(shader->id, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(shader->id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    if (count <= 0 || maxLength <= 0) {
+        return;
+    }
+    // arrays are added twice and the table is at most half full
+    uint32_t numSlots = 16;
+    while (numSlots < (uint32_t)count * 4) {
+        numSlots *= 2;
+    }
+    if (!eogllGrowUniformTable(&shader->uniforms, numSlots)) {
+        return;
+    }
+    char* name = (char*)malloc((size_t)maxLength + 1);
+    if (!name) {
+        EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for uniform names\n");
+        return;
+    }
+    for (GLint i = 0; i < count; i++) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(shader->id, (GLuint)i, maxLength + 1, &length, &size, &type, name);
+        // uniforms in blocks have a location of -1, they are still added so they aren't asked for every time
+        GLint location = glGetUniformLocation(shader->id, name);
+        bool array = size > 1 || (length > 3 && strcmp(name + length - 3, "[0]") == 0);
+        eogllAddUniform(&shader->uniforms, name, eogllHashUniformName(name), location, array);
+        if (length > 3 && strcmp(name + length - 3, "[0]") == 0) {
+            name[length - 3] = '\0';
+            eogllAddUniform(&shader->uniforms, name, eogllHashUniformName(name), location, array);
+        }
+    }
+    free(name);
+    EOGLL_LOG_DEBUG(stdout, "Program %u has %d active uniforms\n", shader->id, count);
+}
+
+static void eogllFreeUniforms(EogllUniformTable* table) {
+    free(table->slots);
+    free(table->names);
+    free(table->values);
+    memset(table, 0, sizeof(EogllUniformTable));
+}
+
+// everything a linked program needs, whether it was compiled or loaded from the cache
+static void eogllFinishProgram(EogllShaderProgram* shader) {
+    shader->successful = true;
+    eogllLoadUniforms(shader);
+    // programs that declare the per-frame block read it from the shared buffer
+    GLuint frameBlock = glGetUniformBlockIndex(shader->id, EOGLL_FRAME_UNIFORMS_BLOCK);
+    if (frameBlock != GL_INVALID_INDEX) {
+        glUniformBlockBinding(shader->id, frameBlock, EOGLL_FRAME_UNIFORMS_BINDING);
+    }
+}
 
 EogllShaderProgram* eogllLinkProgram(const char* vertexShaderSource, const char* fragmentShaderSource) {
     EogllShaderProgram *shader = (EogllShaderProgram *) malloc(sizeof(EogllShaderProgram));
+    memset(&shader->uniforms, 0, sizeof(EogllUniformTable));
+    shader->cached = false;
+
+    char* cachePath = NULL;
+    uint64_t cacheKey = 0;
+    if (eogllGetProgramCacheDirectory() && eogllProgramBinariesSupported()) {
+        cacheKey = eogllHashProgramSources(vertexShaderSource, fragmentShaderSource, NULL);
+        cachePath = eogllGetProgramCachePath(cacheKey);
+    }
+    if (cachePath) {
+        shader->id = glCreateProgram();
+        if (eogllLoadProgramBinary(cachePath, cacheKey, shader->id) == EOGLL_SUCCESS) {
+            free(cachePath);
+            shader->vertexStatus = GL_TRUE;
+            shader->fragmentStatus = GL_TRUE;
+            shader->programStatus = GL_TRUE;
+            shader->cached = true;
+            eogllFinishProgram(shader);
+            return shader;
+        }
+        glDeleteProgram(shader->id);
+    }
 
     unsigned int vertexShader;
     vertexShader = glCreateShader(GL_VERTEX_SHADER);
@@ -21,6 +242,7 @@ EogllShaderProgram* eogllLinkProgram(const char* vertexShaderSource, const char*
         EOGLL_LOG_ERROR(stderr, "Vertex shader compilation failed (%d): %s\n", success, infoLog);
         shader->successful = false;
         shader->id = 0;
+        free(cachePath);
         return shader;
     }
 
@@ -37,6 +259,7 @@ EogllShaderProgram* eogllLinkProgram(const char* vertexShaderSource, const char*
         shader->successful = false;
         shader->id = 0;
         glDeleteShader(vertexShader);
+        free(cachePath);
         return shader;
     }
 
@@ -45,6 +268,9 @@ EogllShaderProgram* eogllLinkProgram(const char* vertexShaderSource, const char*
 
     glAttachShader(shader->id, vertexShader);
     glAttachShader(shader->id, fragmentShader);
+    if (cachePath) {
+        eogllPrepareProgramBinary(shader->id);
+    }
     glLinkProgram(shader->id);
 
     glGetProgramiv(shader->id, GL_LINK_STATUS, &success);
@@ -56,13 +282,19 @@ EogllShaderProgram* eogllLinkProgram(const char* vertexShaderSource, const char*
         shader->id = 0;
         glDeleteShader(vertexShader);
         glDeleteShader(fragmentShader);
+        free(cachePath);
         return shader;
     }
 
     glDeleteShader(vertexShader);
     glDeleteShader(fragmentShader);
 
-    shader->successful = true;
+    if (cachePath) {
+        // the program works without a cache, the next launch just compiles it again
+        (void)eogllWriteProgramBinary(cachePath, cacheKey, shader->id);
+        free(cachePath);
+    }
+    eogllFinishProgram(shader);
 
     return shader;
 }
@@ -86,6 +318,7 @@ EogllShaderProgram* eogllLinkProgramFromFile(const char* vertexShaderPath, const
 
 void eogllDeleteProgram(EogllShaderProgram* shader) {
     glDeleteProgram(shader->id);
+    eogllFreeUniforms(&shader->uniforms);
     free(shader);
 }
 
@@ -93,74 +326,226 @@ void eogllUseProgram(EogllShaderProgram* shader) {
     glUseProgram(shader->id);
 }
 
+GLint eogllGetUniformLocation(EogllShaderProgram* shader, const char* name) {
+    return eogllGetUniformLocationHashed(shader, name, eogllHashUniformName(name));
+}
+
+GLint eogllGetUniformLocationHashed(EogllShaderProgram* shader, const char* name, uint32_t hash) {
+    const EogllUniform* slot = eogllGetUniform(shader, name, hash);
+    return slot ? slot->location : glGetUniformLocation(shader->id, name);
+}
+
+void eogllSetUniformShadowing(EogllShaderProgram* shader, bool enabled) {
+    shader->uniforms.shadow = enabled;
+    eogllInvalidateUniformShadow(shader);
+}
+
+void eogllInvalidateUniformShadow(EogllShaderProgram* shader) {
+    EogllUniformTable* table = &shader->uniforms;
+    for (uint32_t i = 0; i < table->numSlots; i++) {
+        table->slots[i].valueSize = 0;
+        table->slots[i].valueCapacity = 0;
+    }
+    table->valuesSize = 0;
+}
+
 void eogllSetUniformMatrix4fv(EogllShaderProgram* shader, const char* name, mat4 value) {
-    glUniformMatrix4fv(glGetUniformLocation(shader->id, name), 1, GL_FALSE, (float*)value);
+    GLint location;
+    if (eogllUniformChanged(shader, name, value, sizeof(mat4), &location)) {
+        eogllSetUniformMatrix4fvLocation(location, value);
+    }
 }
 
 void eogllSetUniform4f(EogllShaderProgram* shader, const char* name, float v0, float v1, float v2, float v3) {
-    glUniform4f(glGetUniformLocation(shader->id, name), v0, v1, v2, v3);
+    float value[4] = {v0, v1, v2, v3};
+    GLint location;
+    if (eogllUniformChanged(shader, name, value, sizeof(value), &location)) {
+        eogllSetUniform4fLocation(location, v0, v1, v2, v3);
+    }
 }
 
 void eogllSetUniform4fv(EogllShaderProgram* shader, const char* name, vec4 value) {
-    glUniform4fv(glGetUniformLocation(shader->id, name), 1, value);
+    GLint location;
+    if (eogllUniformChanged(shader, name, value, sizeof(vec4), &location)) {
+        eogllSetUniform4fvLocation(location, value);
+    }
 }
 
 void eogllSetUniform3f(EogllShaderProgram* shader, const char* name, float v0, float v1, float v2) {
-    glUniform3f(glGetUniformLocation(shader->id, name), v0, v1, v2);
+    float value[3] = {v0, v1, v2};
+    GLint location;
+    if (eogllUniformChanged(shader, name, value, sizeof(value), &location)) {
+        eogllSetUniform3fLocation(location, v0, v1, v2);
+    }
 }
 
 void eogllSetUniform3fv(EogllShaderProgram* shader, const char* name, vec3 value) {
-    glUniform3fv(glGetUniformLocation(shader->id, name), 1, value);
+    GLint location;
+    if (eogllUniformChanged(shader, name, value, sizeof(vec3), &location)) {
+        eogllSetUniform3fvLocation(location, value);
+    }
 }
 
 void eogllSetUniform2f(EogllShaderProgram* shader, const char* name, float v0, float v1) {
-    glUniform2f(glGetUniformLocation(shader->id, name), v0, v1);
+    float value[2] = {v0, v1};
+    GLint location;
+    if (eogllUniformChanged(shader, name, value, sizeof(value), &location)) {
+        eogllSetUniform2fLocation(location, v0, v1);
+    }
 }
 
 void eogllSetUniform2fv(EogllShaderProgram* shader, const char* name, vec2 value) {
-    glUniform2fv(glGetUniformLocation(shader->id, name), 1, value);
+    GLint location;
+    if (eogllUniformChanged(shader, name, value, sizeof(vec2), &location)) {
+        eogllSetUniform2fvLocation(location, value);
+    }
 }
 
 void eogllSetUniform1f(EogllShaderProgram* shader, const char* name, float v0) {
-    glUniform1f(glGetUniformLocation(shader->id, name), v0);
+    GLint location;
+    if (eogllUniformChanged(shader, name, &v0, sizeof(v0), &location)) {
+        eogllSetUniform1fLocation(location, v0);
+    }
 }
 
 void eogllSetUniform1fv(EogllShaderProgram* shader, const char* name, float* vector, GLsizei count) {
-    glUniform1fv(glGetUniformLocation(shader->id, name), count, vector);
+    GLint location;
+    if (eogllUniformChanged(shader, name, vector, (uint32_t)(sizeof(float) * count), &location)) {
+        eogllSetUniform1fvLocation(location, vector, count);
+    }
 }
 
 void eogllSetUniform1i(EogllShaderProgram* shader, const char* name, int v0) {
-    glUniform1i(glGetUniformLocation(shader->id, name), v0);
+    GLint location;
+    if (eogllUniformChanged(shader, name, &v0, sizeof(v0), &location)) {
+        eogllSetUniform1iLocation(location, v0);
+    }
 }
 
 void eogllSetUniform1iv(EogllShaderProgram* shader, const char* name, int* vector, GLsizei count) {
-    glUniform1iv(glGetUniformLocation(shader->id, name), count, vector);
+    GLint location;
+    if (eogllUniformChanged(shader, name, vector, (uint32_t)(sizeof(int) * count), &location)) {
+        eogllSetUniform1ivLocation(location, vector, count);
+    }
 }
 
 void eogllSetUniform1ui(EogllShaderProgram* shader, const char* name, unsigned int v0) {
-    glUniform1ui(glGetUniformLocation(shader->id, name), v0);
+    GLint location;
+    if (eogllUniformChanged(shader, name, &v0, sizeof(v0), &location)) {
+        eogllSetUniform1uiLocation(location, v0);
+    }
 }
 
 void eogllSetUniform1uiv(EogllShaderProgram* shader, const char* name, unsigned int* vector, GLsizei count) {
-    glUniform1uiv(glGetUniformLocation(shader->id, name), count, vector);
+    GLint location;
+    if (eogllUniformChanged(shader, name, vector, (uint32_t)(sizeof(unsigned int) * count), &location)) {
+        eogllSetUniform1uivLocation(location, vector, count);
+    }
 }
 
 void eogllSetUniformMatrix2fv(EogllShaderProgram* shader, const char* name, mat2 value) {
-    glUniformMatrix2fv(glGetUniformLocation(shader->id, name), 1, GL_FALSE, (float*)value);
+    GLint location;
+    if (eogllUniformChanged(shader, name, value, sizeof(mat2), &location)) {
+        eogllSetUniformMatrix2fvLocation(location, value);
+    }
 }
 
 void eogllSetUniformMatrix3fv(EogllShaderProgram* shader, const char* name, mat3 value) {
-    glUniformMatrix3fv(glGetUniformLocation(shader->id, name), 1, GL_FALSE, (float*)value);
+    GLint location;
+    if (eogllUniformChanged(shader, name, value, sizeof(mat3), &location)) {
+        eogllSetUniformMatrix3fvLocation(location, value);
+    }
 }
 
 void eogllSetUniform2fl(EogllShaderProgram* shader, const char* name, vec2* vectors, GLsizei count) {
-    glUniform2fv(glGetUniformLocation(shader->id, name), count, (float*)vectors);
+    GLint location;
+    if (eogllUniformChanged(shader, name, vectors, (uint32_t)(sizeof(vec2) * count), &location)) {
+        eogllSetUniform2flLocation(location, vectors, count);
+    }
 }
 
 void eogllSetUniform3fl(EogllShaderProgram* shader, const char* name, vec3* vectors, GLsizei count) {
-    glUniform3fv(glGetUniformLocation(shader->id, name), count, (float*)vectors);
+    GLint location;
+    if (eogllUniformChanged(shader, name, vectors, (uint32_t)(sizeof(vec3) * count), &location)) {
+        eogllSetUniform3flLocation(location, vectors, count);
+    }
 }
 
 void eogllSetUniform4fl(EogllShaderProgram* shader, const char* name, vec4* vectors, GLsizei count) {
-    glUniform4fv(glGetUniformLocation(shader->id, name), count, (float*)vectors);
-}
\ No newline at end of file
+    GLint location;
+    if (eogllUniformChanged(shader, name, vectors, (uint32_t)(sizeof(vec4) * count), &location)) {
+        eogllSetUniform4flLocation(location, vectors, count);
+    }
+}
+
+void eogllSetUniformMatrix4fvLocation(GLint location, mat4 value) {
+    glUniformMatrix4fv(location, 1, GL_FALSE, (float*)value);
+}
+
+void eogllSetUniform4fLocation(GLint location, float v0, float v1, float v2, float v3) {
+    glUniform4f(location, v0, v1, v2, v3);
+}
+
+void eogllSetUniform4fvLocation(GLint location, vec4 value) {
+    glUniform4fv(location, 1, value);
+}
+
+void eogllSetUniform3fLocation(GLint location, float v0, float v1, float v2) {
+    glUniform3f(location, v0, v1, v2);
+}
+
+void eogllSetUniform3fvLocation(GLint location, vec3 value) {
+    glUniform3fv(location, 1, value);
+}
+
+void eogllSetUniform2fLocation(GLint location, float v0, float v1) {
+    glUniform2f(location, v0, v1);
+}
+
+void eogllSetUniform2fvLocation(GLint location, vec2 value) {
+    glUniform2fv(location, 1, value);
+}
+
+void eogllSetUniform1fLocation(GLint location, float v0) {
+    glUniform1f(location, v0);
+}
+
+void eogllSetUniform1fvLocation(GLint location, float* vector, GLsizei count) {
+    glUniform1fv(location, count, vector);
+}
+
+void eogllSetUniform1iLocation(GLint location, int v0) {
+    glUniform1i(location, v0);
+}
+
+void eogllSetUniform1ivLocation(GLint location, int* vector, GLsizei count) {
+    glUniform1iv(location, count, vector);
+}
+
+void eogllSetUniform1uiLocation(GLint location, unsigned int v0) {
+    glUniform1ui(location, v0);
+}
+
+void eogllSetUniform1uivLocation(GLint location, unsigned int* vector, GLsizei count) {
+    glUniform1uiv(location, count, vector);
+}
+
+void eogllSetUniformMatrix2fvLocation(GLint location, mat2 value) {
+    glUniformMatrix2fv(location, 1, GL_FALSE, (float*)value);
+}
+
+void eogllSetUniformMatrix3fvLocation(GLint location, mat3 value) {
+    glUniformMatrix3fv(location, 1, GL_FALSE, (float*)value);
+}
+
+void eogllSetUniform2flLocation(GLint location, vec2* vectors, GLsizei count) {
+    glUniform2fv(location, count, (float*)vectors);
+}
+
+void eogllSetUniform3flLocation(GLint location, vec3* vectors, GLsizei count) {
+    glUniform3fv(location, count, (float*)vectors);
+}
+
+void eogllSetUniform4flLocation(GLint location, vec4* vectors, GLsizei count) {
+    glUniform4fv(location, count, (float*)vectors);
+}
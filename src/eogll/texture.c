@@ -18,124 +18,108 @@ EogllTexture *eogllStartTexture() {
     glBindTexture(GL_TEXTURE_2D, texture->id);
     return texture;
 }
-void eogllFinishTexture(EogllTexture *texture, const char *path) {
-    int width, height, nrChannels;
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char *data = stbi_load(path, &width, &height, &nrChannels, 0);
-    if (!data) {
-        EOGLL_LOG_ERROR(stderr, "Failed to load texture %s\n", path);
-        return;
-    }
-    EOGLL_LOG_DEBUG(stdout, "Loaded texture %s\n", path);
-    EOGLL_LOG_DEBUG(stdout, "%d %d %d\n", width, height, nrChannels);
-    GLint format;
-    switch (nrChannels) {
+// the GL format for a number of channels, 0 if there isn't one
+static GLint eogllTextureFormat(int channels) {
+    switch (channels) {
         case 1:
-            format = GL_RED;
-            break;
+            return GL_RED;
         case 3:
-            format = GL_RGB;
-            break;
+            return GL_RGB;
         case 4:
-            format = GL_RGBA;
-            break;
+            return GL_RGBA;
         default:
-            EOGLL_LOG_ERROR(stderr, "Unknown number of channels %d\n", nrChannels);
-            return;
+            EOGLL_LOG_ERROR(stderr, "Unknown number of channels %d\n", channels);
+            return 0;
     }
-    texture->width = width;
-    texture->height = height;
-    texture->channels = nrChannels;
+}
+
+// uploads the image into the bound texture
+static EogllResult eogllUploadImage(EogllTexture *texture, const EogllImage *image) {
+    GLint format = eogllTextureFormat(image->channels);
+    if (!image->data || format == 0) {
+        return EOGLL_FAILURE;
+    }
+    texture->width = image->width;
+    texture->height = image->height;
+    texture->channels = image->channels;
     texture->format = format;
 
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+    glTexImage2D(GL_TEXTURE_2D, 0, format, image->width, image->height, 0, format, GL_UNSIGNED_BYTE, image->data);
     glGenerateMipmap(GL_TEXTURE_2D);
-    stbi_image_free(data);
+    return EOGLL_SUCCESS;
 }
 
-EogllTexture *eogllCreateTexture(const char *path) {
-    EogllTexture *texture = (EogllTexture *) malloc(sizeof(EogllTexture));
-    if (!texture) {
-        EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for texture\n");
-        return NULL;
-    }
-    int width, height, nrChannels;
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char *data = stbi_load(path, &width, &height, &nrChannels, 0);
-    if (!data) {
+EogllResult eogllDecodeImage(const char *path, EogllImage *image) {
+    // the flag is per thread, so images can be decoded on several threads at once
+    stbi_set_flip_vertically_on_load_thread(true);
+    image->data = stbi_load(path, &image->width, &image->height, &image->channels, 0);
+    if (!image->data) {
         EOGLL_LOG_ERROR(stderr, "Failed to load texture %s\n", path);
-        return NULL;
+        return EOGLL_FAILURE;
     }
     EOGLL_LOG_DEBUG(stdout, "Loaded texture %s\n", path);
-    EOGLL_LOG_DEBUG(stdout, "%d %d %d\n", width, height, nrChannels);
-    GLint format;
-    switch (nrChannels) {
-        case 1:
-            format = GL_RED;
-            break;
-        case 3:
-            format = GL_RGB;
-            break;
-        case 4:
-            format = GL_RGBA;
-            break;
-        default:
-            EOGLL_LOG_ERROR(stderr, "Unknown number of channels %d\n", nrChannels);
-            return NULL;
-    }
-    texture->width = width;
-    texture->height = height;
-    texture->channels = nrChannels;
-    texture->format = format;
-    glGenTextures(1, &texture->id);
-    glBindTexture(GL_TEXTURE_2D, texture->id);
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
+    EOGLL_LOG_DEBUG(stdout, "%d %d %d\n", image->width, image->height, image->channels);
+    return EOGLL_SUCCESS;
+}
 
-    stbi_image_free(data);
-    return texture;
+EogllResult eogllDecodeImageFromBuffer(const uint8_t *buffer, size_t size, EogllImage *image) {
+    stbi_set_flip_vertically_on_load_thread(true);
+    image->data = stbi_load_from_memory(buffer, (int)size, &image->width, &image->height, &image->channels, 0);
+    if (!image->data) {
+        EOGLL_LOG_ERROR(stderr, "Failed to load texture from buffer\n");
+        return EOGLL_FAILURE;
+    }
+    EOGLL_LOG_DEBUG(stdout, "Loaded texture from buffer\n");
+    EOGLL_LOG_DEBUG(stdout, "%d %d %d\n", image->width, image->height, image->channels);
+    return EOGLL_SUCCESS;
 }
 
-EogllTexture* eogllCreateTextureFromBuffer(const uint8_t* buffer, size_t size) {
+EogllTexture *eogllCreateTextureFromImage(const EogllImage *image) {
+    if (!image->data || eogllTextureFormat(image->channels) == 0) {
+        return NULL;
+    }
     EogllTexture *texture = (EogllTexture *) malloc(sizeof(EogllTexture));
     if (!texture) {
         EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for texture\n");
         return NULL;
     }
-    int width, height, nrChannels;
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char *data = stbi_load_from_memory(buffer, size, &width, &height, &nrChannels, 0);
-    if (!data) {
-        EOGLL_LOG_ERROR(stderr, "Failed to load texture from buffer\n");
-        return NULL;
-    }
-    EOGLL_LOG_DEBUG(stdout, "Loaded texture from buffer\n");
-    EOGLL_LOG_DEBUG(stdout, "%d %d %d\n", width, height, nrChannels);
-    GLint format;
-    switch (nrChannels) {
-        case 1:
-            format = GL_RED;
-            break;
-        case 3:
-            format = GL_RGB;
-            break;
-        case 4:
-            format = GL_RGBA;
-            break;
-        default:
-            EOGLL_LOG_ERROR(stderr, "Unknown number of channels %d\n", nrChannels);
-            return NULL;
-    }
-    texture->width = width;
-    texture->height = height;
-    texture->channels = nrChannels;
-    texture->format = format;
     glGenTextures(1, &texture->id);
     glBindTexture(GL_TEXTURE_2D, texture->id);
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
+    eogllUploadImage(texture, image);
+    return texture;
+}
 
-    stbi_image_free(data);
+void eogllFreeImage(EogllImage *image) {
+    stbi_image_free(image->data);
+    image->data = NULL;
+}
+
+void eogllFinishTexture(EogllTexture *texture, const char *path) {
+    EogllImage image;
+    if (eogllDecodeImage(path, &image) != EOGLL_SUCCESS) {
+        return;
+    }
+    eogllUploadImage(texture, &image);
+    eogllFreeImage(&image);
+}
+
+EogllTexture *eogllCreateTexture(const char *path) {
+    EogllImage image;
+    if (eogllDecodeImage(path, &image) != EOGLL_SUCCESS) {
+        return NULL;
+    }
+    EogllTexture *texture = eogllCreateTextureFromImage(&image);
+    eogllFreeImage(&image);
+    return texture;
+}
+
+EogllTexture* eogllCreateTextureFromBuffer(const uint8_t* buffer, size_t size) {
+    EogllImage image;
+    if (eogllDecodeImageFromBuffer(buffer, size, &image) != EOGLL_SUCCESS) {
+        return NULL;
+    }
+    EogllTexture *texture = eogllCreateTextureFromImage(&image);
+    eogllFreeImage(&image);
     return texture;
 }
 
@@ -158,6 +142,19 @@ void eogllBindTextureUniform(EogllTexture* texture, EogllShaderProgram* shader,
     eogllSetUniform1i(shader, name, (int)index);
 }
 
+void eogllBindTextureLocation(EogllTexture* texture, GLint location, unsigned int index) {
+    if (location < 0) {
+        return;
+    }
+    if (index >= __eogll_texture_max_texture_units) {
+        EOGLL_LOG_ERROR(stderr, "Texture unit %d is not supported\n", index);
+        return;
+    }
+    glActiveTexture(GL_TEXTURE0 + index);
+    glBindTexture(GL_TEXTURE_2D, texture->id);
+    glUniform1i(location, (int)index);
+}
+
 void eogllBindTextureUniformi(GLuint texture, EogllShaderProgram* shader, const char* name, unsigned int index) {
     if (index >= __eogll_texture_max_texture_units) {
         EOGLL_LOG_ERROR(stderr, "Texture unit %d is not supported\n", index);
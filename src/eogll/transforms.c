@@ -26,7 +26,8 @@ EogllProjection eogllOrthographicProjection(float near, float far) {
     return projection;
 }
 
-void eogllUpdateProjectionMatrix(EogllProjection* projection, EogllShaderProgram* shader, const char* name, uint32_t width, uint32_t height) {
+// recomputes the matrix of the window size when it changed
+static void eogllResizeProjection(EogllProjection* projection, uint32_t width, uint32_t height) {
     if (!projection->isOrtho) {
         if (width != projection->lastWidth || height != projection->lastHeight) {
             glm_perspective(projection->fov, (float)width / (float)height, projection->near, projection->far, projection->projection);
@@ -43,9 +44,18 @@ void eogllUpdateProjectionMatrix(EogllProjection* projection, EogllShaderProgram
         }
         EOGLL_LOG_WARN(stderr, "Orthographic projection calling perspective projection update function");
     }
+}
+
+void eogllUpdateProjectionMatrix(EogllProjection* projection, EogllShaderProgram* shader, const char* name, uint32_t width, uint32_t height) {
+    eogllResizeProjection(projection, width, height);
     eogllSetUniformMatrix4fv(shader, name, projection->projection);
 }
 
+void eogllUpdateProjectionUniforms(EogllProjection* projection, EogllFrameUniformBuffer* frame, uint32_t width, uint32_t height) {
+    eogllResizeProjection(projection, width, height);
+    eogllSetFrameProjection(frame, projection->projection);
+}
+
 void eogllUpdateProjectionMatrixOrtho(EogllProjection* projection, EogllShaderProgram* shader, const char* name, float top, float bottom, float left, float right) {
     if (!projection->isOrtho) {
         float width = right - left;
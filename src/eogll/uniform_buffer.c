@@ -0,0 +1,118 @@
+#include "eogll/uniform_buffer.h"
+
+#include "eogll/logging.h"
+
+size_t eogllStd140Align(size_t offset, size_t alignment) {
+    return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+static size_t eogllStd140Write(void* buffer, size_t offset, size_t alignment, const void* value, size_t size) {
+    offset = eogllStd140Align(offset, alignment);
+    if (buffer) {
+        memcpy((unsigned char*)buffer + offset, value, size);
+    }
+    return offset + size;
+}
+
+size_t eogllStd140Float(void* buffer, size_t offset, float value) {
+    return eogllStd140Write(buffer, offset, 4, &value, sizeof(float));
+}
+
+size_t eogllStd140Int(void* buffer, size_t offset, int value) {
+    return eogllStd140Write(buffer, offset, 4, &value, sizeof(int));
+}
+
+size_t eogllStd140Vec2(void* buffer, size_t offset, vec2 value) {
+    return eogllStd140Write(buffer, offset, 8, value, sizeof(float) * 2);
+}
+
+size_t eogllStd140Vec3(void* buffer, size_t offset, vec3 value) {
+    return eogllStd140Write(buffer, offset, 16, value, sizeof(float) * 3);
+}
+
+size_t eogllStd140Vec4(void* buffer, size_t offset, vec4 value) {
+    return eogllStd140Write(buffer, offset, 16, value, sizeof(float) * 4);
+}
+
+size_t eogllStd140Mat3(void* buffer, size_t offset, mat3 value) {
+    // every column takes a whole vec4
+    for (int i = 0; i < 3; i++) {
+        offset = eogllStd140Write(buffer, offset, 16, value[i], sizeof(float) * 3);
+    }
+    return eogllStd140Align(offset, 16);
+}
+
+size_t eogllStd140Mat4(void* buffer, size_t offset, mat4 value) {
+    return eogllStd140Write(buffer, offset, 16, value, sizeof(float) * 16);
+}
+
+// writes the block in the layout the shaders declare (NULL to get its size)
+static size_t eogllWriteFrameUniforms(void* buffer, EogllFrameUniforms* values) {
+    size_t offset = 0;
+    offset = eogllStd140Mat4(buffer, offset, values->view);
+    offset = eogllStd140Mat4(buffer, offset, values->projection);
+    offset = eogllStd140Vec3(buffer, offset, values->viewPos);
+    offset = eogllStd140Float(buffer, offset, values->time);
+    return eogllStd140Align(offset, 16);
+}
+
+EogllFrameUniformBuffer* eogllCreateFrameUniformBuffer() {
+    EogllFrameUniformBuffer* buffer = (EogllFrameUniformBuffer*)malloc(sizeof(EogllFrameUniformBuffer));
+    if (!buffer) {
+        EOGLL_LOG_ERROR(stderr, "Failed to allocate memory for the frame uniform buffer\n");
+        return NULL;
+    }
+    memset(buffer, 0, sizeof(EogllFrameUniformBuffer));
+    glm_mat4_identity(buffer->values.view);
+    glm_mat4_identity(buffer->values.projection);
+    buffer->binding = EOGLL_FRAME_UNIFORMS_BINDING;
+    buffer->dirty = true;
+
+    glGenBuffers(1, &buffer->ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer->ubo);
+    glBufferData(GL_UNIFORM_BUFFER, (GLsizeiptr)eogllWriteFrameUniforms(NULL, &buffer->values), NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, buffer->binding, buffer->ubo);
+    return buffer;
+}
+
+void eogllSetFrameView(EogllFrameUniformBuffer* buffer, mat4 view, vec3 viewPos) {
+    if (memcmp(buffer->values.view, view, sizeof(mat4)) != 0 || memcmp(buffer->values.viewPos, viewPos, sizeof(vec3)) != 0) {
+        glm_mat4_copy(view, buffer->values.view);
+        glm_vec3_copy(viewPos, buffer->values.viewPos);
+        buffer->dirty = true;
+    }
+}
+
+void eogllSetFrameProjection(EogllFrameUniformBuffer* buffer, mat4 projection) {
+    if (memcmp(buffer->values.projection, projection, sizeof(mat4)) != 0) {
+        glm_mat4_copy(projection, buffer->values.projection);
+        buffer->dirty = true;
+    }
+}
+
+void eogllSetFrameTime(EogllFrameUniformBuffer* buffer, float time) {
+    if (buffer->values.time != time) {
+        buffer->values.time = time;
+        buffer->dirty = true;
+    }
+}
+
+void eogllUploadFrameUniforms(EogllFrameUniformBuffer* buffer) {
+    if (buffer->dirty) {
+        unsigned char data[256];
+        size_t size = eogllWriteFrameUniforms(data, &buffer->values);
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer->ubo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, (GLsizeiptr)size, data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        buffer->dirty = false;
+        buffer->uploads++;
+    }
+    // something else may have used the binding point since the last frame
+    glBindBufferBase(GL_UNIFORM_BUFFER, buffer->binding, buffer->ubo);
+}
+
+void eogllDeleteFrameUniformBuffer(EogllFrameUniformBuffer* buffer) {
+    glDeleteBuffers(1, &buffer->ubo);
+    free(buffer);
+}
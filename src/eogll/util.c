@@ -2,6 +2,18 @@
 
 #include "eogll/logging.h"
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#endif
+
 char* eogllReadFile(const char* path) {
     EOGLL_LOG_TRACE(stdout, "%s\n", path);
     FILE* file = fopen(path, "rb");
@@ -23,10 +35,199 @@ char* eogllReadFile(const char* path) {
     return buffer;
 }
 
+EogllResult eogllMapFile(const char* path, EogllMappedFile* file) {
+    EOGLL_LOG_TRACE(stdout, "%s\n", path);
+    file->data = NULL;
+    file->size = 0;
+    file->handle = NULL;
+    file->heap = false;
+#ifdef _WIN32
+    HANDLE fh = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (fh == INVALID_HANDLE_VALUE) {
+        EOGLL_LOG_ERROR(stderr, "Failed to open file %s\n", path);
+        return EOGLL_FAILURE;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(fh, &size)) {
+        EOGLL_LOG_ERROR(stderr, "Failed to get size of file %s\n", path);
+        CloseHandle(fh);
+        return EOGLL_FAILURE;
+    }
+    file->size = (size_t)size.QuadPart;
+    if (file->size == 0) {
+        CloseHandle(fh);
+        return EOGLL_SUCCESS;
+    }
+    HANDLE mapping = CreateFileMappingA(fh, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(fh);
+    if (!mapping) {
+        EOGLL_LOG_ERROR(stderr, "Failed to map file %s\n", path);
+        return EOGLL_FAILURE;
+    }
+    file->data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!file->data) {
+        EOGLL_LOG_ERROR(stderr, "Failed to map file %s\n", path);
+        CloseHandle(mapping);
+        return EOGLL_FAILURE;
+    }
+    file->handle = mapping;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        EOGLL_LOG_ERROR(stderr, "Failed to open file %s\n", path);
+        return EOGLL_FAILURE;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        EOGLL_LOG_ERROR(stderr, "Failed to get size of file %s\n", path);
+        close(fd);
+        return EOGLL_FAILURE;
+    }
+    file->size = (size_t)st.st_size;
+    if (file->size == 0) {
+        close(fd);
+        return EOGLL_SUCCESS;
+    }
+    void* data = mmap(NULL, file->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        // some filesystems can't be mapped, fall back to reading the whole thing
+        char* buffer = eogllReadFile(path);
+        if (!buffer) {
+            return EOGLL_FAILURE;
+        }
+        file->data = buffer;
+        file->heap = true;
+        return EOGLL_SUCCESS;
+    }
+#ifdef MADV_SEQUENTIAL
+    madvise(data, file->size, MADV_SEQUENTIAL);
+#endif
+    file->data = (const char*)data;
+#endif
+    return EOGLL_SUCCESS;
+}
+
+void eogllUnmapFile(EogllMappedFile* file) {
+    if (file->data) {
+        if (file->heap) {
+            free((void*)file->data);
+        } else {
+#ifdef _WIN32
+            UnmapViewOfFile(file->data);
+            CloseHandle((HANDLE)file->handle);
+#else
+            munmap((void*)file->data, file->size);
+#endif
+        }
+    }
+    file->data = NULL;
+    file->size = 0;
+    file->handle = NULL;
+    file->heap = false;
+}
+
+void eogllReleaseMappedRange(EogllMappedFile* file, size_t offset, size_t size) {
+    if (!file->data || file->heap || offset >= file->size) {
+        return;
+    }
+    if (size > file->size - offset) {
+        size = file->size - offset;
+    }
+#ifdef _WIN32
+    // unlocking pages that aren't locked removes them from the working set
+    VirtualUnlock((LPVOID)(file->data + offset), size);
+#else
+    // only whole pages can be released, the mapping itself is page aligned
+    size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    size_t begin = (offset + pageSize - 1) / pageSize * pageSize;
+    size_t end = (offset + size) / pageSize * pageSize;
+    if (end > begin) {
+        madvise((void*)(file->data + begin), end - begin, MADV_DONTNEED);
+    }
+#endif
+}
+
+EogllResult eogllGetFileInfo(const char* path, uint64_t* modifiedTime, uint64_t* size) {
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA info;
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &info)) {
+        return EOGLL_FAILURE;
+    }
+    *modifiedTime = ((uint64_t)info.ftLastWriteTime.dwHighDateTime << 32) | info.ftLastWriteTime.dwLowDateTime;
+    *size = ((uint64_t)info.nFileSizeHigh << 32) | info.nFileSizeLow;
+#else
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        return EOGLL_FAILURE;
+    }
+    // in nanoseconds, so a file rewritten within the same second (with the same size) still looks changed
+#ifdef __APPLE__
+    *modifiedTime = (uint64_t)st.st_mtimespec.tv_sec * 1000000000ull + (uint64_t)st.st_mtimespec.tv_nsec;
+#else
+    *modifiedTime = (uint64_t)st.st_mtim.tv_sec * 1000000000ull + (uint64_t)st.st_mtim.tv_nsec;
+#endif
+    *size = (uint64_t)st.st_size;
+#endif
+    return EOGLL_SUCCESS;
+}
+
+EogllResult eogllResolveRelativePath(const char* base, const char* relative, char* out, size_t size) {
+    size_t directoryLength = 0;
+    bool absolute = relative[0] == '/' || relative[0] == '\\' || (relative[0] != '\0' && relative[1] == ':');
+    if (!absolute) {
+        for (size_t i = 0; base[i] != '\0'; i++) {
+            if (base[i] == '/' || base[i] == '\\') {
+                directoryLength = i + 1;
+            }
+        }
+    }
+    size_t relativeLength = strlen(relative);
+    if (directoryLength + relativeLength + 1 > size) {
+        EOGLL_LOG_ERROR(stderr, "Path %s relative to %s is too long\n", relative, base);
+        return EOGLL_FAILURE;
+    }
+    memcpy(out, base, directoryLength);
+    memcpy(out + directoryLength, relative, relativeLength + 1);
+    return EOGLL_SUCCESS;
+}
+
 double eogllGetTime() {
     return (double)glfwGetTime();
 }
 
+unsigned int eogllGetProcessorCount() {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (unsigned int)info.dwNumberOfProcessors : 1;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (unsigned int)count : 1;
+#endif
+}
+
+size_t eogllGetPeakMemoryUsage() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return 0;
+    }
+    return (size_t)counters.PeakWorkingSetSize;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    // bytes on macOS
+    return (size_t)usage.ru_maxrss;
+#else
+    // kilobytes everywhere else
+    return (size_t)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
 
 GLint eogllSizeOf(GLenum type) {
     // glVertexAttribPointer or glVertexAttribIPointer: GL_BYTE, GL_UNSIGNED_BYTE, GL_SHORT, GL_UNSIGNED_SHORT, GL_INT, and GL_UNSIGNED_INT
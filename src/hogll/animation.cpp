@@ -0,0 +1,303 @@
+#include "hogll/animation.hpp"
+
+namespace ogl {
+    int Skeleton::add(const std::string& name, const glm::mat4& offset) {
+        auto inserted = index.emplace(name, (int)offsets.size());
+        if (inserted.second) {
+            names.push_back(name);
+            offsets.push_back(offset);
+            parents.push_back(-1);
+            nodes.push_back(-1);
+        }
+        return inserted.first->second;
+    }
+
+    int Skeleton::find(const std::string& name) const {
+        auto bone = index.find(name);
+        return bone != index.end() ? bone->second : -1;
+    }
+
+    void Skeleton::finishLoading() {
+        std::unordered_map<std::string, int>().swap(index);
+    }
+
+    NodeHierarchy::NodeHierarchy(const aiScene* scene, Skeleton& skeleton) {
+        if (!scene || !scene->mRootNode) {
+            return;
+        }
+        globalInverse = glm::inverse(convertToGLM(scene->mRootNode->mTransformation));
+
+        // depth first, so every node is added after its parent
+        std::vector<std::pair<const aiNode*, int>> stack;
+        stack.emplace_back(scene->mRootNode, -1);
+        while (!stack.empty()) {
+            const aiNode* node = stack.back().first;
+            int parent = stack.back().second;
+            stack.pop_back();
+
+            int index = (int)parents.size();
+            names.emplace_back(node->mName.C_Str());
+            parents.push_back(parent);
+            transforms.push_back(convertToGLM(node->mTransformation));
+            int bone = skeleton.find(names.back());
+            bones.push_back(bone);
+            if (bone >= 0) {
+                skeleton.nodes[bone] = index;
+                // the parent is already in, so its closest bone is known
+                int ancestor = parent;
+                while (ancestor >= 0 && bones[ancestor] < 0) {
+                    ancestor = parents[ancestor];
+                }
+                skeleton.parents[bone] = ancestor >= 0 ? bones[ancestor] : -1;
+            }
+
+            // pushed in reverse so children come out in their original order
+            for (unsigned int i = node->mNumChildren; i > 0; i--) {
+                stack.emplace_back(node->mChildren[i - 1], index);
+            }
+        }
+        if (skeleton.size() > MAX_BONES) {
+            EOGLL_LOG_WARN(stderr, "Model has %zu bones, only the first %d can be animated\n", skeleton.size(), MAX_BONES);
+        }
+    }
+
+    Animation::Animation(const aiAnimation* animation, const NodeHierarchy& hierarchy) {
+        name = animation->mName.C_Str();
+        duration = (float)animation->mDuration;
+        ticksPerSecond = animation->mTicksPerSecond != 0.0 ? (float)animation->mTicksPerSecond : 25.0f;
+        nodeChannels.assign(hierarchy.size(), -1);
+
+        std::unordered_map<std::string, int> nodes;
+        for (size_t i = 0; i < hierarchy.size(); i++) {
+            nodes.emplace(hierarchy.names[i], (int)i);
+        }
+
+        channels.reserve(animation->mNumChannels);
+        for (unsigned int i = 0; i < animation->mNumChannels; i++) {
+            const aiNodeAnim* nodeAnim = animation->mChannels[i];
+            auto node = nodes.find(nodeAnim->mNodeName.C_Str());
+            if (node == nodes.end()) {
+                EOGLL_LOG_WARN(stderr, "Animation %s moves node %s, which isn't in the model\n", name.c_str(), nodeAnim->mNodeName.C_Str());
+                continue;
+            }
+            AnimationChannel channel;
+            channel.node = node->second;
+            channel.positionTimes.reserve(nodeAnim->mNumPositionKeys);
+            channel.positions.reserve(nodeAnim->mNumPositionKeys);
+            for (unsigned int k = 0; k < nodeAnim->mNumPositionKeys; k++) {
+                const aiVectorKey& key = nodeAnim->mPositionKeys[k];
+                channel.positionTimes.push_back((float)key.mTime);
+                channel.positions.emplace_back(key.mValue.x, key.mValue.y, key.mValue.z);
+            }
+            channel.rotationTimes.reserve(nodeAnim->mNumRotationKeys);
+            channel.rotations.reserve(nodeAnim->mNumRotationKeys);
+            for (unsigned int k = 0; k < nodeAnim->mNumRotationKeys; k++) {
+                const aiQuatKey& key = nodeAnim->mRotationKeys[k];
+                channel.rotationTimes.push_back((float)key.mTime);
+                channel.rotations.emplace_back(key.mValue.w, key.mValue.x, key.mValue.y, key.mValue.z);
+            }
+            channel.scaleTimes.reserve(nodeAnim->mNumScalingKeys);
+            channel.scales.reserve(nodeAnim->mNumScalingKeys);
+            for (unsigned int k = 0; k < nodeAnim->mNumScalingKeys; k++) {
+                const aiVectorKey& key = nodeAnim->mScalingKeys[k];
+                channel.scaleTimes.push_back((float)key.mTime);
+                channel.scales.emplace_back(key.mValue.x, key.mValue.y, key.mValue.z);
+            }
+            nodeChannels[channel.node] = (int)channels.size();
+            channels.push_back(std::move(channel));
+        }
+        EOGLL_LOG_DEBUG(stdout, "Loaded animation %s with %zu channels, %.1f ticks\n", name.c_str(), channels.size(), duration);
+    }
+
+    AnimationState::AnimationState(const Animation* animation, bool loop) {
+        play(animation, loop);
+    }
+
+    void AnimationState::play(const Animation* animation, bool loop) {
+        this->animation = animation;
+        this->loop = loop;
+        time = 0.0f;
+        keys.assign(animation ? animation->channels.size() * 3 : 0, 0);
+    }
+
+    void AnimationState::update(float dt) {
+        if (!animation) {
+            return;
+        }
+        time += dt * animation->ticksPerSecond;
+        if (animation->duration <= 0.0f) {
+            time = 0.0f;
+        } else if (loop) {
+            time = fmodf(time, animation->duration);
+            if (time < 0.0f) {
+                time += animation->duration;
+            }
+        } else if (time > animation->duration) {
+            time = animation->duration;
+        }
+    }
+
+    // the key to interpolate from at time (times has at least 2 keys), cached is the key found last time
+    static uint32_t findKey(const std::vector<float>& times, float time, uint32_t& cached) {
+        uint32_t last = (uint32_t)times.size() - 2;
+        uint32_t key = cached < last ? cached : last;
+        if (times[key] <= time) {
+            // a frame usually moves by no more than a key or two
+            for (int step = 0; step < 4; step++) {
+                if (key == last || times[key + 1] > time) {
+                    cached = key;
+                    return key;
+                }
+                key++;
+            }
+        }
+        // went backwards (the animation looped) or skipped far ahead
+        key = (uint32_t)(std::upper_bound(times.begin(), times.end(), time) - times.begin());
+        key = key > 0 ? key - 1 : 0;
+        key = key < last ? key : last;
+        cached = key;
+        return key;
+    }
+
+    // how far time is from the key to the next one (0 to 1)
+    static float keyFactor(const std::vector<float>& times, uint32_t key, float time) {
+        float span = times[key + 1] - times[key];
+        if (span <= 0.0f) {
+            return 0.0f;
+        }
+        float factor = (time - times[key]) / span;
+        return factor < 0.0f ? 0.0f : (factor > 1.0f ? 1.0f : factor);
+    }
+
+    static glm::vec3 sampleVector(const std::vector<float>& times, const std::vector<glm::vec3>& values, float time, uint32_t& cached, const glm::vec3& fallback) {
+        if (values.empty()) {
+            return fallback;
+        }
+        if (values.size() == 1) {
+            return values[0];
+        }
+        uint32_t key = findKey(times, time, cached);
+        return glm::mix(values[key], values[key + 1], keyFactor(times, key, time));
+    }
+
+    static glm::quat sampleRotation(const std::vector<float>& times, const std::vector<glm::quat>& values, float time, uint32_t& cached) {
+        if (values.empty()) {
+            return glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+        }
+        if (values.size() == 1) {
+            return values[0];
+        }
+        uint32_t key = findKey(times, time, cached);
+        return glm::normalize(glm::slerp(values[key], values[key + 1], keyFactor(times, key, time)));
+    }
+
+    // translation * rotation * scale, built directly instead of multiplying three matrices
+    static void composeTransform(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale, glm::mat4& out) {
+        glm::mat3 r = glm::mat3_cast(rotation);
+        out[0] = glm::vec4(r[0] * scale.x, 0.0f);
+        out[1] = glm::vec4(r[1] * scale.y, 0.0f);
+        out[2] = glm::vec4(r[2] * scale.z, 0.0f);
+        out[3] = glm::vec4(position, 1.0f);
+    }
+
+    void Pose::evaluate(const NodeHierarchy& hierarchy, const Skeleton& skeleton, AnimationState& state) {
+        size_t numNodes = hierarchy.size();
+        globals.resize(numNodes);
+        // bones no node moves stay where they are
+        palette.resize(skeleton.size(), glm::mat4(1.0f));
+
+        const Animation* animation = state.animation;
+        if (animation && animation->nodeChannels.size() != numNodes) {
+            EOGLL_LOG_ERROR(stderr, "Animation %s was loaded for another model\n", animation->name.c_str());
+            animation = nullptr;
+        }
+        if (animation && state.keys.size() != animation->channels.size() * 3) {
+            state.keys.assign(animation->channels.size() * 3, 0);
+        }
+
+        glm::mat4 local;
+        for (size_t i = 0; i < numNodes; i++) {
+            const glm::mat4* transform = &hierarchy.transforms[i];
+            int channelIndex = animation ? animation->nodeChannels[i] : -1;
+            if (channelIndex >= 0) {
+                const AnimationChannel& channel = animation->channels[channelIndex];
+                uint32_t* keys = &state.keys[channelIndex * 3];
+                // tracks without keys keep the bind pose's value
+                glm::vec3 bindPosition = glm::vec3(hierarchy.transforms[i][3]);
+                glm::vec3 position = sampleVector(channel.positionTimes, channel.positions, state.time, keys[0], bindPosition);
+                glm::quat rotation = sampleRotation(channel.rotationTimes, channel.rotations, state.time, keys[1]);
+                glm::vec3 scale = sampleVector(channel.scaleTimes, channel.scales, state.time, keys[2], glm::vec3(1.0f));
+                composeTransform(position, rotation, scale, local);
+                transform = &local;
+            }
+
+            // the root starts from globalInverse, so every global transform is relative to the model
+            int parent = hierarchy.parents[i];
+            internal::multiply(parent >= 0 ? globals[parent] : hierarchy.globalInverse, *transform, globals[i]);
+
+            int bone = hierarchy.bones[i];
+            if (bone >= 0) {
+                internal::multiply(globals[i], skeleton.offsets[bone], palette[bone]);
+            }
+        }
+    }
+
+    BonePaletteBuffer::BonePaletteBuffer(GLuint binding, size_t maxInstances) : binding(binding), capacity(maxInstances) {
+        GLint alignment = 256;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        if (alignment <= 0) {
+            alignment = 256;
+        }
+        stride = (MAX_BONES * sizeof(glm::mat4) + alignment - 1) / alignment * alignment;
+        staging.resize(stride * capacity);
+        glGenBuffers(1, &ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, (GLsizeiptr)staging.size(), nullptr, GL_STREAM_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    BonePaletteBuffer::~BonePaletteBuffer() {
+        glDeleteBuffers(1, &ubo);
+    }
+
+    void BonePaletteBuffer::bindProgram(EogllShaderProgram* shader, const char* block) {
+        GLuint index = glGetUniformBlockIndex(shader->id, block);
+        if (index == GL_INVALID_INDEX) {
+            EOGLL_LOG_WARN(stderr, "Shader has no uniform block %s\n", block);
+            return;
+        }
+        glUniformBlockBinding(shader->id, index, binding);
+    }
+
+    void BonePaletteBuffer::begin() {
+        count = 0;
+    }
+
+    int BonePaletteBuffer::add(const Pose& pose) {
+        if (count == capacity) {
+            EOGLL_LOG_WARN(stderr, "Bone palette buffer is full (%zu instances)\n", capacity);
+            return -1;
+        }
+        size_t bones = pose.palette.size() < (size_t)MAX_BONES ? pose.palette.size() : (size_t)MAX_BONES;
+        memcpy(staging.data() + count * stride, pose.palette.data(), bones * sizeof(glm::mat4));
+        return (int)count++;
+    }
+
+    void BonePaletteBuffer::upload() {
+        if (count == 0) {
+            return;
+        }
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        // orphaning the old storage keeps the driver from waiting on draws that still read last frame's palettes
+        glBufferData(GL_UNIFORM_BUFFER, (GLsizeiptr)staging.size(), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, (GLsizeiptr)(count * stride), staging.data());
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    void BonePaletteBuffer::bind(int slot) {
+        if (slot < 0 || (size_t)slot >= count) {
+            return;
+        }
+        glBindBufferRange(GL_UNIFORM_BUFFER, binding, ubo, (GLintptr)(slot * stride), (GLsizeiptr)(MAX_BONES * sizeof(glm::mat4)));
+    }
+}
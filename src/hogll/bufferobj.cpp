@@ -33,4 +33,47 @@ namespace ogl {
         return &buffer;
     }
 
+    RangedBufferObject::RangedBufferObject() {
+        memset(&buffer, 0, sizeof(buffer));
+    }
+    RangedBufferObject::~RangedBufferObject() {
+        if (buffer.buffer.vao != 0) {
+            eogllDeleteRangedBufferObject(&buffer);
+        }
+    }
+    RangedBufferObject::RangedBufferObject(RangedBufferObject&& other) noexcept : buffer(other.buffer) {
+        memset(&other.buffer, 0, sizeof(other.buffer));
+    }
+    RangedBufferObject& RangedBufferObject::operator=(RangedBufferObject&& other) noexcept {
+        if (this != &other) {
+            if (buffer.buffer.vao != 0) {
+                eogllDeleteRangedBufferObject(&buffer);
+            }
+            buffer = other.buffer;
+            memset(&other.buffer, 0, sizeof(other.buffer));
+        }
+        return *this;
+    }
+    void RangedBufferObject::draw(GLenum mode, const std::function<void(const EogllDrawRange&)>& setMaterial) {
+        eogllDrawRangedBufferObject(&buffer, mode, [](const EogllDrawRange* range, void* user) {
+            (*static_cast<const std::function<void(const EogllDrawRange&)>*>(user))(*range);
+        }, const_cast<std::function<void(const EogllDrawRange&)>*>(&setMaterial));
+    }
+
+    void RangedBufferObject::draw(GLenum mode, EogllDrawRangeFunc setMaterial, void* user) {
+        eogllDrawRangedBufferObject(&buffer, mode, setMaterial, user);
+    }
+
+    void RangedBufferObject::bind() {
+        eogllBindBufferObject(&buffer.buffer);
+    }
+
+    void RangedBufferObject::drawRange(GLenum mode, uint32_t index) const {
+        eogllDrawRange(&buffer, mode, index);
+    }
+
+    EogllRangedBufferObject* RangedBufferObject::getBuffer() {
+        return &buffer;
+    }
+
 }
\ No newline at end of file
@@ -1,19 +1,10 @@
 #include "hogll/model.hpp"
 
 namespace ogl {
-    inline glm::mat4 convertToGLM(aiMatrix4x4 mat) {
-        glm::mat4 result;
-        result[0][0] = mat.a1; result[0][1] = mat.a2; result[0][2] = mat.a3; result[0][3] = mat.a4;
-        result[1][0] = mat.b1; result[1][1] = mat.b2; result[1][2] = mat.b3; result[1][3] = mat.b4;
-        result[2][0] = mat.c1; result[2][1] = mat.c2; result[2][2] = mat.c3; result[2][3] = mat.c4;
-        result[3][0] = mat.d1; result[3][1] = mat.d2; result[3][2] = mat.d3; result[3][3] = mat.d4;
-        return result;
-    }
-
     ModelAttr::ModelAttr() {}
     ModelAttr::ModelAttr(GLenum type, GLint num, ModelAttrType attr) : type(type), size(num*eogllSizeOf(type)), attr(attr) {}
 
-    int ModelAttr::num() {
+    int ModelAttr::num() const {
         return size / eogllSizeOf(type);
     }
 
@@ -25,7 +16,7 @@ namespace ogl {
         for (int i = 0; i < obj_attrs.size(); i++) {
             EogllObjectAttr attr = obj_attrs.attrs()[i];
             EogllVertAttribData vab = obj_attrs.getBuffer()->builder.attribs[i];
-            add(vab.type, vab.size, getAttrType(attr.type));
+            add(vab.type, vab.num, getAttrType(attr.type));
         }
     }
 
@@ -37,15 +28,15 @@ namespace ogl {
         return attrs;
     }
 
-    int ModelAttrs::num() {
+    int ModelAttrs::num() const {
         int s = 0;
-        for (ModelAttr a : attrs) {
+        for (const ModelAttr& a : attrs) {
             s += a.size / eogllSizeOf(a.type);
         }
         return s;
     }
 
-    int ModelAttrs::size() {
+    int ModelAttrs::size() const {
         return attrs.size();
     }
 
@@ -53,6 +44,38 @@ namespace ogl {
         return attrs[i];
     }
 
+    const ModelAttr& ModelAttrs::operator[](int i) const {
+        return attrs[i];
+    }
+
+    bool ModelAttrs::has(ModelAttrType attr) const {
+        for (const ModelAttr& a : attrs) {
+            if (a.attr == attr) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    unsigned int ModelAttrs::importFlags() const {
+        // what aiProcessPreset_TargetRealtime_MaxQuality does that every model needs
+        // (tangents and splitting large meshes are left out, there is no tangent attribute and the indices are 32 bit)
+        unsigned int flags = aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_SortByPType |
+                             aiProcess_ImproveCacheLocality | aiProcess_RemoveRedundantMaterials | aiProcess_FindDegenerates |
+                             aiProcess_FindInvalidData | aiProcess_FindInstances | aiProcess_OptimizeMeshes | aiProcess_ValidateDataStructure;
+        if (has(NORMAL)) {
+            flags |= aiProcess_GenSmoothNormals;
+        }
+        if (has(TEXTURE)) {
+            flags |= aiProcess_GenUVCoords;
+        }
+        if (has(BONE_IDS) || has(BONE_WEIGHTS)) {
+            // the vertices hold 4 bones
+            flags |= aiProcess_LimitBoneWeights;
+        }
+        return flags;
+    }
+
 
 
     void ModelAttrs::build(int vao) {
@@ -64,7 +87,12 @@ namespace ogl {
         uint64_t offset = 0;
         for (int i = 0; i < attrs.size(); i++) {
             ModelAttr a = attrs[i];
-            glVertexAttribPointer(i, a.size / eogllSizeOf(a.type), a.type, GL_FALSE, stride, (void*)offset);
+            if (a.type == GL_FLOAT || a.type == GL_HALF_FLOAT || a.type == GL_DOUBLE) {
+                glVertexAttribPointer(i, a.size / eogllSizeOf(a.type), a.type, GL_FALSE, stride, (void*)offset);
+            } else {
+                // integer attributes (like the bone ids) would be converted to floats by glVertexAttribPointer
+                glVertexAttribIPointer(i, a.size / eogllSizeOf(a.type), a.type, stride, (void*)offset);
+            }
             glEnableVertexAttribArray(i);
             offset += a.size;
         }
@@ -85,61 +113,213 @@ namespace ogl {
 
 
     namespace internal {
-        GlMesh packMesh(Mesh mesh, ModelAttrs attrs) {
-            GlMesh glMesh;
+        std::atomic<size_t>& allocationCount() {
+            static std::atomic<size_t> count(0);
+            return count;
+        }
 
-            glMesh.vert.reserve(attrs.num());
-            
-            for (const Vertex& vert : mesh.vert) {
-                for (int i = 0; i < attrs.size(); i++) {
-                    ModelAttr a = attrs[i];
-                    switch (a.attr) {
-                        case POSITION: {
-                            if (a.num() >= 1) glMesh.vert.push_back(vert.pos.x);
-                            if (a.num() >= 2) glMesh.vert.push_back(vert.pos.y);
-                            if (a.num() >= 3) glMesh.vert.push_back(vert.pos.z);
-                            break;
-                        }
-                        case NORMAL: {
-                            if (a.num() >= 1) glMesh.vert.push_back(vert.norm.x);
-                            if (a.num() >= 2) glMesh.vert.push_back(vert.norm.y);
-                            if (a.num() >= 3) glMesh.vert.push_back(vert.norm.z);
-                            break;
-                        }
-                        case TEXTURE: {
-                            if (a.num() >= 1) glMesh.vert.push_back(vert.tex.x);
-                            if (a.num() >= 2) glMesh.vert.push_back(vert.tex.y);
-                            break;
-                        }
-                        case BONE_IDS: {
-                            // reinterpret cast ints to a float
-                            if (a.num() >= 1) glMesh.vert.push_back(reinterpret_cast<const float*>(&vert.bone_ids)[0]);
-                            if (a.num() >= 2) glMesh.vert.push_back(reinterpret_cast<const float*>(&vert.bone_ids)[1]);
-                            if (a.num() >= 3) glMesh.vert.push_back(reinterpret_cast<const float*>(&vert.bone_ids)[2]);
-                            if (a.num() >= 4) glMesh.vert.push_back(reinterpret_cast<const float*>(&vert.bone_ids)[3]);
-                            break;
-                        }
-                        case BONE_WEIGHTS: {
-                            if (a.num() >= 1) glMesh.vert.push_back(vert.bone_weights.x);
-                            if (a.num() >= 2) glMesh.vert.push_back(vert.bone_weights.y);
-                            if (a.num() >= 3) glMesh.vert.push_back(vert.bone_weights.z);
-                            if (a.num() >= 4) glMesh.vert.push_back(vert.bone_weights.w);
-                            break;
-                        }
-                        default:
-                            EOGLL_LOG_ERROR(stderr, "Invalid attribute type");
-                            break;
+        PackLayout compilePackLayout(const ModelAttrs& attrs) {
+            PackLayout layout;
+            for (int i = 0; i < attrs.size(); i++) {
+                const ModelAttr& a = attrs[i];
+                // where the attribute is in a Vertex, and how many bytes of it there are
+                uint32_t src;
+                uint32_t available;
+                switch (a.attr) {
+                    case POSITION: src = offsetof(Vertex, pos); available = sizeof(Vertex::pos); break;
+                    case NORMAL: src = offsetof(Vertex, norm); available = sizeof(Vertex::norm); break;
+                    case TEXTURE: src = offsetof(Vertex, tex); available = sizeof(Vertex::tex); break;
+                    // the ints are copied as they are, the attribute reinterprets them
+                    case BONE_IDS: src = offsetof(Vertex, bone_ids); available = sizeof(Vertex::bone_ids); break;
+                    case BONE_WEIGHTS: src = offsetof(Vertex, bone_weights); available = sizeof(Vertex::bone_weights); break;
+                    default:
+                        EOGLL_LOG_ERROR(stderr, "Invalid attribute type");
+                        src = 0;
+                        available = 0;
+                        break;
+                }
+                if (eogllSizeOf(a.type) != 4) {
+                    EOGLL_LOG_WARN(stderr, "Attribute %d isn't 32 bits per component, it will be packed as floats or ints\n", i);
+                }
+                // components the vertex doesn't have (like the w of a position) stay 0
+                uint32_t size = (uint32_t)a.size < available ? (uint32_t)a.size : available;
+                if (size > 0) {
+                    PackOp* last = layout.ops.empty() ? nullptr : &layout.ops.back();
+                    if (last && last->src + last->size == src && last->dst + last->size == layout.stride) {
+                        last->size += size;
+                    } else {
+                        layout.ops.push_back({src, layout.stride, size});
+                    }
+                }
+                layout.stride += a.size;
+            }
+            return layout;
+        }
 
+        // a layout that is one copy of a size known at compile time, so the copy is a few moves instead of a memcpy call
+        template <uint32_t SIZE>
+        static void packVerticesSingle(const PackOp& op, uint32_t stride, const Vertex* vertices, size_t count, unsigned char* out) {
+            const unsigned char* src = reinterpret_cast<const unsigned char*>(vertices) + op.src;
+            out += op.dst;
+            for (size_t i = 0; i < count; i++) {
+                memcpy(out, src, SIZE);
+                src += sizeof(Vertex);
+                out += stride;
+            }
+        }
+
+        void packVertices(const PackLayout& layout, const Vertex* vertices, size_t count, float* out) {
+            unsigned char* bytes = reinterpret_cast<unsigned char*>(out);
+            if (layout.ops.size() == 1) {
+                const PackOp& op = layout.ops[0];
+                switch (op.size) {
+                    // position, position + normal, position + normal + texture coordinates
+                    case 12: packVerticesSingle<12>(op, layout.stride, vertices, count, bytes); return;
+                    case 24: packVerticesSingle<24>(op, layout.stride, vertices, count, bytes); return;
+                    case 32: packVerticesSingle<32>(op, layout.stride, vertices, count, bytes); return;
+                    // every attribute of a Vertex
+                    case sizeof(Vertex): packVerticesSingle<sizeof(Vertex)>(op, layout.stride, vertices, count, bytes); return;
+                    default: break;
+                }
+            }
+            const PackOp* ops = layout.ops.data();
+            size_t numOps = layout.ops.size();
+            for (size_t i = 0; i < count; i++) {
+                const unsigned char* src = reinterpret_cast<const unsigned char*>(&vertices[i]);
+                for (size_t j = 0; j < numOps; j++) {
+                    memcpy(bytes + ops[j].dst, src + ops[j].src, ops[j].size);
+                }
+                bytes += layout.stride;
+            }
+        }
+
+        GlMesh packMesh(Mesh& mesh, const ModelAttrs& attrs, unsigned int maxThreads) {
+            return packMesh(mesh, compilePackLayout(attrs), maxThreads);
+        }
+
+        GlMesh packMesh(Mesh& mesh, const PackLayout& layout, unsigned int maxThreads) {
+            GlMesh glMesh;
+            // the vertices of every mesh are uploaded one after another and found by base vertex, which only works for whole floats
+            if (layout.stride % sizeof(float) != 0) {
+                EOGLL_LOG_ERROR(stderr, "Can't pack a vertex of %u bytes, it has to be a multiple of 4\n", layout.stride);
+                return glMesh;
+            }
+
+            // the whole buffer is allocated (and zeroed) once, then every vertex is written in place
+            size_t count = mesh.vert.size();
+            size_t floatsPerVertex = layout.stride / sizeof(float);
+            glMesh.vert.resize(count * floatsPerVertex);
+            float* out = glMesh.vert.data();
+            const Vertex* vertices = mesh.vert.data();
+
+            unsigned int numThreads = 1;
+            if (count >= PARALLEL_PACK_VERTICES) {
+                numThreads = maxThreads > 0 ? maxThreads : eogllGetProcessorCount();
+                if (numThreads > count / (PARALLEL_PACK_VERTICES / 4)) {
+                    numThreads = (unsigned int)(count / (PARALLEL_PACK_VERTICES / 4));
+                }
+            }
+            if (numThreads <= 1) {
+                packVertices(layout, vertices, count, out);
+            } else {
+                // every thread packs its own range of vertices, this thread takes the first one
+                std::vector<std::thread> threads;
+                threads.reserve(numThreads - 1);
+                size_t perThread = (count + numThreads - 1) / numThreads;
+                for (unsigned int t = 1; t < numThreads; t++) {
+                    size_t first = t * perThread;
+                    if (first >= count) {
+                        break;
                     }
+                    size_t n = count - first < perThread ? count - first : perThread;
+                    threads.emplace_back(packVertices, std::cref(layout), vertices + first, n, out + first * floatsPerVertex);
+                }
+                packVertices(layout, vertices, count < perThread ? count : perThread, out);
+                for (std::thread& thread : threads) {
+                    thread.join();
                 }
             }
-            glMesh.indices = mesh.indices;
+            glMesh.indices = std::move(mesh.indices);
             return glMesh;
         }
+
+        void optimizeMesh(GlMesh& glMesh, const ModelAttrs& attrs) {
+            uint32_t stride = 0;
+            int positionOffset = -1;
+            for (int i = 0; i < attrs.size(); i++) {
+                const ModelAttr& a = attrs[i];
+                if (a.attr == POSITION && a.type == GL_FLOAT && a.num() >= 3 && positionOffset < 0) {
+                    positionOffset = (int)stride;
+                }
+                stride += a.size;
+            }
+            if (stride == 0 || glMesh.indices.empty()) {
+                return;
+            }
+            uint32_t numVertices = (uint32_t)(glMesh.vert.size() * sizeof(float) / stride);
+            EogllVertexCacheStats before = eogllAnalyzeVertexCache(glMesh.indices.data(), glMesh.indices.size(), numVertices, EOGLL_VERTEX_CACHE_SIZE);
+            if (eogllOptimizeMesh(glMesh.vert.data(), &numVertices, stride, positionOffset, glMesh.indices.data(), glMesh.indices.size()) != EOGLL_SUCCESS) {
+                EOGLL_LOG_WARN(stderr, "Failed to optimize mesh, keeping the original order\n");
+                return;
+            }
+            glMesh.vert.resize(numVertices * stride / sizeof(float));
+            EogllVertexCacheStats after = eogllAnalyzeVertexCache(glMesh.indices.data(), glMesh.indices.size(), numVertices, EOGLL_VERTEX_CACHE_SIZE);
+            EOGLL_LOG_DEBUG(stdout, "Optimized mesh, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", before.acmr, after.acmr, before.atvr, after.atvr);
+        }
+    }
+
+    // runs f(0) to f(count - 1) on every core, returns when all of them are done
+    static void parallelFor(size_t count, const std::function<void(size_t)>& f) {
+        std::atomic<size_t> next(0);
+        auto worker = [&]() {
+            for (size_t i = next++; i < count; i = next++) {
+                f(i);
+            }
+        };
+        unsigned int numThreads = eogllGetProcessorCount();
+        if (numThreads > count) {
+            numThreads = (unsigned int)count;
+        }
+        std::vector<std::thread> threads;
+        if (numThreads > 1) {
+            threads.reserve(numThreads - 1);
+        }
+        for (unsigned int t = 1; t < numThreads; t++) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+
+    static double now() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
     }
 
-    RenderModel::RenderModel(std::string path, ModelAttrs attrs, std::string relpath, bool relative_to_obj) : attrs(attrs) {
-        this->attrs = attrs;
+    // whether two meshes bind the same textures to the same samplers
+    static bool sameTextures(const internal::CountedVector<internal::Texture>& a, const internal::CountedVector<internal::Texture>& b) {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); i++) {
+            if (a[i].texture != b[i].texture || a[i].type != b[i].type) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    RenderModel::RenderModel(std::string path, ModelAttrs attrs, std::string relpath, bool relative_to_obj, bool optimize, unsigned int importFlags) : attrs(std::move(attrs)) {
+        size_t allocationsBefore = internal::allocationCount();
+        double start = now();
+        if (importFlags == 0) {
+            importFlags = this->attrs.importFlags();
+            if (optimize) {
+                // optimizeMesh reorders everything again afterwards
+                importFlags &= ~(unsigned int)aiProcess_ImproveCacheLocality;
+            }
+        }
         if (relative_to_obj) {
             std::string objpath = path.substr(0, path.find_last_of("/\\"));
             this->path = objpath + "/" + relpath;
@@ -149,85 +329,261 @@ namespace ogl {
         if (this->path.back() != '/') {
             this->path += "/";
         }
-        loadModel(path);
 
         // the model is loaded into Meshes but we need to generate all the GlMeshes and then put them into the BufferObjects
         // we want to do all this ahead of time so that the model can just be drawn when needed and we don't have to do much processing
         // *speed intensifies*
-        for (internal::Mesh& mesh : meshes) {
-            internal::GlMesh glMesh = internal::packMesh(mesh, attrs);
-
-            int vao, vbo, ebo;
-            vao = eogllGenVertexArray();
-            vbo = eogllGenBuffer(vao, GL_ARRAY_BUFFER, glMesh.vert.size() * sizeof(float), glMesh.vert.data(), GL_STATIC_DRAW);
-            ebo = eogllGenBuffer(vao, GL_ELEMENT_ARRAY_BUFFER, glMesh.indices.size() * sizeof(unsigned int), glMesh.indices.data(), GL_STATIC_DRAW);
-            attrs.build(vao);
-            mesh.render = new BufferObject(vao, vbo, ebo, glMesh.indices.size()*sizeof(unsigned int), GL_UNSIGNED_INT);
+        // everything up to the GlMeshes and decoded images happens on a thread pool, only the uploads happen here (on the thread with the context)
+        std::vector<internal::GlMesh> glMeshes;
+        std::vector<EogllImage> images;
+        loadModel(path, optimize, importFlags, glMeshes, images);
+        double uploadStart = now();
+
+        std::unordered_map<std::string, EogllTexture*> uploaded;
+        for (size_t i = 0; i < textures_loaded.size(); i++) {
+            internal::Texture& tex = textures_loaded[i];
+            if (!tex.texture) {
+                EogllTexture* texture = eogllCreateTextureFromImage(&images[i]);
+                eogllFreeImage(&images[i]);
+                if (texture) {
+                    tex.texture = TextureCache::global().insert(tex.key, 0, texture);
+                }
+            }
+            uploaded[tex.path] = tex.texture;
+        }
+
+        // every mesh goes into one vertex buffer and one index buffer, the indices stay relative to the mesh and are offset by the base vertex
+        GLsizei stride = 0;
+        for (int i = 0; i < this->attrs.size(); i++) {
+            stride += this->attrs[i].size;
+        }
+        size_t vertexBytes = 0;
+        size_t numIndices = 0;
+        for (const internal::GlMesh& glMesh : glMeshes) {
+            vertexBytes += glMesh.vert.size() * sizeof(float);
+            numIndices += glMesh.indices.size();
+        }
+        unsigned int vao = eogllGenVertexArray();
+        unsigned int vbo = eogllGenBuffer(vao, GL_ARRAY_BUFFER, (GLsizeiptr)vertexBytes, nullptr, GL_STATIC_DRAW);
+        unsigned int ebo = eogllGenBuffer(vao, GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)(numIndices * sizeof(unsigned int)), nullptr, GL_STATIC_DRAW);
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+        std::vector<EogllDrawRange> ranges(meshes.size());
+        size_t vertexOffset = 0;
+        size_t indexOffset = 0;
+        for (size_t i = 0; i < meshes.size(); i++) {
+            internal::Mesh& mesh = meshes[i];
+            internal::GlMesh& glMesh = glMeshes[i];
+            glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)vertexOffset, (GLsizeiptr)(glMesh.vert.size() * sizeof(float)), glMesh.vert.data());
+            glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, (GLintptr)(indexOffset * sizeof(unsigned int)), (GLsizeiptr)(glMesh.indices.size() * sizeof(unsigned int)), glMesh.indices.data());
+            ranges[i].firstIndex = (uint32_t)indexOffset;
+            ranges[i].numIndices = (uint32_t)glMesh.indices.size();
+            ranges[i].baseVertex = stride > 0 ? (int)(vertexOffset / stride) : 0;
+            vertexOffset += glMesh.vert.size() * sizeof(float);
+            indexOffset += glMesh.indices.size();
+
             std::unordered_map<std::string, int> texturesLoaded;
-            for (internal::Texture tex : mesh.textures) {
+            for (internal::Texture& tex : mesh.textures) {
+                tex.texture = uploaded[tex.path];
                 // std::cout << "Uniform '" << (std::string("sampler_") + tex.type + std::to_string(texturesLoaded[tex.type]++)) << "' loaded" << std::endl;
                 EOGLL_LOG_DEBUG(stdout, "Uniform '%s' loaded\n", (std::string("sampler_") + tex.type + std::to_string(texturesLoaded[tex.type]++)).c_str());
             }
+            ranges[i].material = (int)i;
+            for (size_t j = 0; j < i; j++) {
+                if (sameTextures(meshes[j].textures, mesh.textures)) {
+                    ranges[i].material = ranges[j].material;
+                    break;
+                }
+            }
         }
+        this->attrs.build(vao);
+        glBindVertexArray(0);
+        render = RangedBufferObject(eogllCreateRangedBufferObject(eogllCreateBufferObject(vao, vbo, ebo, (GLsizeiptr)(numIndices * sizeof(unsigned int)), GL_UNSIGNED_INT), ranges.data(), (uint32_t)ranges.size()));
+        loadAllocations = internal::allocationCount() - allocationsBefore;
+        double end = now();
+        profile.upload = end - uploadStart;
+        profile.total = end - start;
+        EOGLL_LOG_DEBUG(stdout, "Loaded %zu meshes with %zu buffer allocations\n", meshes.size(), loadAllocations);
+        EOGLL_LOG_DEBUG(stdout, "Loaded %s in %.3f s: import %.3f, scene %.3f, parallel %.3f (process %.3f, pack %.3f, optimize %.3f, decode %.3f), upload %.3f\n",
+                        path.c_str(), profile.total, profile.import, profile.scene, profile.parallel, profile.process, profile.pack,
+                        profile.optimize, profile.decode, profile.upload);
     }
 
     RenderModel::~RenderModel() {
-        for (internal::Mesh& mesh : meshes) {
-            for (internal::Texture tex : mesh.textures) {
-                eogllDeleteTexture(tex.texture);
+        // meshes share textures, but every texture is in textures_loaded once (and acquired once)
+        for (const internal::Texture& tex : textures_loaded) {
+            if (tex.texture) {
+                TextureCache::global().release(tex.texture);
             }
         }
 
         // TODO: delete whatever needs to be deleted
     }
 
-    void RenderModel::draw(EogllShaderProgram* shader, std::function<void(EogllShaderProgram*)> preDraw) {
-        for (internal::Mesh& mesh : meshes) {
-            if (mesh.render == nullptr) {
-                EOGLL_LOG_WARN(stderr, "Mesh has no render object, skipping");
-                continue;
+    void RenderModel::draw(EogllShaderProgram* shader, const std::function<void(EogllShaderProgram*)>& preDraw) {
+        // one vertex array for the whole model, textures are only bound when the next mesh uses different ones
+        // after the first draw with a shader this doesn't allocate or build any strings
+        const internal::ShaderBindings& bindings = bindingsFor(shader);
+        eogllUseProgram(shader);
+        preDraw(shader);
+        // only nodes that were moved since the last draw are recomputed
+        nodes.update();
+
+        static const glm::mat4 identity(1.0f);
+        const EogllRangedBufferObject* buffer = render.getBuffer();
+        const glm::mat4* nodeMatrix = nullptr;
+        int material = -1;
+        render.bind();
+        for (const MeshInstance& instance : nodes.instances()) {
+            const EogllDrawRange* range = &buffer->ranges[instance.mesh];
+            if (range->material != material) {
+                bindMaterial(range, bindings);
+                material = range->material;
+            }
+            const glm::mat4* matrix = meshes[instance.mesh].skinned ? &identity : &nodes.world(instance.node);
+            if (matrix != nodeMatrix) {
+                glUniformMatrix4fv(bindings.nodeLocation, 1, GL_FALSE, &(*matrix)[0][0]);
+                nodeMatrix = matrix;
+            }
+            render.drawRange(GL_TRIANGLES, (uint32_t)instance.mesh);
+        }
+        glBindVertexArray(0);
+    }
+
+    const internal::ShaderBindings& RenderModel::bindingsFor(EogllShaderProgram* shader) {
+        // the program is compared too, in case the shader was deleted and another one was linked at the same address
+        for (const internal::ShaderBindings& bindings : shaderBindings) {
+            if (bindings.shader == shader && bindings.program == shader->id) {
+                return bindings;
             }
+        }
+
+        internal::ShaderBindings bindings;
+        bindings.shader = shader;
+        bindings.program = shader->id;
+        bindings.nodeLocation = eogllGetUniformLocation(shader, "node");
+        bindings.firstSampler.reserve(meshes.size() + 1);
+        std::string name;
+        for (const internal::Mesh& mesh : meshes) {
+            bindings.firstSampler.push_back((uint32_t)bindings.samplers.size());
+            // for example, if you have 2 textures with the type "abc" and 1 texture with the type "def" (in that order)
+            // the uniform names will be "sampler_abc0", "sampler_abc1", "sampler_def0" on units 0, 1 and 2
             std::unordered_map<std::string, int> texturesLoaded;
-            int totalTextures = 0;
-            eogllUseProgram(shader);
-            preDraw(shader);
-            for (internal::Texture tex : mesh.textures) {
-                eogllBindTextureUniform(tex.texture, shader, (std::string("sampler_") + tex.type + std::to_string(texturesLoaded[tex.type]++)).c_str(), totalTextures++);
+            unsigned int unit = 0;
+            for (const internal::Texture& tex : mesh.textures) {
+                name = "sampler_" + tex.type + std::to_string(texturesLoaded[tex.type]++);
+                GLint location = eogllGetUniformLocation(shader, name.c_str());
+                // textures that failed to load and samplers the shader doesn't use are skipped, but still take their unit
+                if (tex.texture && location >= 0) {
+                    bindings.samplers.push_back({tex.texture, location, unit});
+                }
+                unit++;
             }
-            mesh.render->draw(GL_TRIANGLES);
+        }
+        bindings.firstSampler.push_back((uint32_t)bindings.samplers.size());
+        EOGLL_LOG_DEBUG(stdout, "Resolved %zu sampler uniforms of %zu meshes for program %u\n", bindings.samplers.size(), meshes.size(), shader->id);
+        shaderBindings.push_back(std::move(bindings));
+        return shaderBindings.back();
+    }
+
+    void RenderModel::bindMaterial(const EogllDrawRange* range, const internal::ShaderBindings& bindings) {
+        uint32_t end = bindings.firstSampler[range->material + 1];
+        for (uint32_t i = bindings.firstSampler[range->material]; i < end; i++) {
+            const internal::SamplerBinding& sampler = bindings.samplers[i];
+            eogllBindTextureLocation(sampler.texture, sampler.location, sampler.unit);
         }
     }
 
 
-    void RenderModel::loadModel(const std::string& p) {
+    void RenderModel::loadModel(const std::string& p, bool optimize, unsigned int importFlags, std::vector<internal::GlMesh>& glMeshes, std::vector<EogllImage>& images) {
+        double start = now();
         Assimp::Importer importer;
-        const aiScene* scene = importer.ReadFile(p, aiProcessPreset_TargetRealtime_MaxQuality);
+        const aiScene* scene = importer.ReadFile(p, importFlags);
+        profile.importFlags = importFlags;
+        profile.import = now() - start;
         if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
             EOGLL_LOG_ERROR(stderr, "Failed to load model '%s': %s", p.c_str(), importer.GetErrorString());
             return;
         }
+        start = now();
+
+        // meshes are loaded once each, in the order of the scene, and the nodes refer to them by index
+        // bone ids and texture slots are handed out in that order, so that part isn't parallel
+        nodes = SceneGraph(scene);
+        std::vector<const aiMesh*> work(scene->mMeshes, scene->mMeshes + scene->mNumMeshes);
+        meshes.resize(work.size());
+        std::vector<std::string> imagePaths;
+        std::vector<std::vector<int>> boneIds(work.size());
+        for (size_t i = 0; i < work.size(); i++) {
+            assignBones(work[i], boneIds[i]);
+            loadMeshTextures(work[i], scene, meshes[i].textures, imagePaths);
+        }
+        hierarchy = NodeHierarchy(scene, skeleton);
+        // every name that will be looked up has been
+        skeleton.finishLoading();
+        animations.reserve(scene->mNumAnimations);
+        for (unsigned int i = 0; i < scene->mNumAnimations; i++) {
+            animations.emplace_back(scene->mAnimations[i], hierarchy);
+        }
 
-        processNode(scene->mRootNode, scene);
-    }
-
-    void RenderModel::processNode(aiNode* node, const aiScene* scene) {
-        for (unsigned int i = 0; i < node->mNumMeshes; i++) {
-            aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-            meshes.push_back(processMesh(mesh, scene, node->mTransformation));
+        profile.scene = now() - start;
+
+        // meshes and images are independent, so they all go through the same pool
+        // every task writes its own times, they are added up once the pool is done
+        start = now();
+        internal::PackLayout layout = internal::compilePackLayout(attrs);
+        glMeshes.resize(work.size());
+        images.resize(imagePaths.size());
+        std::vector<double> processTimes(work.size()), packTimes(work.size()), optimizeTimes(work.size()), decodeTimes(imagePaths.size());
+        // packMesh would start its own threads for large meshes, so it only gets the cores the pool leaves over
+        size_t tasks = work.size() + imagePaths.size();
+        unsigned int cores = eogllGetProcessorCount();
+        unsigned int packThreads = tasks == 0 || tasks >= cores ? 1 : cores / (unsigned int)tasks;
+        parallelFor(tasks, [&](size_t i) {
+            double t0 = now();
+            if (i < work.size()) {
+                processMesh(work[i], boneIds[i], meshes[i]);
+                double t1 = now();
+                glMeshes[i] = internal::packMesh(meshes[i], layout, packThreads);
+                // the packed copy is all that is uploaded, so the vertices don't need to stay around
+                internal::CountedVector<internal::Vertex>().swap(meshes[i].vert);
+                double t2 = now();
+                if (optimize) {
+                    internal::optimizeMesh(glMeshes[i], attrs);
+                }
+                processTimes[i] = t1 - t0;
+                packTimes[i] = t2 - t1;
+                optimizeTimes[i] = now() - t2;
+            } else {
+                // textures that were in the cache don't need to be decoded
+                size_t image = i - work.size();
+                if (!textures_loaded[image].texture && eogllDecodeImage(imagePaths[image].c_str(), &images[image]) != EOGLL_SUCCESS) {
+                    images[image].data = nullptr;
+                }
+                decodeTimes[image] = now() - t0;
+            }
+        });
+        profile.parallel = now() - start;
+        for (size_t i = 0; i < work.size(); i++) {
+            profile.process += processTimes[i];
+            profile.pack += packTimes[i];
+            profile.optimize += optimizeTimes[i];
         }
-        for (unsigned int i = 0; i < node->mNumChildren; i++) {
-            processNode(node->mChildren[i], scene);
+        for (double time : decodeTimes) {
+            profile.decode += time;
         }
     }
 
-    internal::Mesh RenderModel::processMesh(aiMesh* mesh, const aiScene* scene, aiMatrix4x4 transform) {
-        std::vector<internal::Vertex> vertices;
-        std::vector<unsigned int> indices;
-        std::vector<internal::Texture> textures;
+    void RenderModel::processMesh(const aiMesh* mesh, const std::vector<int>& boneIds, internal::Mesh& m) const {
+        // the vectors are filled in place in the mesh, so nothing is copied
+        internal::CountedVector<internal::Vertex>& vertices = m.vert;
+        internal::CountedVector<unsigned int>& indices = m.indices;
+        m.skinned = mesh->mNumBones > 0;
         vertices.reserve(mesh->mNumVertices);
         for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
             internal::Vertex vertex;
-            vertex.pos = (glm::vec4(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z, 1.0f) * convertToGLM(transform));
+            vertex.pos = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
             if (mesh->HasNormals()) {
                 vertex.norm = glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);
             } else {
@@ -245,7 +601,7 @@ namespace ogl {
             vertices.push_back(vertex);
         }
 
-        extractBones(vertices, mesh, scene);
+        extractBones(vertices, mesh, boneIds);
         
         indices.reserve(3 * mesh->mNumFaces);
         for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
@@ -258,11 +614,13 @@ namespace ogl {
                 indices.push_back(face.mIndices[j]);
             }
         }
+    }
 
+    void RenderModel::loadMeshTextures(const aiMesh* mesh, const aiScene* scene, internal::CountedVector<internal::Texture>& textures, std::vector<std::string>& imagePaths) {
         if (mesh->mMaterialIndex >= 0) {
             aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
 
-            std::vector<std::pair<aiTextureType, std::string>> textureTypes = {
+            static const std::pair<aiTextureType, std::string> textureTypes[] = {
                 {aiTextureType_DIFFUSE, "diffuse"},
                 {aiTextureType_SPECULAR, "specular"},
                 {aiTextureType_AMBIENT, "ambient"},
@@ -281,60 +639,53 @@ namespace ogl {
                 {aiTextureType_DIFFUSE_ROUGHNESS, "diffuse_roughness"},
                 {aiTextureType_AMBIENT_OCCLUSION, "ambient_occlusion"}
             };
-            for (std::pair<aiTextureType, std::string> textureType : textureTypes) {
-                std::vector<internal::Texture> maps = loadMaterialTextures(material, textureType.first, textureType.second);
-                textures.insert(textures.end(), maps.begin(), maps.end());
+            size_t numTextures = 0;
+            for (const std::pair<aiTextureType, std::string>& textureType : textureTypes) {
+                numTextures += material->GetTextureCount(textureType.first);
+            }
+            if (numTextures > 0) {
+                textures.reserve(numTextures);
+            }
+            for (const std::pair<aiTextureType, std::string>& textureType : textureTypes) {
+                loadMaterialTextures(material, textureType.first, textureType.second, textures, imagePaths);
             }
         }
-        internal::Mesh m;
-        m.indices = indices;
-        m.textures = textures;
-        m.vert = vertices;
-        m.render = nullptr;
-
-        return m;
     }
 
-    std::vector<internal::Texture> RenderModel::loadMaterialTextures(aiMaterial* mat, aiTextureType type, std::string typeName) {
-        std::vector<internal::Texture> textures;
+    void RenderModel::loadMaterialTextures(aiMaterial* mat, aiTextureType type, const std::string& typeName, internal::CountedVector<internal::Texture>& textures, std::vector<std::string>& imagePaths) {
         for (unsigned int i = 0; i < mat->GetTextureCount(type); i++) {
             aiString str;
             mat->GetTexture(type, i, &str);
-            bool skip = false;
-            for (internal::Texture tex : textures_loaded) {
-                if (tex.path == str.C_Str()) {
-                    textures.push_back(tex);
-                    skip = true;
-                    break;
-                }
-            }
-            if (!skip) {
+            auto loaded = textureIndices.find(str.C_Str());
+            if (loaded != textureIndices.end()) {
+                textures.push_back(textures_loaded[loaded->second]);
+            } else {
+                // textures other models loaded are shared, the rest are decoded on the pool and uploaded once everything is loaded
+                // textures_loaded[i] is imagePaths[i]
                 internal::Texture tex;
-                std::string path = this->path + str.C_Str();
-                tex.texture = eogllCreateTexture(path.c_str());
+                tex.key = TextureCache::canonicalPath(this->path + str.C_Str());
+                tex.texture = TextureCache::global().acquire(tex.key);
                 tex.type = typeName;
                 tex.path = str.C_Str();
+                imagePaths.push_back(tex.key);
+                textureIndices[tex.path] = textures_loaded.size();
                 textures.push_back(tex);
-                textures_loaded.push_back(tex);
+                textures_loaded.push_back(std::move(tex));
             }
         }
-        return textures;
     }
 
-    void RenderModel::extractBones(std::vector<internal::Vertex>& vertices, aiMesh* mesh, const aiScene* scene) {
+    void RenderModel::assignBones(const aiMesh* mesh, std::vector<int>& boneIds) {
+        boneIds.resize(mesh->mNumBones);
         for (unsigned int i = 0; i < mesh->mNumBones; i++) {
-            int boneID = -1;
-            std::string boneName = mesh->mBones[i]->mName.C_Str();
-            if (boneInfoMap.find(boneName) == boneInfoMap.end()) {
-                BoneInfo newBoneInfo;
-                newBoneInfo.id = boneCounter;
-                newBoneInfo.offset = convertToGLM(mesh->mBones[i]->mOffsetMatrix);
-                boneInfoMap[boneName] = newBoneInfo;
-                boneID = boneCounter++;
-            } else {
-                boneID = boneInfoMap[boneName].id;
-            }
-            assert(boneID != -1);
+            boneIds[i] = skeleton.add(mesh->mBones[i]->mName.C_Str(), convertToGLM(mesh->mBones[i]->mOffsetMatrix));
+        }
+    }
+
+    void RenderModel::extractBones(internal::CountedVector<internal::Vertex>& vertices, const aiMesh* mesh, const std::vector<int>& boneIds) {
+        for (unsigned int i = 0; i < mesh->mNumBones; i++) {
+            // the ids were looked up by name in assignBones, so this doesn't touch the skeleton
+            int boneID = boneIds[i];
             auto weights = mesh->mBones[i]->mWeights;
             int numWeights = mesh->mBones[i]->mNumWeights;
 
@@ -352,4 +703,4 @@ namespace ogl {
             }
         }
     }
-}
\ No newline at end of file
+}
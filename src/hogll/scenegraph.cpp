@@ -0,0 +1,74 @@
+#include "hogll/scenegraph.hpp"
+
+namespace ogl {
+    SceneGraph::SceneGraph(const aiScene* scene) {
+        if (!scene || !scene->mRootNode) {
+            return;
+        }
+
+        // the same walk as NodeHierarchy, so a node has the same index in both
+        std::vector<std::pair<const aiNode*, int>> stack;
+        stack.emplace_back(scene->mRootNode, -1);
+        while (!stack.empty()) {
+            const aiNode* node = stack.back().first;
+            int parent = stack.back().second;
+            stack.pop_back();
+
+            int index = (int)parents.size();
+            names.emplace_back(node->mName.C_Str());
+            parents.push_back(parent);
+            locals.push_back(convertToGLM(node->mTransformation));
+            for (unsigned int i = 0; i < node->mNumMeshes; i++) {
+                meshInstances.push_back({index, (int)node->mMeshes[i]});
+            }
+
+            for (unsigned int i = node->mNumChildren; i > 0; i--) {
+                stack.emplace_back(node->mChildren[i - 1], index);
+            }
+        }
+        worlds.resize(locals.size());
+        dirty.assign(locals.size(), 1);
+        anyDirty = true;
+        update();
+    }
+
+    int SceneGraph::find(const std::string& name) const {
+        for (size_t i = 0; i < names.size(); i++) {
+            if (names[i] == name) {
+                return (int)i;
+            }
+        }
+        return -1;
+    }
+
+    void SceneGraph::setLocal(int node, const glm::mat4& transform) {
+        locals[node] = transform;
+        dirty[node] = 1;
+        anyDirty = true;
+    }
+
+    size_t SceneGraph::update() {
+        if (!anyDirty) {
+            return 0;
+        }
+        // parents come first, so a moved parent has marked its children by the time they are reached
+        size_t updated = 0;
+        for (size_t i = 0; i < parents.size(); i++) {
+            int parent = parents[i];
+            if (parent >= 0 && dirty[parent]) {
+                dirty[i] = 1;
+            }
+            if (dirty[i]) {
+                if (parent >= 0) {
+                    internal::multiply(worlds[parent], locals[i], worlds[i]);
+                } else {
+                    worlds[i] = locals[i];
+                }
+                updated++;
+            }
+        }
+        std::fill(dirty.begin(), dirty.end(), (uint8_t)0);
+        anyDirty = false;
+        return updated;
+    }
+}
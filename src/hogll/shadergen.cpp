@@ -1,77 +1,276 @@
 #include "hogll/shadergen.hpp"
 
 namespace ogl {
-    EogllShaderProgram* basicShaderGenerator(ModelAttrs attrs, bool defaultUniforms) { // defaultUniforms means model/view/projection
-        // this will just generate a shader that works for the given attributes
-        // this shader has a requirement of the position attribute
-        std::string vertexShader = "#version 330 core\n";
+    // the define of every ShaderFeature bit, in bit order
+    static const char* const featureDefines[] = {
+        "EOGLL_NORMALS",
+        "EOGLL_TEXTURES",
+        "EOGLL_SKINNING",
+        "EOGLL_INSTANCING",
+        "EOGLL_TRANSFORMS"
+    };
+
+    // #version has to stay the first line, so the defines go right after it
+    static std::string insertDefines(const std::string& source, const std::string& defines) {
+        size_t version = source.find("#version");
+        if (version == std::string::npos) {
+            return defines + source;
+        }
+        size_t lineEnd = source.find('\n', version);
+        if (lineEnd == std::string::npos) {
+            return source + "\n" + defines;
+        }
+        return source.substr(0, lineEnd + 1) + defines + source.substr(lineEnd + 1);
+    }
+
+    ShaderPermutations::ShaderPermutations(std::string vertexSource, std::string fragmentSource, std::string constants)
+        : vertexSource(std::move(vertexSource)), fragmentSource(std::move(fragmentSource)), constants(std::move(constants)) {}
+
+    ShaderPermutations::~ShaderPermutations() {
+        clear();
+    }
+
+    EogllShaderProgram* ShaderPermutations::get(uint32_t features) {
+        features &= SHADER_ALL_FEATURES;
+        statistics.requests++;
+        auto it = variants.find(features);
+        if (it != variants.end()) {
+            statistics.hits++;
+            return it->second;
+        }
+
+        std::string variantDefines = defines(features);
+        std::string vertex = insertDefines(vertexSource, variantDefines);
+        std::string fragment = insertDefines(fragmentSource, variantDefines);
+        auto start = std::chrono::steady_clock::now();
+        EogllShaderProgram* program = eogllLinkProgram(vertex.c_str(), fragment.c_str());
+        double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        statistics.compiles++;
+        statistics.compileTime += time;
+        statistics.slowestCompile = std::max(statistics.slowestCompile, time);
+        if (program && !program->successful) {
+            EOGLL_LOG_ERROR(stderr, "Shader variant 0x%x failed to compile\n", features);
+            eogllDeleteProgram(program);
+            program = nullptr;
+        }
+        if (!program) {
+            statistics.failures++;
+        } else if (program->cached) {
+            statistics.programCacheHits++;
+        }
+        variants[features] = program;
+        return program;
+    }
+
+    void ShaderPermutations::prewarm(const std::vector<uint32_t>& features) {
+        for (uint32_t f : features) {
+            if (variants.find(f & SHADER_ALL_FEATURES) == variants.end()) {
+                (void)get(f);
+            }
+        }
+    }
+
+    std::string ShaderPermutations::defines(uint32_t features) const {
+        std::string result;
+        for (uint32_t i = 0; i < sizeof(featureDefines) / sizeof(featureDefines[0]); i++) {
+            if (features & (1u << i)) {
+                result += "#define ";
+                result += featureDefines[i];
+                result += "\n";
+            }
+        }
+        return result + constants;
+    }
+
+    size_t ShaderPermutations::size() const {
+        return variants.size();
+    }
+
+    void ShaderPermutations::clear() {
+        for (auto& variant : variants) {
+            if (variant.second) {
+                eogllDeleteProgram(variant.second);
+            }
+        }
+        variants.clear();
+    }
+
+    const ShaderVariantStats& ShaderPermutations::stats() const {
+        return statistics;
+    }
+
+    uint32_t shaderFeatures(const ModelAttrs& attrs) {
+        uint32_t features = 0;
+        if (attrs.has(NORMAL)) {
+            features |= SHADER_NORMALS;
+        }
+        if (attrs.has(TEXTURE)) {
+            features |= SHADER_TEXTURES;
+        }
+        if (attrs.has(BONE_IDS) && attrs.has(BONE_WEIGHTS)) {
+            features |= SHADER_SKINNING;
+        }
+        return features;
+    }
+
+    static const char* basicVertexShader =
+        "#version 330 core\n"
+        "layout(location = EOGLL_POSITION_LOCATION) in vec3 aPos;\n"
+        "#ifdef EOGLL_NORMALS\n"
+        "layout(location = EOGLL_NORMAL_LOCATION) in vec3 aNormal;\n"
+        "out vec3 Normal;\n"
+        "#endif\n"
+        "#ifdef EOGLL_TEXTURES\n"
+        "layout(location = EOGLL_TEXTURE_LOCATION) in vec2 aTexCoord;\n"
+        "out vec2 TexCoord;\n"
+        "#endif\n"
+        "#ifdef EOGLL_SKINNING\n"
+        "layout(location = EOGLL_BONE_IDS_LOCATION) in ivec4 aBoneIDs;\n"
+        "layout(location = EOGLL_BONE_WEIGHTS_LOCATION) in vec4 aWeights;\n"
+        // filled by ogl::BonePaletteBuffer
+        "layout(std140) uniform BonePalette {\n"
+        "    mat4 finalBonesMatrices[EOGLL_MAX_BONES];\n"
+        "};\n"
+        "#endif\n"
+        "#ifdef EOGLL_INSTANCING\n"
+        "layout(location = EOGLL_INSTANCE_LOCATION) in mat4 aInstance;\n"
+        "#endif\n"
+        "#ifdef EOGLL_TRANSFORMS\n"
+        "uniform mat4 model;\n"
+        // set by ogl::RenderModel::draw, identity for skinned meshes and when drawn without it
+        "uniform mat4 node = mat4(1.0);\n"
+        "uniform mat4 view;\n"
+        "uniform mat4 projection;\n"
+        "#endif\n"
+        "void main() {\n"
+        "    mat4 world = mat4(1.0);\n"
+        "#ifdef EOGLL_SKINNING\n"
+        "    mat4 skin = mat4(0.0);\n"
+        "    float totalWeight = 0.0;\n"
+        "    for (int i = 0; i < 4; i++) {\n"
+        "        if (aBoneIDs[i] < 0 || aBoneIDs[i] >= EOGLL_MAX_BONES) {\n"
+        "            continue;\n"
+        "        }\n"
+        "        skin += finalBonesMatrices[aBoneIDs[i]] * aWeights[i];\n"
+        "        totalWeight += aWeights[i];\n"
+        "    }\n"
+        "    if (totalWeight > 0.0) {\n"
+        "        world = skin;\n"
+        "    }\n"
+        "#endif\n"
+        "#ifdef EOGLL_TRANSFORMS\n"
+        "    world = node * world;\n"
+        "#endif\n"
+        "#ifdef EOGLL_INSTANCING\n"
+        "    world = aInstance * world;\n"
+        "#endif\n"
+        "#ifdef EOGLL_TRANSFORMS\n"
+        "    world = model * world;\n"
+        "    gl_Position = projection * view * world * vec4(aPos, 1.0);\n"
+        "#else\n"
+        "    gl_Position = world * vec4(aPos, 1.0);\n"
+        "#endif\n"
+        "#ifdef EOGLL_NORMALS\n"
+        "    Normal = mat3(transpose(inverse(world))) * aNormal;\n"
+        "#endif\n"
+        "#ifdef EOGLL_TEXTURES\n"
+        "    TexCoord = aTexCoord;\n"
+        "#endif\n"
+        "}\n";
 
-        std::string positionAttr;
-        bool hasNormal = false;
-        std::string normalAttr;
+    // static directional lighting with normals, a static color (or the diffuse texture) without
+    static const char* basicFragmentShader =
+        "#version 330 core\n"
+        "out vec4 FragColor;\n"
+        "#ifdef EOGLL_NORMALS\n"
+        "in vec3 Normal;\n"
+        "#endif\n"
+        "#ifdef EOGLL_TEXTURES\n"
+        "in vec2 TexCoord;\n"
+        "uniform sampler2D sampler_diffuse0;\n"
+        "#endif\n"
+        "void main() {\n"
+        "    vec3 color = vec3(1.0, 0.5, 0.2);\n"
+        "#ifdef EOGLL_TEXTURES\n"
+        "    color = texture(sampler_diffuse0, TexCoord).rgb;\n"
+        "#endif\n"
+        "#ifdef EOGLL_NORMALS\n"
+        "    vec3 lightDir = normalize(vec3(1.0, 1.0, 1.0));\n"
+        "    float diff = max(dot(Normal, lightDir), 0.0);\n"
+        "    color *= diff;\n"
+        "#endif\n"
+        "    FragColor = vec4(color, 1.0);\n"
+        "}\n";
+
+    ShaderPermutations* basicShaderPermutations(const ModelAttrs& attrs) {
+        // never destroyed, the context is usually gone by the time statics are
+        static std::unordered_map<std::string, ShaderPermutations*>* layouts = new std::unordered_map<std::string, ShaderPermutations*>();
+        static const char* const locationDefines[] = {
+            "EOGLL_POSITION_LOCATION",
+            "EOGLL_NORMAL_LOCATION",
+            "EOGLL_TEXTURE_LOCATION",
+            "EOGLL_BONE_IDS_LOCATION",
+            "EOGLL_BONE_WEIGHTS_LOCATION"
+        };
+
+        // the locations are the only thing that changes between layouts, so they are the key
+        std::string constants;
+        uint32_t defined = 0;
         for (int i = 0; i < attrs.size(); i++) {
             ModelAttr type = attrs[i];
-            if (type.type != GL_FLOAT) {
+            if (type.attr != BONE_IDS && type.type != GL_FLOAT) {
                 EOGLL_LOG_ERROR(stderr, "Attribute type is not GL_FLOAT");
                 return nullptr;
             }
-            std::string name = "eogll_attr_"+std::to_string(i);
-            std::string t = "layout(location="+std::to_string(i)+") in vec"+std::to_string(type.size/eogllSizeOf(type.type))+" "+name+";\n";
-            vertexShader += t;
-            if (type.attr == POSITION) {
-                positionAttr = name;
-            } else if (type.attr == NORMAL) {
-                hasNormal = true;
-                normalAttr = name;
+            // the first attribute of a type is the one the shader reads
+            if (!(defined & (1u << type.attr))) {
+                defined |= 1u << type.attr;
+                constants += "#define " + std::string(locationDefines[type.attr]) + " " + std::to_string(i) + "\n";
             }
         }
-
-        if (defaultUniforms) {
-            vertexShader += "uniform mat4 model;\n";
-            vertexShader += "uniform mat4 view;\n";
-            vertexShader += "uniform mat4 projection;\n";
+        if (!attrs.has(POSITION)) {
+            EOGLL_LOG_ERROR(stderr, "The basic shader needs a position attribute\n");
+            return nullptr;
         }
+        constants += "#define EOGLL_INSTANCE_LOCATION " + std::to_string(attrs.size()) + "\n";
+        constants += "#define EOGLL_MAX_BONES " + std::to_string(MAX_BONES) + "\n";
 
-        if (hasNormal) {
-            vertexShader += "out vec3 Normal;\n";
+        auto it = layouts->find(constants);
+        if (it != layouts->end()) {
+            return it->second;
         }
+        ShaderPermutations* permutations = new ShaderPermutations(basicVertexShader, basicFragmentShader, constants);
+        layouts->emplace(constants, permutations);
+        return permutations;
+    }
 
-        vertexShader += "void main() {\n";
-        vertexShader += "    gl_Position = ";
+    // only the normals are used, the other attributes need textures or bones bound to work
+    static uint32_t basicShaderFeatures(const ModelAttrs& attrs, bool defaultUniforms) {
+        uint32_t features = shaderFeatures(attrs) & SHADER_NORMALS;
         if (defaultUniforms) {
-            vertexShader += "projection * view * model * ";
-        }
-        vertexShader += "vec4("+positionAttr+", 1.0);\n";
-        if (hasNormal) {
-            if (defaultUniforms) {
-                vertexShader += "    Normal = mat3(transpose(inverse(model))) * "+normalAttr+";\n";
-            } else {
-                vertexShader += "    Normal = "+normalAttr+";\n";
-            }
+            features |= SHADER_TRANSFORMS;
         }
-        vertexShader += "}\n";
-
-        std::string fragmentShader = "#version 330 core\n";
-        // if we happen to have the normal attribute, we will make a simple shader that just has static directional lighting
-        // if not, we will just make a simple shader that just has a static color
-        fragmentShader += "out vec4 FragColor;\n";
+        return features;
+    }
 
-        if (hasNormal) {
-            fragmentShader += "in vec3 Normal;\n";
+    EogllShaderProgram* basicShaderVariant(const ModelAttrs& attrs, bool defaultUniforms) {
+        ShaderPermutations* permutations = basicShaderPermutations(attrs);
+        if (!permutations) {
+            return nullptr;
         }
+        return permutations->get(basicShaderFeatures(attrs, defaultUniforms));
+    }
 
-        fragmentShader += "void main() {\n";
-        if (hasNormal) {
-            fragmentShader += "    vec3 lightDir = normalize(vec3(1.0, 1.0, 1.0));\n";
-            fragmentShader += "    float diff = max(dot(Normal, lightDir), 0.0);\n";
-            fragmentShader += "    vec3 color = vec3(1.0, 0.5, 0.2);\n";
-            fragmentShader += "    FragColor = vec4(color * diff, 1.0);\n";
-        } else {
-            fragmentShader += "    FragColor = vec4(1.0, 0.5, 0.2, 1.0);\n";
+    EogllShaderProgram* basicShaderGenerator(ModelAttrs attrs, bool defaultUniforms) { // defaultUniforms means model/node/view/projection
+        // this will just generate a shader that works for the given attributes
+        // this shader has a requirement of the position attribute
+        ShaderPermutations* permutations = basicShaderPermutations(attrs);
+        if (!permutations) {
+            return nullptr;
         }
-        fragmentShader += "}\n";
-        EogllShaderProgram* shader = eogllLinkProgram(vertexShader.c_str(), fragmentShader.c_str());
-
-        return shader;
+        // the same sources as basicShaderVariant, but linked into a program of its own (the program cache can still skip the compile)
+        std::string defines = permutations->defines(basicShaderFeatures(attrs, defaultUniforms));
+        return eogllLinkProgram(insertDefines(basicVertexShader, defines).c_str(), insertDefines(basicFragmentShader, defines).c_str());
     }
-}
\ No newline at end of file
+}
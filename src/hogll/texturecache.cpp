@@ -0,0 +1,178 @@
+#include "hogll/texturecache.hpp"
+
+namespace ogl {
+    TextureCache& TextureCache::global() {
+        // never destroyed, models in other static objects can still release their textures at exit
+        static TextureCache* cache = new TextureCache();
+        return *cache;
+    }
+
+    std::string TextureCache::canonicalPath(const std::string& path) {
+        // this is only lexical (symlinks aren't followed), which is enough for the paths models refer to
+        bool absolute = !path.empty() && (path[0] == '/' || path[0] == '\\');
+        std::vector<std::string> parts;
+        size_t start = 0;
+        while (start <= path.size()) {
+            size_t end = path.find_first_of("/\\", start);
+            if (end == std::string::npos) {
+                end = path.size();
+            }
+            std::string part = path.substr(start, end - start);
+            if (part == "..") {
+                if (!parts.empty() && parts.back() != "..") {
+                    parts.pop_back();
+                } else if (!absolute) {
+                    parts.push_back(part);
+                }
+            } else if (!part.empty() && part != ".") {
+                parts.push_back(part);
+            }
+            start = end + 1;
+        }
+
+        std::string canonical = absolute ? "/" : "";
+        for (size_t i = 0; i < parts.size(); i++) {
+            if (i > 0) {
+                canonical += '/';
+            }
+            canonical += parts[i];
+        }
+        return canonical;
+    }
+
+    size_t TextureCache::textureSize(const EogllTexture* texture) {
+        // the mipmap chain adds a third
+        size_t base = (size_t)texture->width * (size_t)texture->height * (size_t)texture->channels;
+        return base + base / 3;
+    }
+
+    EogllTexture* TextureCache::acquire(const std::string& path, uint32_t options) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(Key{path, options});
+        if (it == entries.end()) {
+            misses++;
+            return nullptr;
+        }
+        Entry& entry = it->second;
+        if (entry.refs++ == 0) {
+            unused.erase(entry.unusedIt);
+            unusedBytes -= entry.bytes;
+        }
+        hits++;
+        return entry.texture;
+    }
+
+    EogllTexture* TextureCache::insert(const std::string& path, uint32_t options, EogllTexture* texture) {
+        Evictions evicted;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto inserted = entries.emplace(Key{path, options}, Entry{});
+            Entry& entry = inserted.first->second;
+            if (!inserted.second) {
+                EOGLL_LOG_DEBUG(stdout, "Texture %s was loaded twice, using the cached one\n", path.c_str());
+                eogllDeleteTexture(texture);
+                if (entry.refs++ == 0) {
+                    unused.erase(entry.unusedIt);
+                    unusedBytes -= entry.bytes;
+                }
+                return entry.texture;
+            }
+            entry.key = inserted.first->first;
+            entry.texture = texture;
+            entry.refs = 1;
+            entry.bytes = textureSize(texture);
+            owners[texture] = &entry;
+            bytes += entry.bytes;
+            evict(budget, evicted);
+        }
+        finishEvictions(evicted);
+        return texture;
+    }
+
+    void TextureCache::release(EogllTexture* texture) {
+        Evictions evicted;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = owners.find(texture);
+            if (it == owners.end()) {
+                EOGLL_LOG_WARN(stderr, "Released a texture that isn't in the cache\n");
+                return;
+            }
+            Entry* entry = it->second;
+            if (--entry->refs == 0) {
+                entry->unusedIt = unused.insert(unused.end(), entry);
+                unusedBytes += entry->bytes;
+                evict(budget, evicted);
+            }
+        }
+        finishEvictions(evicted);
+    }
+
+    size_t TextureCache::trim(size_t maxBytes) {
+        Evictions evicted;
+        size_t count;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            count = evict(maxBytes, evicted);
+        }
+        finishEvictions(evicted);
+        return count;
+    }
+
+    void TextureCache::setBudget(size_t maxBytes) {
+        Evictions evicted;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            budget = maxBytes;
+            evict(budget, evicted);
+        }
+        finishEvictions(evicted);
+    }
+
+    void TextureCache::setEvictionHook(EvictionHook hook) {
+        std::lock_guard<std::mutex> lock(mutex);
+        evictionHook = std::move(hook);
+    }
+
+    TextureCacheStats TextureCache::stats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        TextureCacheStats s;
+        s.textures = entries.size();
+        s.unused = unused.size();
+        s.bytes = bytes;
+        s.unusedBytes = unusedBytes;
+        s.hits = hits;
+        s.misses = misses;
+        s.evictions = evictions;
+        return s;
+    }
+
+    size_t TextureCache::evict(size_t maxBytes, Evictions& evicted) {
+        size_t count = 0;
+        while (bytes > maxBytes && !unused.empty()) {
+            Entry* entry = unused.front();
+            unused.pop_front();
+            evicted.entries.push_back(*entry);
+            bytes -= entry->bytes;
+            unusedBytes -= entry->bytes;
+            owners.erase(entry->texture);
+            entries.erase(entries.find(entry->key));
+            count++;
+        }
+        // copied so the hook still works if another thread replaces it before the textures are deleted
+        if (count > 0) {
+            evicted.hook = evictionHook;
+        }
+        evictions += count;
+        return count;
+    }
+
+    void TextureCache::finishEvictions(Evictions& evicted) {
+        for (const Entry& entry : evicted.entries) {
+            if (evicted.hook) {
+                evicted.hook(entry.key.path, entry.texture, entry.bytes);
+            }
+            eogllDeleteTexture(entry.texture);
+        }
+    }
+}
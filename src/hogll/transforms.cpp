@@ -1,6 +1,28 @@
 #include "hogll/transforms.hpp"
 
 namespace ogl {
+    FrameUniforms::FrameUniforms() {
+        buffer = eogllCreateFrameUniformBuffer();
+    }
+
+    FrameUniforms::~FrameUniforms() {
+        if (buffer) {
+            eogllDeleteFrameUniformBuffer(buffer);
+        }
+    }
+
+    void FrameUniforms::setTime(float time) {
+        eogllSetFrameTime(buffer, time);
+    }
+
+    void FrameUniforms::upload() {
+        eogllUploadFrameUniforms(buffer);
+    }
+
+    EogllFrameUniformBuffer* FrameUniforms::get() {
+        return buffer;
+    }
+
     Model::Model() {
         model = eogllCreateModel();
     }
@@ -78,6 +100,10 @@ namespace ogl {
         eogllUpdateCameraMatrix(&camera, shader, name);
     }
 
+    void Camera::update(FrameUniforms& frame) {
+        eogllUpdateCameraUniforms(&camera, frame.get());
+    }
+
     Projection::Projection(float fov, float near, float far) {
         proj = eogllPerspectiveProjection(fov, near, far);
     }
@@ -98,5 +124,13 @@ namespace ogl {
         eogllUpdateProjectionMatrixOrtho(&proj, shader, name, top, bottom, left, right);
     }
 
+    void Projection::update(FrameUniforms& frame, const ogl::Window& window) {
+        eogllUpdateProjectionUniforms(&proj, frame.get(), window.getWidth(), window.getHeight());
+    }
+
+    void Projection::update(FrameUniforms& frame, uint32_t width, uint32_t height) {
+        eogllUpdateProjectionUniforms(&proj, frame.get(), width, height);
+    }
+
 
 }
\ No newline at end of file